@@ -0,0 +1,132 @@
+/**
+ * Scratch arena.
+ *
+ * This file contains the request scratch arena. Allocations are bumped from the arena
+ * block and are never released one by one: ResetArena() releases them all at once, at
+ * the start of each lookup.
+ *
+ * When the block is full, allocations are served from spill blocks of their own size;
+ * the next reset releases the spills and grows the block to hold them too, so that after
+ * the first queries of a given size the arena serves its requests without allocating.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Arena.cpp										*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * Local includes.
+ */
+#include "Arena.h"											// Scratch arena.
+
+
+/*===================================================================================
+ *	GetAligned																		*
+ *==================================================================================*/
+
+/**
+ * Get aligned address.
+ *
+ * This function will return the number of bytes to skip from the provided address to
+ * the next <i>{@link kARENA_Alignment kARENA_Alignment}</i> boundary.
+ *
+ * @param const UInt8 *		theAddress			Address.
+ *
+ * @access private
+ * @return size_t
+ */
+static inline size_t GetAligned( const UInt8 * theAddress )
+{
+	return (kARENA_Alignment - ((size_t) theAddress % kARENA_Alignment))
+		 % kARENA_Alignment;													// ==>
+
+} // GetAligned.
+
+
+/*===================================================================================
+ *	GetArena																		*
+ *==================================================================================*/
+
+/**
+ * Allocate from arena.
+ *
+ * This function will return an uninitialised array of the provided size, aligned to
+ * <i>{@link kARENA_Alignment kARENA_Alignment}</i>, valid until the arena is reset. The
+ * arena must have been reset once before its first allocation.
+ *
+ * @param ARENA_T *			theArena			Arena.
+ * @param size_t			theSize				Size in bytes.
+ *
+ * @access public
+ * @return void *
+ */
+void * GetArena( ARENA_T * theArena, size_t theSize )
+{
+	//
+	// Bump block.
+	//
+	if( theArena->block.size() )
+	{
+		UInt8 * base = &theArena->block[ 0 ];
+		size_t offset = theArena->used + GetAligned( base + theArena->used );
+		if( (offset + theSize) <= theArena->block.size() )
+		{
+			theArena->used = offset + theSize;
+			return base + offset;												// ==>
+		}
+	}
+
+	//
+	// Spill.
+	//
+	theArena->spills.push_back( vector<UInt8>() );
+	vector<UInt8> & spill = theArena->spills.back();
+	spill.resize( theSize + kARENA_Alignment );
+	return &spill[ 0 ] + GetAligned( &spill[ 0 ] );								// ==>
+
+} // GetArena.
+
+
+/*===================================================================================
+ *	ResetArena																		*
+ *==================================================================================*/
+
+/**
+ * Reset arena.
+ *
+ * This function will release all the allocations of the provided arena. If allocations
+ * spilled out of the block since the last reset, the block is grown to hold them along
+ * with its current size.
+ *
+ * @param ARENA_T *			theArena			Arena.
+ *
+ * @access public
+ * @return void
+ */
+void ResetArena( ARENA_T * theArena )
+{
+	//
+	// Grow block.
+	//
+	if( ! theArena->spills.empty() )
+	{
+		size_t size = theArena->block.size();
+		for( list< vector<UInt8> >::const_iterator spill = theArena->spills.begin();
+			 spill != theArena->spills.end();
+			 ++spill )
+			size += spill->size();
+		vector<UInt8>( size ).swap( theArena->block );
+		theArena->spills.clear();
+	}
+
+	theArena->used = 0;
+
+} // ResetArena.
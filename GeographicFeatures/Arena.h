@@ -0,0 +1,50 @@
+/**
+ * Scratch arena definitions.
+ *
+ * This file contains the declarations of the request scratch arena: the temporary arrays
+ * of a lookup are carved from a single block, which is kept from one request to the next,
+ * so that steady state queries allocate no memory.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Types.h"
+
+using namespace std;
+
+#include "Structures.h"
+
+
+/**
+ * Arena alignment.
+ *
+ * This constant holds the alignment of the arrays returned by GetArena(), enough for all
+ * the scalar and vector types.
+ */
+const size_t kARENA_Alignment = 16;
+
+/**
+ * GetArena.
+ *
+ * Allocate from an arena.
+ */
+void * GetArena( ARENA_T * theArena, size_t theSize );
+
+/**
+ * ResetArena.
+ *
+ * Release all the allocations of an arena.
+ */
+void ResetArena( ARENA_T * theArena );
+
+#endif // ARENA_H
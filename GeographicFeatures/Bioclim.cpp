@@ -0,0 +1,410 @@
+/**
+ * Bioclimatic variables.
+ *
+ * This file contains the bioclimatic variables engine: the 19 BIOCLIM variables are
+ * derived from the 36 monthly values of a cell, minimum temperature, maximum temperature
+ * and precipitation, following the WORLDCLIM definitions:
+ *
+ * <ul>
+ *	<li><b>bio1</b>: Annual mean temperature, mean of the monthly average temperatures.
+ *	<li><b>bio2</b>: Mean diurnal range, mean of the monthly (max - min) temperatures.
+ *	<li><b>bio3</b>: Isothermality, bio2 / bio7 * 100.
+ *	<li><b>bio4</b>: Temperature seasonality, standard deviation of the monthly average
+ *		temperatures * 100.
+ *	<li><b>bio5</b>: Maximum temperature of the warmest month.
+ *	<li><b>bio6</b>: Minimum temperature of the coldest month.
+ *	<li><b>bio7</b>: Temperature annual range, bio5 - bio6.
+ *	<li><b>bio8</b>: Mean temperature of the wettest quarter.
+ *	<li><b>bio9</b>: Mean temperature of the driest quarter.
+ *	<li><b>bio10</b>: Mean temperature of the warmest quarter.
+ *	<li><b>bio11</b>: Mean temperature of the coldest quarter.
+ *	<li><b>bio12</b>: Annual precipitation.
+ *	<li><b>bio13</b>: Precipitation of the wettest month.
+ *	<li><b>bio14</b>: Precipitation of the driest month.
+ *	<li><b>bio15</b>: Precipitation seasonality, coefficient of variation of the monthly
+ *		precipitation, computed as standard deviation / (1 + mean) * 100.
+ *	<li><b>bio16</b>: Precipitation of the wettest quarter.
+ *	<li><b>bio17</b>: Precipitation of the driest quarter.
+ *	<li><b>bio18</b>: Precipitation of the warmest quarter.
+ *	<li><b>bio19</b>: Precipitation of the coldest quarter.
+ * </ul>
+ *
+ * The monthly average temperature is the mean of the minimum and maximum temperatures,
+ * quarters are the 12 circular windows of three consecutive months and standard
+ * deviations are sample standard deviations; ties select the first quarter.
+ *
+ * The inputs are month-major arrays: the value of month <i>m</i> for cell <i>c</i> is at
+ * <i>m * count + c</i>; the output is variable-major: bio<i>n</i> for cell <i>c</i> is at
+ * <i>(n - 1) * count + c</i>. On SSE2 capable processors four cells are processed at once.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Bioclim.cpp										*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * System includes.
+ */
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Local includes.
+ */
+#include "Bioclim.h"										// Bioclimatic variables.
+
+
+/*===================================================================================
+ *	ComputeCell																		*
+ *==================================================================================*/
+
+/**
+ * Compute cell bioclimatic variables.
+ *
+ * This function will compute the bioclimatic variables of a single cell.
+ *
+ * @param const SInt16 *	theMin				Monthly minimum temperatures.
+ * @param const SInt16 *	theMax				Monthly maximum temperatures.
+ * @param const SInt16 *	thePrec				Monthly precipitation.
+ * @param size_t			theCount			Number of cells.
+ * @param size_t			theCell				Cell index.
+ * @param float *			theOutput			Receives variables.
+ *
+ * @access private
+ * @return void
+ */
+static void ComputeCell( const SInt16 * theMin, const SInt16 * theMax,
+						 const SInt16 * thePrec, size_t theCount, size_t theCell,
+						 float * theOutput )
+{
+	//
+	// Init local storage.
+	//
+	float tavg [ kBIOCLIM_Months ], prec [ kBIOCLIM_Months ];
+	float tsum = 0, psum = 0, range = 0;
+	float tmax = -1e9f, tmin = 1e9f, pmax = -1e9f, pmin = 1e9f;
+
+	//
+	// Load months.
+	//
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		float low = theMin[ (month * theCount) + theCell ];
+		float high = theMax[ (month * theCount) + theCell ];
+		prec[ month ] = thePrec[ (month * theCount) + theCell ];
+		tavg[ month ] = (low + high) * 0.5f;
+
+		tsum += tavg[ month ];
+		psum += prec[ month ];
+		range += high - low;
+		tmax = ( high > tmax ) ? high : tmax;
+		tmin = ( low < tmin ) ? low : tmin;
+		pmax = ( prec[ month ] > pmax ) ? prec[ month ] : pmax;
+		pmin = ( prec[ month ] < pmin ) ? prec[ month ] : pmin;
+	}
+
+	//
+	// Compute deviations.
+	//
+	float tmean = tsum / kBIOCLIM_Months;
+	float pmean = psum / kBIOCLIM_Months;
+	float tdev = 0, pdev = 0;
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		tdev += (tavg[ month ] - tmean) * (tavg[ month ] - tmean);
+		pdev += (prec[ month ] - pmean) * (prec[ month ] - pmean);
+	}
+	tdev = sqrtf( tdev / (kBIOCLIM_Months - 1) );
+	pdev = sqrtf( pdev / (kBIOCLIM_Months - 1) );
+
+	//
+	// Scan quarters.
+	//
+	float wet = -1e9f, wet_t = 0, dry = 1e9f, dry_t = 0;
+	float warm = -1e9f, warm_p = 0, cold = 1e9f, cold_p = 0;
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		int next = (month + 1) % kBIOCLIM_Months;
+		int last = (month + 2) % kBIOCLIM_Months;
+		float tq = (tavg[ month ] + tavg[ next ] + tavg[ last ]) * (1.0f / 3.0f);
+		float pq = prec[ month ] + prec[ next ] + prec[ last ];
+
+		if( pq > wet )	{ wet = pq; wet_t = tq; }
+		if( pq < dry )	{ dry = pq; dry_t = tq; }
+		if( tq > warm )	{ warm = tq; warm_p = pq; }
+		if( tq < cold )	{ cold = tq; cold_p = pq; }
+	}
+
+	//
+	// Set variables.
+	//
+	float * out = theOutput + theCell;
+	out[ 0 * theCount ] = tmean;
+	out[ 1 * theCount ] = range / kBIOCLIM_Months;
+	out[ 2 * theCount ] = ( tmax > tmin )
+						? (100.0f * out[ 1 * theCount ] / (tmax - tmin))
+						: 0.0f;
+	out[ 3 * theCount ] = 100.0f * tdev;
+	out[ 4 * theCount ] = tmax;
+	out[ 5 * theCount ] = tmin;
+	out[ 6 * theCount ] = tmax - tmin;
+	out[ 7 * theCount ] = wet_t;
+	out[ 8 * theCount ] = dry_t;
+	out[ 9 * theCount ] = warm;
+	out[ 10 * theCount ] = cold;
+	out[ 11 * theCount ] = psum;
+	out[ 12 * theCount ] = pmax;
+	out[ 13 * theCount ] = pmin;
+	out[ 14 * theCount ] = 100.0f * pdev / (1.0f + pmean);
+	out[ 15 * theCount ] = wet;
+	out[ 16 * theCount ] = dry;
+	out[ 17 * theCount ] = warm_p;
+	out[ 18 * theCount ] = cold_p;
+
+} // ComputeCell.
+
+
+#ifdef __SSE2__
+
+/*===================================================================================
+ *	Load4																			*
+ *==================================================================================*/
+
+/**
+ * Load four values.
+ *
+ * This function will load four consecutive 16 bit integers as floats.
+ *
+ * @param const SInt16 *	theValues			Values.
+ *
+ * @access private
+ * @return __m128
+ */
+static inline __m128 Load4( const SInt16 * theValues )
+{
+	__m128i value = _mm_loadl_epi64( (const __m128i *) theValues );
+	value = _mm_srai_epi32( _mm_unpacklo_epi16( value, value ), 16 );
+
+	return _mm_cvtepi32_ps( value );											// ==>
+
+} // Load4.
+
+
+/*===================================================================================
+ *	Select4																			*
+ *==================================================================================*/
+
+/**
+ * Select values.
+ *
+ * This function will return the elements of <i>theTrue</i> where the mask is set and the
+ * elements of <i>theFalse</i> elsewhere.
+ *
+ * @param __m128			theMask				Selection mask.
+ * @param __m128			theTrue				Selected values.
+ * @param __m128			theFalse			Other values.
+ *
+ * @access private
+ * @return __m128
+ */
+static inline __m128 Select4( __m128 theMask, __m128 theTrue, __m128 theFalse )
+{
+	return _mm_or_ps( _mm_and_ps( theMask, theTrue ),
+					  _mm_andnot_ps( theMask, theFalse ) );						// ==>
+
+} // Select4.
+
+
+/*===================================================================================
+ *	ComputeCells4																	*
+ *==================================================================================*/
+
+/**
+ * Compute bioclimatic variables of four cells.
+ *
+ * This function is the SSE2 version of {@link ComputeCell() ComputeCell}, it processes
+ * the four cells starting at the provided cell.
+ *
+ * @param const SInt16 *	theMin				Monthly minimum temperatures.
+ * @param const SInt16 *	theMax				Monthly maximum temperatures.
+ * @param const SInt16 *	thePrec				Monthly precipitation.
+ * @param size_t			theCount			Number of cells.
+ * @param size_t			theCell				First cell index.
+ * @param float *			theOutput			Receives variables.
+ *
+ * @access private
+ * @return void
+ */
+static void ComputeCells4( const SInt16 * theMin, const SInt16 * theMax,
+						   const SInt16 * thePrec, size_t theCount, size_t theCell,
+						   float * theOutput )
+{
+	//
+	// Init local storage.
+	//
+	__m128 tavg [ kBIOCLIM_Months ], prec [ kBIOCLIM_Months ];
+	__m128 half = _mm_set1_ps( 0.5f );
+	__m128 tsum = _mm_setzero_ps(), psum = _mm_setzero_ps(), range = _mm_setzero_ps();
+	__m128 tmax = _mm_set1_ps( -1e9f ), tmin = _mm_set1_ps( 1e9f );
+	__m128 pmax = _mm_set1_ps( -1e9f ), pmin = _mm_set1_ps( 1e9f );
+
+	//
+	// Load months.
+	//
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		size_t index = (month * theCount) + theCell;
+		__m128 low = Load4( theMin + index );
+		__m128 high = Load4( theMax + index );
+		prec[ month ] = Load4( thePrec + index );
+		tavg[ month ] = _mm_mul_ps( _mm_add_ps( low, high ), half );
+
+		tsum = _mm_add_ps( tsum, tavg[ month ] );
+		psum = _mm_add_ps( psum, prec[ month ] );
+		range = _mm_add_ps( range, _mm_sub_ps( high, low ) );
+		tmax = _mm_max_ps( tmax, high );
+		tmin = _mm_min_ps( tmin, low );
+		pmax = _mm_max_ps( pmax, prec[ month ] );
+		pmin = _mm_min_ps( pmin, prec[ month ] );
+	}
+
+	//
+	// Compute deviations.
+	//
+	__m128 months = _mm_set1_ps( (float) kBIOCLIM_Months );
+	__m128 tmean = _mm_div_ps( tsum, months );
+	__m128 pmean = _mm_div_ps( psum, months );
+	__m128 tdev = _mm_setzero_ps(), pdev = _mm_setzero_ps();
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		__m128 dt = _mm_sub_ps( tavg[ month ], tmean );
+		__m128 dp = _mm_sub_ps( prec[ month ], pmean );
+		tdev = _mm_add_ps( tdev, _mm_mul_ps( dt, dt ) );
+		pdev = _mm_add_ps( pdev, _mm_mul_ps( dp, dp ) );
+	}
+	__m128 degrees = _mm_set1_ps( (float) (kBIOCLIM_Months - 1) );
+	tdev = _mm_sqrt_ps( _mm_div_ps( tdev, degrees ) );
+	pdev = _mm_sqrt_ps( _mm_div_ps( pdev, degrees ) );
+
+	//
+	// Scan quarters.
+	//
+	__m128 third = _mm_set1_ps( 1.0f / 3.0f );
+	__m128 wet = _mm_set1_ps( -1e9f ), dry = _mm_set1_ps( 1e9f );
+	__m128 warm = _mm_set1_ps( -1e9f ), cold = _mm_set1_ps( 1e9f );
+	__m128 wet_t = _mm_setzero_ps(), dry_t = _mm_setzero_ps();
+	__m128 warm_p = _mm_setzero_ps(), cold_p = _mm_setzero_ps();
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		int next = (month + 1) % kBIOCLIM_Months;
+		int last = (month + 2) % kBIOCLIM_Months;
+		__m128 tq = _mm_mul_ps( _mm_add_ps( _mm_add_ps( tavg[ month ], tavg[ next ] ),
+											tavg[ last ] ), third );
+		__m128 pq = _mm_add_ps( _mm_add_ps( prec[ month ], prec[ next ] ), prec[ last ] );
+
+		__m128 mask = _mm_cmpgt_ps( pq, wet );
+		wet = Select4( mask, pq, wet );
+		wet_t = Select4( mask, tq, wet_t );
+
+		mask = _mm_cmplt_ps( pq, dry );
+		dry = Select4( mask, pq, dry );
+		dry_t = Select4( mask, tq, dry_t );
+
+		mask = _mm_cmpgt_ps( tq, warm );
+		warm = Select4( mask, tq, warm );
+		warm_p = Select4( mask, pq, warm_p );
+
+		mask = _mm_cmplt_ps( tq, cold );
+		cold = Select4( mask, tq, cold );
+		cold_p = Select4( mask, pq, cold_p );
+	}
+
+	//
+	// Set variables.
+	//
+	__m128 hundred = _mm_set1_ps( 100.0f );
+	__m128 diurnal = _mm_div_ps( range, months );
+	__m128 annual = _mm_sub_ps( tmax, tmin );
+	__m128 iso = Select4( _mm_cmpgt_ps( annual, _mm_setzero_ps() ),
+						  _mm_div_ps( _mm_mul_ps( hundred, diurnal ), annual ),
+						  _mm_setzero_ps() );
+	__m128 cv = _mm_div_ps( _mm_mul_ps( hundred, pdev ),
+							_mm_add_ps( _mm_set1_ps( 1.0f ), pmean ) );
+
+	float * out = theOutput + theCell;
+	_mm_storeu_ps( out + (0 * theCount), tmean );
+	_mm_storeu_ps( out + (1 * theCount), diurnal );
+	_mm_storeu_ps( out + (2 * theCount), iso );
+	_mm_storeu_ps( out + (3 * theCount), _mm_mul_ps( hundred, tdev ) );
+	_mm_storeu_ps( out + (4 * theCount), tmax );
+	_mm_storeu_ps( out + (5 * theCount), tmin );
+	_mm_storeu_ps( out + (6 * theCount), annual );
+	_mm_storeu_ps( out + (7 * theCount), wet_t );
+	_mm_storeu_ps( out + (8 * theCount), dry_t );
+	_mm_storeu_ps( out + (9 * theCount), warm );
+	_mm_storeu_ps( out + (10 * theCount), cold );
+	_mm_storeu_ps( out + (11 * theCount), psum );
+	_mm_storeu_ps( out + (12 * theCount), pmax );
+	_mm_storeu_ps( out + (13 * theCount), pmin );
+	_mm_storeu_ps( out + (14 * theCount), cv );
+	_mm_storeu_ps( out + (15 * theCount), wet );
+	_mm_storeu_ps( out + (16 * theCount), dry );
+	_mm_storeu_ps( out + (17 * theCount), warm_p );
+	_mm_storeu_ps( out + (18 * theCount), cold_p );
+
+} // ComputeCells4.
+
+#endif // __SSE2__
+
+
+/*===================================================================================
+ *	ComputeBioclim																	*
+ *==================================================================================*/
+
+/**
+ * Compute bioclimatic variables.
+ *
+ * This function will compute the 19 bioclimatic variables of the provided cells, see the
+ * file header for the arrays layout. The function does not check for missing values,
+ * callers must discard the cells holding the sea token.
+ *
+ * @param const SInt16 *	theMin				Monthly minimum temperatures.
+ * @param const SInt16 *	theMax				Monthly maximum temperatures.
+ * @param const SInt16 *	thePrec				Monthly precipitation.
+ * @param size_t			theCount			Number of cells.
+ * @param float *			theOutput			Receives variables.
+ *
+ * @access public
+ * @return void
+ */
+void ComputeBioclim( const SInt16 * theMin, const SInt16 * theMax, const SInt16 * thePrec,
+					 size_t theCount, float * theOutput )
+{
+	size_t cell = 0;
+
+#ifdef __SSE2__
+	//
+	// Compute blocks of four cells.
+	//
+	for( ; (cell + 4) <= theCount; cell += 4 )
+		ComputeCells4( theMin, theMax, thePrec, theCount, cell, theOutput );
+#endif
+
+	//
+	// Compute remaining cells.
+	//
+	for( ; cell < theCount; cell++ )
+		ComputeCell( theMin, theMax, thePrec, theCount, cell, theOutput );
+
+} // ComputeBioclim.
@@ -0,0 +1,49 @@
+/**
+ * Bioclimatic variables definitions.
+ *
+ * This file contains the declarations of the bioclimatic variables engine: the engine
+ * derives the 19 BIOCLIM variables from the monthly minimum temperature, maximum
+ * temperature and precipitation series of a set of cells.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef BIOCLIM_H
+#define BIOCLIM_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Types.h"
+
+using namespace std;
+
+
+/**
+ * Bioclimatic variables count.
+ *
+ * This constant holds the number of bioclimatic variables.
+ */
+const int kBIOCLIM_Count = 19;
+
+/**
+ * Bioclimatic months count.
+ *
+ * This constant holds the number of months of the input series.
+ */
+const int kBIOCLIM_Months = 12;
+
+/**
+ * ComputeBioclim.
+ *
+ * Compute bioclimatic variables of a set of cells.
+ */
+void ComputeBioclim( const SInt16 * theMin, const SInt16 * theMax, const SInt16 * thePrec,
+					 size_t theCount, float * theOutput );
+
+#endif // BIOCLIM_H
@@ -10,11 +10,14 @@
  *	@version	1.00 06/01/2010
  */
 
+#ifndef CONSTANTS_H
+#define CONSTANTS_H
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
-#include <CoreServices/CoreServices.h>
+#include "Types.h"
 
 using namespace std;
 
@@ -26,7 +29,7 @@ using namespace std;
  *
  * This constant holds the number of tiles.
  */
-const int kGTOPO30_TilesCount = 34;
+const int kGTOPO30_TilesCount = 33;
 
 /**
  * WORLDCLIM files count.
@@ -64,6 +67,35 @@ const int kPointsLatDegree = 120;
  */
 const int kPointsLonDegree = 120;
 
+/**
+ * Compile-time check.
+ *
+ * This macro declares an array type whose size is negative when the provided condition
+ * is false, so that inconsistent tables and constants fail to compile.
+ */
+#define CHECK_CONSTANT( theName, theCondition )									\
+	typedef char theName [ ( theCondition ) ? 1 : -1 ]
+
+/**
+ * WORLDCLIM grid.
+ *
+ * These constants hold the bounds and the number of rows and columns shared by the
+ * WORLDCLIM layers.
+ */
+const int kWORLDCLIM_LatMin = -60;
+const int kWORLDCLIM_LatMax = 90;
+const int kWORLDCLIM_LonMin = -180;
+const int kWORLDCLIM_LonMax = 180;
+const int kWORLDCLIM_CountY = 18000;
+const int kWORLDCLIM_CountX = 43200;
+
+CHECK_CONSTANT( kCHECK_WORLDCLIM_CountY,
+				(kWORLDCLIM_LatMax - kWORLDCLIM_LatMin) * kPointsLatDegree
+				== kWORLDCLIM_CountY );
+CHECK_CONSTANT( kCHECK_WORLDCLIM_CountX,
+				(kWORLDCLIM_LonMax - kWORLDCLIM_LonMin) * kPointsLonDegree
+				== kWORLDCLIM_CountX );
+
 /**
  * Source point size.
  *
@@ -78,55 +110,209 @@ const ifstream::pos_type kSourcePointSize = 1;
  */
 const ifstream::pos_type kDataPointSize = 2;
 
+/**
+ * Sample types.
+ *
+ * These constants hold the supported raster sample types.
+ */
+const int kTYPE_SINT16 = 1;
+const int kTYPE_UINT8 = 2;
+
+/**
+ * I/O modes.
+ *
+ * These constants hold the ways band values are read: from memory mapped files, with
+ * batched asynchronous reads submitted through an io_uring queue, or with <i>pread</i>
+ * from the files opened at load, for file systems where mapping is unreliable.
+ */
+const int kIO_MMAP = 0;
+const int kIO_URING = 1;
+const int kIO_PREAD = 2;
+
+/**
+ * Heat map cells.
+ *
+ * This constant holds the maximum number of queried cells kept in the server heat map
+ * file, the most queried are kept.
+ */
+const size_t kHEAT_Cells = 65536;
+
+/**
+ * Heat map save interval.
+ *
+ * This constant holds the number of server queries after which the heat map is saved.
+ */
+const size_t kHEAT_Save = 1000;
+
+/**
+ * Prewarmed cells.
+ *
+ * This constant holds the number of most queried cells whose pages are loaded when the
+ * server starts or reloads its dataset.
+ */
+const size_t kHEAT_Prewarm = 4096;
+
+/**
+ * Batch read size.
+ *
+ * This constant holds the size of the reads of batch coordinate files, which are read
+ * whole before being parsed.
+ */
+const size_t kBATCH_Chunk = 65536;
+
+/**
+ * Hash multiplier.
+ *
+ * This constant holds the odd multiplier mixing the cell offsets of the batch points into
+ * their hash, see GetWORLDCLIMReads().
+ */
+const UInt64 kHASH_Multiplier = 0xFF51AFD7ED558CCDULL;
+
+/**
+ * Benchmark seed.
+ *
+ * This constant holds the seed of the benchmark points generator, so that all runs query
+ * the same points.
+ */
+const UInt64 kBENCH_Seed = 0x9E3779B97F4A7C15ULL;
+
+/**
+ * Benchmark batch size.
+ *
+ * This constant holds the number of points of the benchmark batch queries.
+ */
+const size_t kBENCH_Batch = 1000;
+
+/**
+ * Derived layer kinds.
+ *
+ * These constants hold the kinds of layers that are computed from other layers rather
+ * than read from files.
+ */
+const int kDERIVED_NONE = 0;
+const int kDERIVED_BIOCLIM = 1;
+const int kDERIVED_GDD = 2;
+const int kDERIVED_PET = 3;
+const int kDERIVED_ARIDITY = 4;
+const int kDERIVED_FROST = 5;
+
+/**
+ * Derived layers count.
+ *
+ * This constant holds the number of built-in derived layers.
+ */
+const int kDERIVED_LayersCount = 5;
+
+/**
+ * Default manifest name.
+ *
+ * This constant holds the name of the manifest file that is looked for in the base
+ * directory when no manifest is provided on the command line.
+ */
+const char * const kManifestName = "GeographicFeatures.ini";
+
+/**
+ * XML header.
+ *
+ * This constant holds the XML declaration and the unclosed root element that open every
+ * response.
+ */
+const char kXML_Header [] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<WSLocationGeographicFeatures "
+	"xmlns=\"urn:bioversityinternational.org:schemas:standards\" "
+	"xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+	"xsi:schemaLocation=\"urn:bioversityinternational.org:schemas:standards "
+	"http://schema.grinfo.net/elements/WSLocationGeographicFeatures.xsd\"";
+
+/**
+ * Base scenario name.
+ *
+ * This constant holds the name of the base dataset scenario.
+ */
+const char * const kBaseScenario = "current";
+
+/**
+ * GTOPO-30 tile shape.
+ *
+ * This macro expands to 0, or fails to compile if the provided bounds are not those of a
+ * GTOPO-30 tile: 50 degrees of latitude by 40 of longitude, or 30 by 60 in the row south
+ * of 60 degrees south.
+ */
+#define GTOPO30_SHAPE( theLatMin, theLatMax, theLonMin, theLonMax )				\
+	(0 * sizeof( char [ ( (((theLatMax) - (theLatMin)) == 50)					\
+						 && (((theLonMax) - (theLonMin)) == 40) )				\
+					 || ( ((theLatMin) == -90) && ((theLatMax) == -60)			\
+						 && (((theLonMax) - (theLonMin)) == 60) )				\
+					   ? 1 : -1 ] ))
+
+/**
+ * GTOPO-30 tile entry.
+ *
+ * This macro expands to a <i>{@link TILES_T TILES_T}</i> initialiser from the tile name
+ * and bounds: the files path and the grid counts at the default resolution are computed
+ * by the compiler, which also checks the tile shape, see GTOPO30_SHAPE(). Tile names are
+ * those of their north west corner.
+ */
+#define GTOPO30_TILE( theName, theLatMin, theLatMax, theLonMin, theLonMax )		\
+	{ theName, "GTOPO30/" theName "/" theName,									\
+	  { theLatMin, theLatMax, theLonMin, theLonMax },							\
+	  ((theLatMax) - (theLatMin)) * kPointsLatDegree							\
+	  + GTOPO30_SHAPE( theLatMin, theLatMax, theLonMin, theLonMax ),			\
+	  ((theLonMax) - (theLonMin)) * kPointsLonDegree }
+
 /**
  * GTOPO-30 tiles data.
  *
  * Here we allocate and fill the tiles information.
  */
-TILES_T kGTOPO30_Tiles [ kGTOPO30_TilesCount ] =
+const TILES_T kGTOPO30_Tiles [] =
 {
-	"ANTARCPS", -90, -60, -180, 180,
-	"W180S60", -90, -60, -180, -120,
-	"W120S60", -90, 60, -120, -60,
-	"W060S60", -90, -60, -60, 0,
-	"W000S60", -90, -60, 0, 60,
-	"E060S60", -90, -60, 60, 120,
-	"E120S60", -90, -60, 120, 180,
-	"W180S10", -60, -10, -180, -140,
-	"W180N90", 40, 90, -180, -140,
-	"W180N40", -10, 40, -180, -140,
-	"W140S10", -60, -10, -140, -100,
-	"W140N90", 40, 90, -140, -100,
-	"W140N40", -10, 40, -140, -100,
-	"W100S10", -60, -10, -100, -60,
-	"W100N90", 40, 90, -100, -60,
-	"W100N40", -10, 40, -100, -60,
-	"W060S10", -60, -10, -60, -20,
-	"W060N90", 40, 90, -60, -20,
-	"W060N40", -10, 40, -60, -20,
-	"W020S10", -60, -10, -20, 20,
-	"W020N90", 40, 90, -20, 20,
-	"W020N40", -10, 40, -20, 20,
-	"E020S10", -60, -10, 20, 60,
-	"E020N90", 40, 90, 20, 60,
-	"E020N40", -10, 40, 20, 60,
-	"E020N40", -60, -10, 60, 100,
-	"E060N90", 40, 90, 60, 100,
-	"E060N40", -10, 40, 60, 100,
-	"E100S10", -60, -10, 100, 140,
-	"E100N90", 40, 90, 100, 140,
-	"E100N40", -10, 40, 100, 140,
-	"E100N40", -60, -10, 140, 180,
-	"E140N90", 40, 90, 140, 180,
-	"E140N40", -10, 40, 140, 180
+	GTOPO30_TILE( "W180S60", -90, -60, -180, -120 ),
+	GTOPO30_TILE( "W120S60", -90, -60, -120, -60 ),
+	GTOPO30_TILE( "W060S60", -90, -60, -60, 0 ),
+	GTOPO30_TILE( "W000S60", -90, -60, 0, 60 ),
+	GTOPO30_TILE( "E060S60", -90, -60, 60, 120 ),
+	GTOPO30_TILE( "E120S60", -90, -60, 120, 180 ),
+	GTOPO30_TILE( "W180S10", -60, -10, -180, -140 ),
+	GTOPO30_TILE( "W180N90", 40, 90, -180, -140 ),
+	GTOPO30_TILE( "W180N40", -10, 40, -180, -140 ),
+	GTOPO30_TILE( "W140S10", -60, -10, -140, -100 ),
+	GTOPO30_TILE( "W140N90", 40, 90, -140, -100 ),
+	GTOPO30_TILE( "W140N40", -10, 40, -140, -100 ),
+	GTOPO30_TILE( "W100S10", -60, -10, -100, -60 ),
+	GTOPO30_TILE( "W100N90", 40, 90, -100, -60 ),
+	GTOPO30_TILE( "W100N40", -10, 40, -100, -60 ),
+	GTOPO30_TILE( "W060S10", -60, -10, -60, -20 ),
+	GTOPO30_TILE( "W060N90", 40, 90, -60, -20 ),
+	GTOPO30_TILE( "W060N40", -10, 40, -60, -20 ),
+	GTOPO30_TILE( "W020S10", -60, -10, -20, 20 ),
+	GTOPO30_TILE( "W020N90", 40, 90, -20, 20 ),
+	GTOPO30_TILE( "W020N40", -10, 40, -20, 20 ),
+	GTOPO30_TILE( "E020S10", -60, -10, 20, 60 ),
+	GTOPO30_TILE( "E020N90", 40, 90, 20, 60 ),
+	GTOPO30_TILE( "E020N40", -10, 40, 20, 60 ),
+	GTOPO30_TILE( "E060S10", -60, -10, 60, 100 ),
+	GTOPO30_TILE( "E060N90", 40, 90, 60, 100 ),
+	GTOPO30_TILE( "E060N40", -10, 40, 60, 100 ),
+	GTOPO30_TILE( "E100S10", -60, -10, 100, 140 ),
+	GTOPO30_TILE( "E100N90", 40, 90, 100, 140 ),
+	GTOPO30_TILE( "E100N40", -10, 40, 100, 140 ),
+	GTOPO30_TILE( "E140S10", -60, -10, 140, 180 ),
+	GTOPO30_TILE( "E140N90", 40, 90, 140, 180 ),
+	GTOPO30_TILE( "E140N40", -10, 40, 140, 180 )
 };
 
+CHECK_CONSTANT( kCHECK_GTOPO30_Tiles,
+				sizeof( kGTOPO30_Tiles ) / sizeof( kGTOPO30_Tiles[ 0 ] )
+				== kGTOPO30_TilesCount );
+
 /**
  * GTOPO-30 data sources list.
  *
  * Here we allocate the WORLDCLIM tiles information.
  */
-const string kGTOPO30_Sources [ kGTOPO30_SourcesCount ] = 
+const char * const kGTOPO30_Sources [] =
 {
 	"Ocean",
 	"Digital Terrain Elevation Data",
@@ -140,155 +326,127 @@ const string kGTOPO30_Sources [ kGTOPO30_SourcesCount ] =
 	"SRTM data"
 };
 
+CHECK_CONSTANT( kCHECK_GTOPO30_Sources,
+				sizeof( kGTOPO30_Sources ) / sizeof( kGTOPO30_Sources[ 0 ] )
+				== kGTOPO30_SourcesCount );
+
+/**
+ * WORLDCLIM layer entries.
+ *
+ * These macros expand to a <i>{@link WORLDCLIM_T WORLDCLIM_T}</i> initialiser from the
+ * layer name and source, on the WORLDCLIM grid: <i>WORLDCLIM_LAYER</i> declares a single
+ * file layer, <i>WORLDCLIM_SERIES</i> a monthly series whose path holds the month
+ * number pattern.
+ */
+#define WORLDCLIM_LAYER( theName, theSource )									\
+	{ theName, theSource, "WORLDCLIM30/" theName "/" theName ".bil", 0,			\
+	  kWORLDCLIM_LatMin, kWORLDCLIM_LatMax,										\
+	  kWORLDCLIM_LonMin, kWORLDCLIM_LonMax,										\
+	  kWORLDCLIM_CountY, kWORLDCLIM_CountX }
+#define WORLDCLIM_SERIES( theName, theSource )									\
+	{ theName, theSource, "WORLDCLIM30/" theName "/" theName "_%d.bil", 12,		\
+	  kWORLDCLIM_LatMin, kWORLDCLIM_LatMax,										\
+	  kWORLDCLIM_LonMin, kWORLDCLIM_LonMax,										\
+	  kWORLDCLIM_CountY, kWORLDCLIM_CountX }
+
 /**
  * WORLDCLIM tiles data.
  *
- * This array of strings contains the sources of the data.
+ * This array contains the WORLDCLIM layers.
  */
-WORLDCLIM_T kWORLDCLIM_Tiles [ kWORLDCLIM_FilesCount ] =
+const WORLDCLIM_T kWORLDCLIM_Tiles [] =
+{
+	WORLDCLIM_LAYER( "alt",
+		"Shuttle Radar Topography Mission (SRTM) (30 sec.)" ),
+	WORLDCLIM_SERIES( "tmean",
+		"WORLDCLIM 30 sec. average monthly mean temperature [C° * 10]" ),
+	WORLDCLIM_SERIES( "tmin",
+		"WORLDCLIM 30 sec. average monthly minimum temperature [C° * 10]" ),
+	WORLDCLIM_SERIES( "tmax",
+		"WORLDCLIM 30 sec. average monthly maximum temperature [C° * 10]" ),
+	WORLDCLIM_SERIES( "prec",
+		"WORLDCLIM 30 sec. average monthly precipitation [mm.]" ),
+	WORLDCLIM_LAYER( "bio1",
+		"WORLDCLIM 30 sec. Annual Mean Temperature [C° * 10]" ),
+	WORLDCLIM_LAYER( "bio2",
+		"WORLDCLIM 30 sec. Mean Diurnal Range (Mean of monthly (max temp - min temp)) [C° * 10]" ),
+	WORLDCLIM_LAYER( "bio3",
+		"WORLDCLIM 30 sec. Isothermality (P2/P7) (* 100)" ),
+	WORLDCLIM_LAYER( "bio4",
+		"WORLDCLIM 30 sec. Temperature Seasonality (standard deviation *100)" ),
+	WORLDCLIM_LAYER( "bio5",
+		"WORLDCLIM 30 sec. Maximum Temperature of Warmest Month [C° * 10]" ),
+	WORLDCLIM_LAYER( "bio6",
+		"WORLDCLIM 30 sec. Minimum Temperature of Coldest Month [C° * 10]" ),
+	WORLDCLIM_LAYER( "bio7",
+		"WORLDCLIM 30 sec. Temperature Annual Range (P5-P6)" ),
+	WORLDCLIM_LAYER( "bio8",
+		"WORLDCLIM 30 sec. Mean Temperature of Wettest Quarter [C° * 10]" ),
+	WORLDCLIM_LAYER( "bio9",
+		"WORLDCLIM 30 sec. Mean Temperature of Driest Quarter [C° * 10]" ),
+	WORLDCLIM_LAYER( "bio10",
+		"WORLDCLIM 30 sec. Mean Temperature of Warmest Quarter [C° * 10]" ),
+	WORLDCLIM_LAYER( "bio11",
+		"WORLDCLIM 30 sec. Mean Temperature of Coldest Quarter [C° * 10]" ),
+	WORLDCLIM_LAYER( "bio12",
+		"WORLDCLIM 30 sec. Annual Precipitation" ),
+	WORLDCLIM_LAYER( "bio13",
+		"WORLDCLIM 30 sec. Precipitation of Wettest Month" ),
+	WORLDCLIM_LAYER( "bio14",
+		"WORLDCLIM 30 sec. Precipitation of Driest Month" ),
+	WORLDCLIM_LAYER( "bio15",
+		"WORLDCLIM 30 sec. Precipitation Seasonality (Coefficient of Variation)" ),
+	WORLDCLIM_LAYER( "bio16",
+		"WORLDCLIM 30 sec. Precipitation of Wettest Quarter" ),
+	WORLDCLIM_LAYER( "bio17",
+		"WORLDCLIM 30 sec. Precipitation of Driest Quarter" ),
+	WORLDCLIM_LAYER( "bio18",
+		"WORLDCLIM 30 sec. Precipitation of Warmest Quarter" ),
+	WORLDCLIM_LAYER( "bio19",
+		"WORLDCLIM 30 sec. Precipitation of Coldest Quarter" )
+};
+
+CHECK_CONSTANT( kCHECK_WORLDCLIM_Tiles,
+				sizeof( kWORLDCLIM_Tiles ) / sizeof( kWORLDCLIM_Tiles[ 0 ] )
+				== kWORLDCLIM_FilesCount );
+
+/**
+ * Derived layers data.
+ *
+ * This array contains the built-in agro-climatic layers, they are computed from the
+ * monthly minimum temperature, maximum temperature and precipitation layers.
+ */
+const DERIVED_T kDERIVED_Layers [] =
 {
 	{
-		"alt",
-		"Shuttle Radar Topography Mission (SRTM) (30 sec.)",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"tmean",
-		"WORLDCLIM 30 sec. average monthly mean temperature [C° * 10]",
-		12,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"tmin",
-		"WORLDCLIM 30 sec. average monthly minimum temperature [C° * 10]",
-		12,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"tmax",
-		"WORLDCLIM 30 sec. average monthly maximum temperature [C° * 10]",
-		12,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"prec",
-		"WORLDCLIM 30 sec. average monthly precipitation [mm.]",
-		12,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio1",
-		"WORLDCLIM 30 sec. Annual Mean Temperature [C° * 10]",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio2",
-		"WORLDCLIM 30 sec. Mean Diurnal Range (Mean of monthly (max temp - min temp)) [C° * 10]",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio3",
-		"WORLDCLIM 30 sec. Isothermality (P2/P7) (* 100)",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio4",
-		"WORLDCLIM 30 sec. Temperature Seasonality (standard deviation *100)",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio5",
-		"WORLDCLIM 30 sec. Maximum Temperature of Warmest Month [C° * 10]",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio6",
-		"WORLDCLIM 30 sec. Minimum Temperature of Coldest Month [C° * 10]",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio7",
-		"WORLDCLIM 30 sec. Temperature Annual Range (P5-P6)",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio8",
-		"WORLDCLIM 30 sec. Mean Temperature of Wettest Quarter [C° * 10]",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio9",
-		"WORLDCLIM 30 sec. Mean Temperature of Driest Quarter [C° * 10]",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio10",
-		"WORLDCLIM 30 sec. Mean Temperature of Warmest Quarter [C° * 10]",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio11",
-		"WORLDCLIM 30 sec. Mean Temperature of Coldest Quarter [C° * 10]",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio12",
-		"WORLDCLIM 30 sec. Annual Precipitation",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio13",
-		"WORLDCLIM 30 sec. Precipitation of Wettest Month",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio14",
-		"WORLDCLIM 30 sec. Precipitation of Driest Month",
-		0,
-		-60, 90, -180, 180, 18000, 43200
-	},
-	{
-		"bio15",
-		"WORLDCLIM 30 sec. Precipitation Seasonality (Coefficient of Variation)",
-		0,
-		-60, 90, -180, 180, 18000, 43200
+		"gdd5",
+		"Growing degree days above 5 C° [C° * days]",
+		kDERIVED_GDD, 5
 	},
 	{
-		"bio16",
-		"WORLDCLIM 30 sec. Precipitation of Wettest Quarter",
-		0,
-		-60, 90, -180, 180, 18000, 43200
+		"gdd10",
+		"Growing degree days above 10 C° [C° * days]",
+		kDERIVED_GDD, 10
 	},
 	{
-		"bio17",
-		"WORLDCLIM 30 sec. Precipitation of Driest Quarter",
-		0,
-		-60, 90, -180, 180, 18000, 43200
+		"pet",
+		"Annual potential evapotranspiration, Hargreaves [mm.]",
+		kDERIVED_PET, 0
 	},
 	{
-		"bio18",
-		"WORLDCLIM 30 sec. Precipitation of Warmest Quarter",
-		0,
-		-60, 90, -180, 180, 18000, 43200
+		"aridity",
+		"Aridity index (annual precipitation / pet)",
+		kDERIVED_ARIDITY, 0
 	},
 	{
-		"bio19",
-		"WORLDCLIM 30 sec. Precipitation of Coldest Quarter",
-		0,
-		-60, 90, -180, 180, 18000, 43200
+		"frost",
+		"Number of months with minimum temperature below 0 C°",
+		kDERIVED_FROST, 0
 	}
 };
+
+CHECK_CONSTANT( kCHECK_DERIVED_Layers,
+				sizeof( kDERIVED_Layers ) / sizeof( kDERIVED_Layers[ 0 ] )
+				== kDERIVED_LayersCount );
+
+#endif // CONSTANTS_H
@@ -0,0 +1,183 @@
+/**
+ * Decode.
+ *
+ * This file contains the sample decoding functions. Files are mapped or read as they are
+ * stored, so values are decoded after the copy, in the caller buffer: 16 bit samples
+ * stored in the other byte order have their bytes swapped, byte samples are widened to
+ * 16 bits. Rows are decoded with vector instructions where available, 16 or 32 bytes at
+ * a time, so that area scans decode at memory bandwidth; the remaining values are
+ * decoded one by one.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Decode.cpp										*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * System includes.
+ */
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/**
+ * Local includes.
+ */
+#include "Decode.h"											// Decoding.
+
+
+/*===================================================================================
+ *	SwapRow																			*
+ *==================================================================================*/
+
+/**
+ * Swap row bytes.
+ *
+ * This function will swap the bytes of the provided values in place: with AVX2 16
+ * values are shuffled at once, with SSSE3 8 values, with SSE2 8 values are shifted, on
+ * ARM 8 values are reversed.
+ *
+ * @param UInt16 *			theValues			Values.
+ * @param size_t			theCount			Number of values.
+ *
+ * @access public
+ * @return void
+ */
+void SwapRow( UInt16 * theValues, size_t theCount )
+{
+	size_t i = 0;
+
+#if defined( __AVX2__ )
+	const __m256i order = _mm256_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6,
+											9, 8, 11, 10, 13, 12, 15, 14,
+											1, 0, 3, 2, 5, 4, 7, 6,
+											9, 8, 11, 10, 13, 12, 15, 14 );
+	for( ; (i + 16) <= theCount; i += 16 )
+	{
+		__m256i * block = (__m256i *) (theValues + i);
+		_mm256_storeu_si256( block,
+							 _mm256_shuffle_epi8( _mm256_loadu_si256( block ), order ) );
+	}
+#elif defined( __SSSE3__ )
+	const __m128i order = _mm_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6,
+										 9, 8, 11, 10, 13, 12, 15, 14 );
+	for( ; (i + 8) <= theCount; i += 8 )
+	{
+		__m128i * block = (__m128i *) (theValues + i);
+		_mm_storeu_si128( block, _mm_shuffle_epi8( _mm_loadu_si128( block ), order ) );
+	}
+#elif defined( __SSE2__ )
+	for( ; (i + 8) <= theCount; i += 8 )
+	{
+		__m128i * block = (__m128i *) (theValues + i);
+		__m128i value = _mm_loadu_si128( block );
+		_mm_storeu_si128( block, _mm_or_si128( _mm_slli_epi16( value, 8 ),
+											   _mm_srli_epi16( value, 8 ) ) );
+	}
+#elif defined( __ARM_NEON )
+	for( ; (i + 8) <= theCount; i += 8 )
+	{
+		UInt8 * block = (UInt8 *) (theValues + i);
+		vst1q_u8( block, vrev16q_u8( vld1q_u8( block ) ) );
+	}
+#endif
+
+	for( ; i < theCount; i++ )
+		theValues[ i ] = SwapValue( theValues[ i ] );
+
+} // SwapRow.
+
+
+/*===================================================================================
+ *	WidenRow																		*
+ *==================================================================================*/
+
+/**
+ * Widen row bytes.
+ *
+ * This function will widen the provided number of bytes, stored at the start of the
+ * provided buffer, to 16 bit values in place. Values are widened from the end of the
+ * buffer, so that no byte is overwritten before it is read: the values beyond the last
+ * multiple of 16 first, then 16 bytes at a time with SSE2 or on ARM.
+ *
+ * @param SInt16 *			theValues			Buffer, holding the bytes on input.
+ * @param size_t			theCount			Number of values.
+ *
+ * @access public
+ * @return void
+ */
+void WidenRow( SInt16 * theValues, size_t theCount )
+{
+	const UInt8 * bytes = (const UInt8 *) theValues;
+	size_t i = theCount;
+	for( ; i % 16; i-- )
+		theValues[ i - 1 ] = bytes[ i - 1 ];
+
+#if defined( __SSE2__ )
+	const __m128i zero = _mm_setzero_si128();
+	for( ; i >= 16; i -= 16 )
+	{
+		__m128i value = _mm_loadu_si128( (const __m128i *) (bytes + i - 16) );
+		_mm_storeu_si128( (__m128i *) (theValues + i - 16),
+						  _mm_unpacklo_epi8( value, zero ) );
+		_mm_storeu_si128( (__m128i *) (theValues + i - 8),
+						  _mm_unpackhi_epi8( value, zero ) );
+	}
+#elif defined( __ARM_NEON )
+	for( ; i >= 16; i -= 16 )
+	{
+		uint8x16_t value = vld1q_u8( bytes + i - 16 );
+		vst1q_u16( (uint16_t *) (theValues + i - 16), vmovl_u8( vget_low_u8( value ) ) );
+		vst1q_u16( (uint16_t *) (theValues + i - 8), vmovl_u8( vget_high_u8( value ) ) );
+	}
+#endif
+
+	for( ; i > 0; i-- )
+		theValues[ i - 1 ] = bytes[ i - 1 ];
+
+} // WidenRow.
+
+
+/*===================================================================================
+ *	DecodeRow																		*
+ *==================================================================================*/
+
+/**
+ * Decode row.
+ *
+ * This function will decode in place the provided number of samples of the provided
+ * type, copied as stored at the start of the provided buffer.
+ *
+ * @param SInt16 *			theValues			Buffer, holding the samples on input.
+ * @param size_t			theCount			Number of samples.
+ * @param int				theType				Sample type, one of the kTYPE_ constants.
+ * @param bool				doSwap				TRUE means swap bytes.
+ *
+ * @access public
+ * @return void
+ */
+void DecodeRow( SInt16 * theValues, size_t theCount, int theType, bool doSwap )
+{
+	if( theType == kTYPE_UINT8 )
+		WidenRow( theValues, theCount );
+	else if( doSwap )
+		SwapRow( (UInt16 *) theValues, theCount );
+
+} // DecodeRow.
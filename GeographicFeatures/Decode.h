@@ -0,0 +1,82 @@
+/**
+ * Decode definitions.
+ *
+ * This file contains the declarations of the sample decoding functions: band values are
+ * read as stored in the files and converted here to native 16 bit integers, swapping
+ * the bytes of files stored in the other byte order and widening byte samples.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef DECODE_H
+#define DECODE_H
+
+#include <cstring>
+#include "Types.h"
+#include "Constants.h"
+
+using namespace std;
+
+
+/**
+ * Host byte order.
+ *
+ * This constant is set if the host stores integers most significant byte first.
+ */
+#if defined( __BYTE_ORDER__ ) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+const bool kHOST_BigEndian = true;
+#else
+const bool kHOST_BigEndian = false;
+#endif
+
+/**
+ * SwapValue.
+ *
+ * Swap the bytes of a value.
+ */
+inline UInt16 SwapValue( UInt16 theValue )
+{
+	return (UInt16) ((theValue << 8) | (theValue >> 8));
+}
+
+/**
+ * DecodeValue.
+ *
+ * Decode a stored sample.
+ */
+inline SInt16 DecodeValue( const char * theData, int theType, bool doSwap )
+{
+	if( theType == kTYPE_UINT8 )
+		return (UInt8) theData[ 0 ];
+
+	UInt16 value;
+	memcpy( &value, theData, 2 );
+	return (SInt16) (( doSwap ) ? SwapValue( value ) : value);
+}
+
+/**
+ * SwapRow.
+ *
+ * Swap the bytes of a row of values.
+ */
+void SwapRow( UInt16 * theValues, size_t theCount );
+
+/**
+ * WidenRow.
+ *
+ * Widen a row of byte samples in place.
+ */
+void WidenRow( SInt16 * theValues, size_t theCount );
+
+/**
+ * DecodeRow.
+ *
+ * Decode a row of stored samples in place.
+ */
+void DecodeRow( SInt16 * theValues, size_t theCount, int theType, bool doSwap );
+
+#endif // DECODE_H
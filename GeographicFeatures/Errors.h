@@ -10,11 +10,14 @@
  *	@version	1.00 06/01/2010
  */
 
+#ifndef ERRORS_H
+#define ERRORS_H
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
-#include <CoreServices/CoreServices.h>
+#include "Types.h"
 
 using namespace std;
 
@@ -22,13 +25,27 @@ using namespace std;
 /**
  * Result codes.
  *
- * These constants hold the result codes.
+ * These constants hold the result codes. The coordinate codes are also the per point
+ * <i>Code</i> of the <i>Status</i> elements, in batches and in server responses; points
+ * in the sea are a warning, the command still succeeds.
  */
 const int kERROR_OK									= 0;
 const int kERROR_INVALID_ARGUMENTS_COUNT			= 1;
+const int kERROR_INVALID_OPTION						= 2;
+const int kERROR_INVALID_BATCH						= 4;
 const int kERROR_INVALID_LATITUDE_FORMAT			= 10;
 const int kERROR_INVALID_LATITUDE_RANGE				= 12;
 const int kERROR_INVALID_LONGITUDE_FORMAT			= 18;
 const int kERROR_INVALID_LONGITUDE_RANGE			= 20;
+const int kERROR_INVALID_AREA						= 24;
 const int kERROR_COORDINATES_OUT_OF_MAP				= 32;
+const int kERROR_COORDINATES_IN_SEA					= 33;
 const int kERROR_INVALID_FEATURE_REFERENCE			= 64;
+const int kERROR_INVALID_SCENARIO_REFERENCE		= 66;
+const int kERROR_INVALID_MANIFEST				= 128;
+const int kERROR_REPACK_FAILED						= 129;
+const int kERROR_SERVER_FAILED						= 130;
+const int kERROR_GENERATE_FAILED					= 131;
+const int kERROR_CONVERT_FAILED					= 132;
+
+#endif // ERRORS_H
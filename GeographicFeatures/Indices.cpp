@@ -0,0 +1,395 @@
+/**
+ * Agro-climatic indices.
+ *
+ * This file contains the agro-climatic indices engine: the indices are derived from the
+ * 36 monthly values of a cell, minimum temperature, maximum temperature and
+ * precipitation:
+ *
+ * <ul>
+ *	<li><b>gdd</b>: Growing degree days, sum over the months of the days times the
+ *		positive difference between the monthly average temperature and the base
+ *		temperature.
+ *	<li><b>pet</b>: Annual potential evapotranspiration in millimeters, computed with the
+ *		Hargreaves equation from the monthly temperatures and the extraterrestrial
+ *		radiation at the cell latitude on the middle day of the month (FAO-56).
+ *	<li><b>aridity</b>: Aridity index, annual precipitation divided by the annual
+ *		potential evapotranspiration; undefined (NaN) where the evapotranspiration is 0.
+ *	<li><b>frost</b>: Number of months with a minimum temperature below 0 degrees.
+ * </ul>
+ *
+ * The monthly average temperature is the mean of the minimum and maximum temperatures,
+ * stored temperatures are in tenths of degree.
+ *
+ * The inputs are month-major arrays: the value of month <i>m</i> for cell <i>c</i> is at
+ * <i>m * count + c</i>; the output is index-major: index <i>i</i> for cell <i>c</i> is at
+ * <i>i * count + c</i>. On SSE2 capable processors four cells are processed at once.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Indices.cpp										*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * System includes.
+ */
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Local includes.
+ */
+#include "Indices.h"										// Agro-climatic indices.
+
+/**
+ * Days per month.
+ */
+static const float kDays[ kBIOCLIM_Months ]
+	= { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+/**
+ * Middle day of year of each month.
+ */
+static const int kMiddleDay[ kBIOCLIM_Months ]
+	= { 15, 46, 74, 105, 135, 166, 196, 227, 258, 288, 319, 349 };
+
+
+/*===================================================================================
+ *	GetRadiation																	*
+ *==================================================================================*/
+
+/**
+ * Get extraterrestrial radiation.
+ *
+ * This function will compute the daily extraterrestrial radiation at the provided
+ * latitude on the middle day of each month, expressed as equivalent evaporation in
+ * millimeters per day (FAO-56 equations 21 to 25).
+ *
+ * @param double			theLatitude			Latitude in degrees.
+ * @param float *			theRadiation		Receives monthly radiation.
+ *
+ * @access private
+ * @return void
+ */
+static void GetRadiation( double theLatitude, float * theRadiation )
+{
+	double phi = theLatitude * M_PI / 180.0;
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		//
+		// Get relative distance and solar declination.
+		//
+		double day = 2.0 * M_PI * kMiddleDay[ month ] / 365.0;
+		double dr = 1.0 + (0.033 * cos( day ));
+		double delta = 0.409 * sin( day - 1.39 );
+
+		//
+		// Get sunset hour angle.
+		// Polar days and nights are clamped.
+		//
+		double ws = -tan( phi ) * tan( delta );
+		ws = acos( (ws < -1.0) ? -1.0 : ((ws > 1.0) ? 1.0 : ws) );
+
+		//
+		// Get radiation.
+		//
+		double ra = (24.0 * 60.0 / M_PI) * 0.0820 * dr
+				  * ((ws * sin( phi ) * sin( delta ))
+				   + (cos( phi ) * cos( delta ) * sin( ws )));
+		theRadiation[ month ] = (float) (0.408 * ra);
+
+	} // Iterating months.
+
+} // GetRadiation.
+
+
+/*===================================================================================
+ *	ComputeCell																		*
+ *==================================================================================*/
+
+/**
+ * Compute cell indices.
+ *
+ * This function will compute the evapotranspiration, aridity and frost months of a
+ * single cell.
+ *
+ * @param const SInt16 *	theMin				Monthly minimum temperatures.
+ * @param const SInt16 *	theMax				Monthly maximum temperatures.
+ * @param const SInt16 *	thePrec				Monthly precipitation.
+ * @param const double *	theLatitude			Cell latitudes.
+ * @param size_t			theCount			Number of cells.
+ * @param size_t			theCell				Cell index.
+ * @param float *			theOutput			Receives indices.
+ *
+ * @access private
+ * @return void
+ */
+static void ComputeCell( const SInt16 * theMin, const SInt16 * theMax,
+						 const SInt16 * thePrec, const double * theLatitude,
+						 size_t theCount, size_t theCell, float * theOutput )
+{
+	//
+	// Init local storage.
+	//
+	float radiation [ kBIOCLIM_Months ];
+	float pet = 0, psum = 0, frost = 0;
+	GetRadiation( theLatitude[ theCell ], radiation );
+
+	//
+	// Iterate months.
+	//
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		size_t index = (month * theCount) + theCell;
+		float low = theMin[ index ] * kINDEX_TemperatureScale;
+		float high = theMax[ index ] * kINDEX_TemperatureScale;
+		float mean = (low + high) * 0.5f;
+		float range = high - low;
+
+		pet += 0.0023f * radiation[ month ]
+			 * ((mean + 17.8f > 0) ? (mean + 17.8f) : 0)
+			 * sqrtf( (range > 0) ? range : 0 )
+			 * kDays[ month ];
+		psum += thePrec[ index ];
+		if( low < 0 )
+			frost += 1;
+	}
+
+	//
+	// Set indices.
+	//
+	theOutput[ (kINDEX_PET * theCount) + theCell ] = pet;
+	theOutput[ (kINDEX_ARIDITY * theCount) + theCell ] = ( pet > 0 ) ? (psum / pet) : NAN;
+	theOutput[ (kINDEX_FROST * theCount) + theCell ] = frost;
+
+} // ComputeCell.
+
+
+#ifdef __SSE2__
+
+/*===================================================================================
+ *	Load4																			*
+ *==================================================================================*/
+
+/**
+ * Load four values.
+ *
+ * This function will load four consecutive 16 bit integers as floats.
+ *
+ * @param const SInt16 *	theValues			Values.
+ *
+ * @access private
+ * @return __m128
+ */
+static inline __m128 Load4( const SInt16 * theValues )
+{
+	__m128i value = _mm_loadl_epi64( (const __m128i *) theValues );
+	value = _mm_srai_epi32( _mm_unpacklo_epi16( value, value ), 16 );
+
+	return _mm_cvtepi32_ps( value );											// ==>
+
+} // Load4.
+
+
+/*===================================================================================
+ *	ComputeCells4																	*
+ *==================================================================================*/
+
+/**
+ * Compute indices of four cells.
+ *
+ * This function is the SSE2 version of {@link ComputeCell() ComputeCell}, it processes
+ * the four cells starting at the provided cell; the radiation is computed per cell.
+ *
+ * @param const SInt16 *	theMin				Monthly minimum temperatures.
+ * @param const SInt16 *	theMax				Monthly maximum temperatures.
+ * @param const SInt16 *	thePrec				Monthly precipitation.
+ * @param const double *	theLatitude			Cell latitudes.
+ * @param size_t			theCount			Number of cells.
+ * @param size_t			theCell				First cell index.
+ * @param float *			theOutput			Receives indices.
+ *
+ * @access private
+ * @return void
+ */
+static void ComputeCells4( const SInt16 * theMin, const SInt16 * theMax,
+						   const SInt16 * thePrec, const double * theLatitude,
+						   size_t theCount, size_t theCell, float * theOutput )
+{
+	//
+	// Get radiation.
+	//
+	float radiation [ 4 ][ kBIOCLIM_Months ];
+	for( int cell = 0; cell < 4; cell++ )
+		GetRadiation( theLatitude[ theCell + cell ], radiation[ cell ] );
+
+	//
+	// Init local storage.
+	//
+	__m128 scale = _mm_set1_ps( kINDEX_TemperatureScale );
+	__m128 half = _mm_set1_ps( 0.5f );
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps( 1.0f );
+	__m128 offset = _mm_set1_ps( 17.8f );
+	__m128 factor = _mm_set1_ps( 0.0023f );
+	__m128 pet = zero, psum = zero, frost = zero;
+
+	//
+	// Iterate months.
+	//
+	for( int month = 0; month < kBIOCLIM_Months; month++ )
+	{
+		size_t index = (month * theCount) + theCell;
+		__m128 low = _mm_mul_ps( Load4( theMin + index ), scale );
+		__m128 high = _mm_mul_ps( Load4( theMax + index ), scale );
+		__m128 mean = _mm_mul_ps( _mm_add_ps( low, high ), half );
+		__m128 range = _mm_max_ps( _mm_sub_ps( high, low ), zero );
+		__m128 ra = _mm_set_ps( radiation[ 3 ][ month ], radiation[ 2 ][ month ],
+								radiation[ 1 ][ month ], radiation[ 0 ][ month ] );
+
+		__m128 value = _mm_mul_ps( factor, ra );
+		value = _mm_mul_ps( value, _mm_max_ps( _mm_add_ps( mean, offset ), zero ) );
+		value = _mm_mul_ps( value, _mm_sqrt_ps( range ) );
+		value = _mm_mul_ps( value, _mm_set1_ps( kDays[ month ] ) );
+		pet = _mm_add_ps( pet, value );
+
+		psum = _mm_add_ps( psum, Load4( thePrec + index ) );
+		frost = _mm_add_ps( frost, _mm_and_ps( _mm_cmplt_ps( low, zero ), one ) );
+	}
+
+	//
+	// Set indices.
+	// Aridity is undefined where there is no evapotranspiration.
+	//
+	__m128 valid = _mm_cmpgt_ps( pet, zero );
+	__m128 aridity = _mm_div_ps( psum, _mm_or_ps( _mm_and_ps( valid, pet ),
+												  _mm_andnot_ps( valid, one ) ) );
+	aridity = _mm_or_ps( _mm_and_ps( valid, aridity ),
+						 _mm_andnot_ps( valid, _mm_set1_ps( NAN ) ) );
+
+	_mm_storeu_ps( theOutput + (kINDEX_PET * theCount) + theCell, pet );
+	_mm_storeu_ps( theOutput + (kINDEX_ARIDITY * theCount) + theCell, aridity );
+	_mm_storeu_ps( theOutput + (kINDEX_FROST * theCount) + theCell, frost );
+
+} // ComputeCells4.
+
+#endif // __SSE2__
+
+
+/*===================================================================================
+ *	ComputeIndices																	*
+ *==================================================================================*/
+
+/**
+ * Compute indices.
+ *
+ * This function will compute the evapotranspiration, aridity and frost months of the
+ * provided cells, see the file header for the layout of the inputs and output.
+ *
+ * @param const SInt16 *	theMin				Monthly minimum temperatures.
+ * @param const SInt16 *	theMax				Monthly maximum temperatures.
+ * @param const SInt16 *	thePrec				Monthly precipitation.
+ * @param const double *	theLatitude			Cell latitudes.
+ * @param size_t			theCount			Number of cells.
+ * @param float *			theOutput			Receives indices.
+ *
+ * @access public
+ * @return void
+ */
+void ComputeIndices( const SInt16 * theMin, const SInt16 * theMax, const SInt16 * thePrec,
+					 const double * theLatitude, size_t theCount, float * theOutput )
+{
+	size_t cell = 0;
+
+#ifdef __SSE2__
+	//
+	// Compute blocks of four cells.
+	//
+	for( ; (cell + 4) <= theCount; cell += 4 )
+		ComputeCells4( theMin, theMax, thePrec, theLatitude, theCount, cell, theOutput );
+#endif
+
+	//
+	// Compute remaining cells.
+	//
+	for( ; cell < theCount; cell++ )
+		ComputeCell( theMin, theMax, thePrec, theLatitude, theCount, cell, theOutput );
+
+} // ComputeIndices.
+
+
+/*===================================================================================
+ *	ComputeDegreeDays																*
+ *==================================================================================*/
+
+/**
+ * Compute growing degree days.
+ *
+ * This function will compute the growing degree days of the provided cells above the
+ * provided base temperature, expressed in degrees.
+ *
+ * @param const SInt16 *	theMin				Monthly minimum temperatures.
+ * @param const SInt16 *	theMax				Monthly maximum temperatures.
+ * @param size_t			theCount			Number of cells.
+ * @param float				theBase				Base temperature in degrees.
+ * @param float *			theOutput			Receives degree days.
+ *
+ * @access public
+ * @return void
+ */
+void ComputeDegreeDays( const SInt16 * theMin, const SInt16 * theMax, size_t theCount,
+						float theBase, float * theOutput )
+{
+	size_t cell = 0;
+
+#ifdef __SSE2__
+	//
+	// Compute blocks of four cells.
+	//
+	__m128 scale = _mm_set1_ps( kINDEX_TemperatureScale * 0.5f );
+	__m128 base = _mm_set1_ps( theBase );
+	__m128 zero = _mm_setzero_ps();
+	for( ; (cell + 4) <= theCount; cell += 4 )
+	{
+		__m128 sum = zero;
+		for( int month = 0; month < kBIOCLIM_Months; month++ )
+		{
+			size_t index = (month * theCount) + cell;
+			__m128 mean = _mm_mul_ps( _mm_add_ps( Load4( theMin + index ),
+												  Load4( theMax + index ) ), scale );
+			sum = _mm_add_ps( sum,
+							  _mm_mul_ps( _mm_max_ps( _mm_sub_ps( mean, base ), zero ),
+										  _mm_set1_ps( kDays[ month ] ) ) );
+		}
+		_mm_storeu_ps( theOutput + cell, sum );
+	}
+#endif
+
+	//
+	// Compute remaining cells.
+	//
+	for( ; cell < theCount; cell++ )
+	{
+		float sum = 0;
+		for( int month = 0; month < kBIOCLIM_Months; month++ )
+		{
+			size_t index = (month * theCount) + cell;
+			float mean = (theMin[ index ] + theMax[ index ])
+					   * (kINDEX_TemperatureScale * 0.5f);
+			if( mean > theBase )
+				sum += (mean - theBase) * kDays[ month ];
+		}
+		theOutput[ cell ] = sum;
+	}
+
+} // ComputeDegreeDays.
@@ -0,0 +1,70 @@
+/**
+ * Agro-climatic indices definitions.
+ *
+ * This file contains the declarations of the agro-climatic indices engine: the engine
+ * derives growing degree days, potential evapotranspiration, aridity and frost months
+ * from the monthly minimum temperature, maximum temperature and precipitation series of
+ * a set of cells.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef INDICES_H
+#define INDICES_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Types.h"
+
+using namespace std;
+
+#include "Bioclim.h"
+
+
+/**
+ * Indices count.
+ *
+ * This constant holds the number of indices computed by ComputeIndices().
+ */
+const int kINDEX_Count = 3;
+
+/**
+ * Indices.
+ *
+ * These constants hold the position of the indices in the ComputeIndices() output.
+ */
+const int kINDEX_PET = 0;
+const int kINDEX_ARIDITY = 1;
+const int kINDEX_FROST = 2;
+
+/**
+ * Temperature scale.
+ *
+ * This constant holds the scale of the stored temperatures, WORLDCLIM stores tenths of
+ * degree.
+ */
+const float kINDEX_TemperatureScale = 0.1f;
+
+/**
+ * ComputeIndices.
+ *
+ * Compute evapotranspiration, aridity and frost months of a set of cells.
+ */
+void ComputeIndices( const SInt16 * theMin, const SInt16 * theMax, const SInt16 * thePrec,
+					 const double * theLatitude, size_t theCount, float * theOutput );
+
+/**
+ * ComputeDegreeDays.
+ *
+ * Compute growing degree days of a set of cells.
+ */
+void ComputeDegreeDays( const SInt16 * theMin, const SInt16 * theMax, size_t theCount,
+						float theBase, float * theOutput );
+
+#endif // INDICES_H
@@ -0,0 +1,702 @@
+/**
+ * Coordinate parser.
+ *
+ * This file contains the coordinate parser. Coordinates are accepted in the following
+ * forms, the whole field must be consumed:
+ *
+ * <ul>
+ *	<li><b>Decimal degrees</b>: <i>-12.5</i>, <i>+12.5</i>, <i>1.25e1</i>.
+ *	<li><b>Degrees, minutes and seconds</b>: <i>12°30'15.5"</i>, <i>12d30'</i>,
+ *		<i>12:30:15</i>; minutes and seconds may be decimal, are less than 60, and the
+ *		typographic prime and double prime marks are accepted.
+ *	<li><b>Hemisphere</b>: any of the above may be preceded or followed, instead of a
+ *		sign, by <i>N</i> or <i>S</i> for latitudes and <i>E</i> or <i>W</i> for
+ *		longitudes, in either case: <i>12.5S</i>, <i>W12°30'</i>.
+ * </ul>
+ *
+ * Numbers are converted without the C library: up to 15 significant digits with a
+ * decimal exponent up to 22 are converted exactly with a single multiplication or
+ * division, which is correctly rounded as <i>strtod</i> is, longer numbers fall back to
+ * <i>strtod</i>. The parser does not depend on the locale.
+ *
+ * Batch input is split into lines and fields with vector compares, 16 bytes at a time:
+ * each block yields a mask of its separators, from which the field bounds are read.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Parse.cpp										*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * System includes.
+ */
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/**
+ * Local includes.
+ */
+#include "Parse.h"											// Coordinate parser.
+#include "Errors.h"											// Error codes.
+
+
+/**
+ * Exact powers of ten.
+ *
+ * This table holds the powers of ten represented exactly as doubles.
+ */
+static const double kPowers [] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * Maximum number length.
+ *
+ * This constant holds the maximum number of characters of a number converted with
+ * <i>strtod</i>.
+ */
+static const size_t kMaxNumber = 64;
+
+
+/*===================================================================================
+ *	IsSeparator																		*
+ *==================================================================================*/
+
+/**
+ * Check field separator.
+ *
+ * This function will return TRUE if the provided character separates batch fields: a
+ * blank, a tab, a comma, a semicolon or a carriage return.
+ *
+ * @param char				theCharacter		Character.
+ *
+ * @access private
+ * @return bool
+ */
+static inline bool IsSeparator( char theCharacter )
+{
+	return (theCharacter == ' ')
+		|| (theCharacter == ',')
+		|| (theCharacter == '\t')
+		|| (theCharacter == ';')
+		|| (theCharacter == '\r');												// ==>
+
+} // IsSeparator.
+
+
+/*===================================================================================
+ *	FindSeparator																	*
+ *==================================================================================*/
+
+/**
+ * Find field separator.
+ *
+ * This function will return the position of the first separator or line feed between
+ * the provided bounds, or the end bound; see IsSeparator(). Blocks of 16 bytes are
+ * compared at once while they lie within the provided buffer end, which may be past the
+ * end bound.
+ *
+ * @param const char *		theBegin			Start.
+ * @param const char *		theEnd				End.
+ * @param const char *		theLimit			Buffer end.
+ *
+ * @access private
+ * @return const char *
+ */
+static const char * FindSeparator( const char * theBegin, const char * theEnd,
+								   const char * theLimit )
+{
+	const char * position = theBegin;
+
+#if defined( __SSE2__ )
+	const __m128i blank = _mm_set1_epi8( ' ' );
+	const __m128i comma = _mm_set1_epi8( ',' );
+	const __m128i tab = _mm_set1_epi8( '\t' );
+	const __m128i semicolon = _mm_set1_epi8( ';' );
+	const __m128i carriage = _mm_set1_epi8( '\r' );
+	const __m128i feed = _mm_set1_epi8( '\n' );
+	while( ((position + 16) <= theLimit)
+		&& (position < theEnd) )
+	{
+		__m128i block = _mm_loadu_si128( (const __m128i *) position );
+		__m128i found = _mm_or_si128(
+			_mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( block, blank ),
+										_mm_cmpeq_epi8( block, comma ) ),
+						  _mm_or_si128( _mm_cmpeq_epi8( block, tab ),
+										_mm_cmpeq_epi8( block, semicolon ) ) ),
+			_mm_or_si128( _mm_cmpeq_epi8( block, carriage ),
+						  _mm_cmpeq_epi8( block, feed ) ) );
+		int mask = _mm_movemask_epi8( found );
+		if( mask )
+		{
+			position += __builtin_ctz( mask );
+			return ( position < theEnd ) ? position : theEnd;					// ==>
+		}
+		position += 16;
+	}
+	if( position >= theEnd )
+		return theEnd;															// ==>
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+	while( ((position + 16) <= theLimit)
+		&& (position < theEnd) )
+	{
+		uint8x16_t block = vld1q_u8( (const uint8_t *) position );
+		uint8x16_t found = vorrq_u8(
+			vorrq_u8( vorrq_u8( vceqq_u8( block, vdupq_n_u8( ' ' ) ),
+								vceqq_u8( block, vdupq_n_u8( ',' ) ) ),
+					  vorrq_u8( vceqq_u8( block, vdupq_n_u8( '\t' ) ),
+								vceqq_u8( block, vdupq_n_u8( ';' ) ) ) ),
+			vorrq_u8( vceqq_u8( block, vdupq_n_u8( '\r' ) ),
+					  vceqq_u8( block, vdupq_n_u8( '\n' ) ) ) );
+		uint64_t mask = vget_lane_u64( vreinterpret_u64_u8(
+			vshrn_n_u16( vreinterpretq_u16_u8( found ), 4 ) ), 0 );
+		if( mask )
+		{
+			position += __builtin_ctzll( mask ) >> 2;
+			return ( position < theEnd ) ? position : theEnd;					// ==>
+		}
+		position += 16;
+	}
+	if( position >= theEnd )
+		return theEnd;															// ==>
+#endif
+
+	while( (position < theEnd)
+		&& (! IsSeparator( *position ))
+		&& (*position != '\n') )
+		position++;
+
+	return position;															// ==>
+
+} // FindSeparator.
+
+
+/*===================================================================================
+ *	ParseNumber																		*
+ *==================================================================================*/
+
+/**
+ * Parse unsigned number.
+ *
+ * This function will parse the unsigned decimal number starting at the provided
+ * position, with an optional fraction and, if <i>doExponent</i> is set, an optional
+ * decimal exponent; the position is advanced past the number. The function returns
+ * FALSE if there are no digits.
+ *
+ * @param const char **		thePosition			Position, advanced past the number.
+ * @param const char *		theEnd				End.
+ * @param bool				doExponent			TRUE means accept an exponent.
+ * @param double *			theValue			Receives value.
+ *
+ * @access private
+ * @return bool
+ */
+static bool ParseNumber( const char ** thePosition, const char * theEnd, bool doExponent,
+						 double * theValue )
+{
+	//
+	// Parse digits.
+	// Leading zeros are not significant.
+	//
+	const char * start = *thePosition;
+	const char * position = start;
+	UInt64 mantissa = 0;
+	int significant = 0, digits = 0, scale = 0;
+	bool fraction = false;
+	for( ; position < theEnd; position++ )
+	{
+		if( (*position == '.')
+		 && (! fraction) )
+		{
+			fraction = true;
+			continue;															// =>
+		}
+		if( (*position < '0')
+		 || (*position > '9') )
+			break;																// =>
+
+		digits++;
+		if( mantissa
+		 || (*position != '0') )
+		{
+			if( significant < 19 )
+				mantissa = (mantissa * 10) + (*position - '0');
+			else if( ! fraction )
+				scale++;
+			significant++;
+		}
+		if( fraction
+		 && (significant <= 19) )
+			scale--;
+	}
+	if( ! digits )
+		return false;															// ==>
+
+	//
+	// Parse exponent.
+	// A letter not followed by digits is left to the caller, as a hemisphere.
+	//
+	int exponent = 0;
+	if( doExponent
+	 && (position < theEnd)
+	 && ((*position == 'e') || (*position == 'E')) )
+	{
+		const char * mark = position + 1;
+		bool negative = false;
+		if( (mark < theEnd)
+		 && ((*mark == '+') || (*mark == '-')) )
+			negative = (*mark++ == '-');
+		if( (mark < theEnd)
+		 && (*mark >= '0')
+		 && (*mark <= '9') )
+		{
+			for( ; (mark < theEnd) && (*mark >= '0') && (*mark <= '9'); mark++ )
+				exponent = ( exponent < 10000 ) ? ((exponent * 10) + (*mark - '0'))
+												: exponent;
+			exponent = ( negative ) ? -exponent : exponent;
+			position = mark;
+		}
+	}
+	*thePosition = position;
+
+	//
+	// Convert exactly.
+	//
+	scale += exponent;
+	if( (significant <= 15)
+	 && (scale >= -22)
+	 && (scale <= 22) )
+	{
+		*theValue = ( scale < 0 ) ? ((double) mantissa / kPowers[ -scale ])
+								  : ((double) mantissa * kPowers[ scale ]);
+		return true;															// ==>
+	}
+
+	//
+	// Convert with the library.
+	//
+	char buffer [ kMaxNumber + 1 ];
+	size_t length = position - start;
+	if( length > kMaxNumber )
+		return false;															// ==>
+	memcpy( buffer, start, length );
+	buffer[ length ] = '\0';
+	*theValue = strtod( buffer, NULL );
+
+	return true;																// ==>
+
+} // ParseNumber.
+
+
+/*===================================================================================
+ *	ParseMark																		*
+ *==================================================================================*/
+
+/**
+ * Parse unit mark.
+ *
+ * This function will skip the provided unit mark at the provided position: the
+ * <i>theUnit</i> 0 matches the degree sign, <i>d</i> or a colon, 1 matches the
+ * apostrophe, the prime or a colon, 2 matches the quote, the double prime or two
+ * apostrophes. The function returns FALSE if the mark is not there.
+ *
+ * @param const char **		thePosition			Position, advanced past the mark.
+ * @param const char *		theEnd				End.
+ * @param int				theUnit				Unit: 0 degrees, 1 minutes, 2 seconds.
+ *
+ * @access private
+ * @return bool
+ */
+static bool ParseMark( const char ** thePosition, const char * theEnd, int theUnit )
+{
+	static const char * const kMarks [ 3 ][ 4 ] =
+	{
+		{ "\xC2\xB0", "d", ":", NULL },
+		{ "\xE2\x80\xB2", "'", ":", NULL },
+		{ "\xE2\x80\xB3", "''", "\"", NULL }
+	};
+
+	for( int mark = 0; kMarks[ theUnit ][ mark ] != NULL; mark++ )
+	{
+		size_t length = strlen( kMarks[ theUnit ][ mark ] );
+		if( ((size_t) (theEnd - *thePosition) >= length)
+		 && (! memcmp( *thePosition, kMarks[ theUnit ][ mark ], length )) )
+		{
+			*thePosition += length;
+			return true;														// ==>
+		}
+	}
+
+	return false;																// ==>
+
+} // ParseMark.
+
+
+/*===================================================================================
+ *	GetHemisphere																	*
+ *==================================================================================*/
+
+/**
+ * Get hemisphere sign.
+ *
+ * This function will return 1 or -1 if the provided character is a hemisphere letter of
+ * the provided coordinate kind, <i>N</i> and <i>S</i> for latitudes, <i>E</i> and
+ * <i>W</i> for longitudes, or 0.
+ *
+ * @param char				theCharacter		Character.
+ * @param int				theKind				Coordinate kind.
+ *
+ * @access private
+ * @return int
+ */
+static int GetHemisphere( char theCharacter, int theKind )
+{
+	switch( theCharacter )
+	{
+		case 'N': case 'n':
+			return ( theKind == kCOORD_LATITUDE ) ? 1 : 0;						// ==>
+		case 'S': case 's':
+			return ( theKind == kCOORD_LATITUDE ) ? -1 : 0;						// ==>
+		case 'E': case 'e':
+			return ( theKind == kCOORD_LONGITUDE ) ? 1 : 0;						// ==>
+		case 'W': case 'w':
+			return ( theKind == kCOORD_LONGITUDE ) ? -1 : 0;					// ==>
+	}
+
+	return 0;																	// ==>
+
+} // GetHemisphere.
+
+
+/*===================================================================================
+ *	ParseCoordinate																	*
+ *==================================================================================*/
+
+/**
+ * Parse coordinate.
+ *
+ * This function will parse the latitude or longitude between the provided bounds and
+ * check its range; the whole field must be a coordinate, see the forms above. The
+ * function returns one of the <i>kPARSE_</i> constants, on error the provided position
+ * receives the offending character, or the start of the field for range errors.
+ *
+ * @param const char *		theBegin			Field start.
+ * @param const char *		theEnd				Field end.
+ * @param int				theKind				Coordinate kind, kCOORD_LATITUDE or
+ *												kCOORD_LONGITUDE.
+ * @param double *			theValue			Receives value.
+ * @param const char **		thePosition			Receives error position.
+ *
+ * @access public
+ * @return int
+ */
+int ParseCoordinate( const char * theBegin, const char * theEnd, int theKind,
+					 double * theValue, const char ** thePosition )
+{
+	//
+	// Handle empty field.
+	//
+	const char * position = theBegin;
+	*thePosition = theBegin;
+	if( position >= theEnd )
+		return kPARSE_EMPTY;													// ==>
+
+	//
+	// Parse sign or leading hemisphere.
+	//
+	int sign = GetHemisphere( *position, theKind );
+	bool hemisphere = (sign != 0);
+	if( hemisphere )
+		position++;
+	else if( (*position == '-')
+		  || (*position == '+') )
+		sign = ( *position++ == '-' ) ? -1 : 1;
+
+	//
+	// Parse degrees.
+	// Exponents are only accepted in decimal degrees.
+	//
+	double degrees, minutes = 0, seconds = 0;
+	const char * start = position;
+	if( ! ParseNumber( &position, theEnd, true, &degrees ) )
+	{
+		*thePosition = position;
+		return kPARSE_SYNTAX;													// ==>
+	}
+
+	//
+	// Parse minutes and seconds.
+	//
+	if( ParseMark( &position, theEnd, 0 ) )
+	{
+		for( const char * digit = start; digit < position; digit++ )
+		{
+			if( (*digit == 'e') || (*digit == 'E') )
+			{
+				*thePosition = digit;
+				return kPARSE_SYNTAX;											// ==>
+			}
+		}
+
+		start = position;
+		if( ParseNumber( &position, theEnd, false, &minutes ) )
+		{
+			if( (minutes >= 60)
+			 || ((! ParseMark( &position, theEnd, 1 ))
+			  && (position < theEnd)
+			  && (! GetHemisphere( *position, theKind ))) )
+			{
+				*thePosition = ( minutes >= 60 ) ? start : position;
+				return kPARSE_SYNTAX;											// ==>
+			}
+
+			start = position;
+			if( ParseNumber( &position, theEnd, false, &seconds ) )
+			{
+				if( (seconds >= 60)
+				 || ((! ParseMark( &position, theEnd, 2 ))
+				  && (position < theEnd)
+				  && (! GetHemisphere( *position, theKind ))) )
+				{
+					*thePosition = ( seconds >= 60 ) ? start : position;
+					return kPARSE_SYNTAX;										// ==>
+				}
+			}
+		}
+	}
+
+	//
+	// Parse trailing hemisphere.
+	//
+	if( (position < theEnd)
+	 && (! sign)
+	 && GetHemisphere( *position, theKind ) )
+		sign = GetHemisphere( *position++, theKind );
+	if( position < theEnd )
+	{
+		*thePosition = position;
+		return kPARSE_SYNTAX;													// ==>
+	}
+
+	//
+	// Check range.
+	//
+	*theValue = (degrees + (minutes / 60) + (seconds / 3600)) * (( sign < 0 ) ? -1 : 1);
+	if( (theKind == kCOORD_LATITUDE)
+	  ? ((*theValue > 90) || (*theValue <= -90))
+	  : ((*theValue >= 180) || (*theValue < -180)) )
+		return kPARSE_RANGE;													// ==>
+
+	return kPARSE_OK;															// ==>
+
+} // ParseCoordinate.
+
+
+/*===================================================================================
+ *	ParseBatch																		*
+ *==================================================================================*/
+
+/**
+ * Parse batch coordinates.
+ *
+ * This function will parse the provided buffer of coordinates, each line holds a
+ * latitude and a longitude separated by blanks, tabs, commas or semicolons; blank lines
+ * and lines starting with <i>#</i> are skipped. The coordinates are appended to the
+ * provided lists.
+ *
+ * Invalid lines do not stop the parsing: they are appended as points with zero
+ * coordinates, so that points match the input lines, and their status, field, line,
+ * column and point index are appended to the provided errors list. The function returns
+ * the status of the first error, or <i>kPARSE_OK</i>.
+ *
+ * @param const char *		theData				Buffer.
+ * @param size_t			theSize				Buffer size.
+ * @param vector<double> *	theLatitudes		Receives latitudes.
+ * @param vector<double> *	theLongitudes		Receives longitudes.
+ * @param vector<PARSE_T> *	theErrors			Receives errors.
+ *
+ * @access public
+ * @return int
+ */
+int ParseBatch( const char * theData, size_t theSize, vector<double> * theLatitudes,
+				vector<double> * theLongitudes, vector<PARSE_T> * theErrors )
+{
+	const char * end = theData + theSize;
+	size_t errors = theErrors->size();
+	size_t count = 0;
+	for( const char * line = theData; line < end; )
+	{
+		//
+		// Find line.
+		//
+		const char * feed = (const char *) memchr( line, '\n', end - line );
+		const char * last = ( feed != NULL ) ? feed : end;
+		count++;
+
+		//
+		// Split fields.
+		// Runs of separators count as one.
+		//
+		const char * fields [ 3 ][ 2 ];
+		int found = 0;
+		for( const char * position = line; position < last; )
+		{
+			while( (position < last)
+				&& IsSeparator( *position ) )
+				position++;
+			if( position >= last )
+				break;															// =>
+
+			const char * stop = FindSeparator( position, last, end );
+			if( found < 3 )
+			{
+				fields[ found ][ 0 ] = position;
+				fields[ found ][ 1 ] = stop;
+			}
+			found++;
+			position = stop;
+		}
+
+		//
+		// Parse coordinates.
+		// Comment lines are skipped.
+		//
+		if( found
+		 && (*fields[ 0 ][ 0 ] != '#') )
+		{
+			PARSE_T error;
+			double latitude = 0, longitude = 0;
+			const char * position = last;
+			error.field = 0;
+			if( found > 2 )
+			{
+				position = fields[ 2 ][ 0 ];
+				error.status = kPARSE_FIELDS;
+				error.field = 3;
+			}
+			else if( (error.status = ParseCoordinate( fields[ 0 ][ 0 ], fields[ 0 ][ 1 ],
+													  kCOORD_LATITUDE, &latitude,
+													  &position )) )
+				error.field = 1;
+			else if( found < 2 )
+			{
+				position = last;
+				error.status = kPARSE_EMPTY;
+				error.field = 2;
+			}
+			else if( (error.status = ParseCoordinate( fields[ 1 ][ 0 ], fields[ 1 ][ 1 ],
+													  kCOORD_LONGITUDE, &longitude,
+													  &position )) )
+				error.field = 2;
+
+			//
+			// Record error.
+			//
+			if( error.status )
+			{
+				error.line = count;
+				error.column = (position - line) + 1;
+				error.point = theLatitudes->size();
+				theErrors->push_back( error );
+				latitude = longitude = 0;
+			}
+
+			theLatitudes->push_back( latitude );
+			theLongitudes->push_back( longitude );
+		}
+
+		line = last + 1;
+
+	} // Iterating lines.
+
+	if( theErrors->size() > errors )
+		return (*theErrors)[ errors ].status;									// ==>
+
+	return kPARSE_OK;															// ==>
+
+} // ParseBatch.
+
+
+/*===================================================================================
+ *	GetParseError																	*
+ *==================================================================================*/
+
+/**
+ * Get parse error.
+ *
+ * This function will return the description of the provided parse status.
+ *
+ * @param int				theStatus			Parse status.
+ *
+ * @access public
+ * @return const char *
+ */
+const char * GetParseError( int theStatus )
+{
+	switch( theStatus )
+	{
+		case kPARSE_OK:
+			return "valid";														// ==>
+		case kPARSE_EMPTY:
+			return "missing";													// ==>
+		case kPARSE_SYNTAX:
+			return "invalid character";											// ==>
+		case kPARSE_RANGE:
+			return "out of range";												// ==>
+		case kPARSE_FIELDS:
+			return "unexpected field";											// ==>
+	}
+
+	return "invalid";															// ==>
+
+} // GetParseError.
+
+
+/*===================================================================================
+ *	GetParseCode																	*
+ *==================================================================================*/
+
+/**
+ * Get parse error code.
+ *
+ * This function will return the result code reported for the provided batch error:
+ * latitude and longitude errors get the format or range code of the coordinate, as on
+ * the command line, other errors the invalid batch code.
+ *
+ * @param const PARSE_T &	theError			Batch error.
+ *
+ * @access public
+ * @return int
+ */
+int GetParseCode( const PARSE_T & theError )
+{
+	if( theError.field == 1 )
+		return ( theError.status == kPARSE_RANGE )
+			 ? kERROR_INVALID_LATITUDE_RANGE
+			 : kERROR_INVALID_LATITUDE_FORMAT;									// ==>
+
+	if( theError.field == 2 )
+		return ( theError.status == kPARSE_RANGE )
+			 ? kERROR_INVALID_LONGITUDE_RANGE
+			 : kERROR_INVALID_LONGITUDE_FORMAT;									// ==>
+
+	return kERROR_INVALID_BATCH;												// ==>
+
+} // GetParseCode.
@@ -0,0 +1,86 @@
+/**
+ * Coordinate parser definitions.
+ *
+ * This file contains the declarations of the coordinate parser: latitudes and longitudes
+ * are parsed from decimal degrees or degrees, minutes and seconds, with the command
+ * line, server and batch inputs sharing the same strict rules.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef PARSE_H
+#define PARSE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Types.h"
+
+using namespace std;
+
+#include "Structures.h"
+
+
+/**
+ * Coordinate kinds.
+ *
+ * These constants hold the kinds of coordinate parsed by ParseCoordinate().
+ */
+const int kCOORD_LATITUDE = 0;
+const int kCOORD_LONGITUDE = 1;
+
+/**
+ * Parse status.
+ *
+ * These constants hold the outcome of parsing coordinates:
+ *
+ * <ul>
+ *	<li><i>kPARSE_OK</i>: The coordinates are valid.
+ *	<li><i>kPARSE_EMPTY</i>: A coordinate is missing.
+ *	<li><i>kPARSE_SYNTAX</i>: A coordinate holds an unexpected character.
+ *	<li><i>kPARSE_RANGE</i>: A coordinate is out of range, latitudes are greater than
+ *		-90 and up to 90, longitudes from -180 and less than 180.
+ *	<li><i>kPARSE_FIELDS</i>: A batch line holds more than two fields.
+ * </ul>
+ */
+const int kPARSE_OK = 0;
+const int kPARSE_EMPTY = 1;
+const int kPARSE_SYNTAX = 2;
+const int kPARSE_RANGE = 3;
+const int kPARSE_FIELDS = 4;
+
+/**
+ * ParseCoordinate.
+ *
+ * Parse a latitude or a longitude.
+ */
+int ParseCoordinate( const char * theBegin, const char * theEnd, int theKind,
+					 double * theValue, const char ** thePosition );
+
+/**
+ * ParseBatch.
+ *
+ * Parse batch coordinates.
+ */
+int ParseBatch( const char * theData, size_t theSize, vector<double> * theLatitudes,
+				vector<double> * theLongitudes, vector<PARSE_T> * theErrors );
+
+/**
+ * GetParseError.
+ *
+ * Get the description of a parse status.
+ */
+const char * GetParseError( int theStatus );
+
+/**
+ * GetParseCode.
+ *
+ * Get the result code of a batch error.
+ */
+int GetParseCode( const PARSE_T & theError );
+
+#endif // PARSE_H
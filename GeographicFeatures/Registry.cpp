@@ -0,0 +1,3271 @@
+/**
+ * Dataset registry.
+ *
+ * This file contains the dataset registry: the registry is loaded once at startup into a
+ * flat array of band descriptors holding the precomputed grid geometry and the mapped
+ * file contents, so that queries no longer need to build paths or open files.
+ *
+ * The manifest is an INI file structured as follows:
+ *
+ * <ul>
+ *	<li><i>[sources]</i>: GTOPO-30 data sources, each entry is the source code followed
+ *		by the source name, as in <code>9 = SRTM data</code>.
+ *	<li><i>[tile NAME]</i>: GTOPO-30 tile, the section holds the following keys:
+ *	 <ul>
+ *		<li><b>extent</b>: Minimum and maximum latitude, minimum and maximum longitude.
+ *		<li><b>grid</b>: Number of rows and columns, defaults to the extent at 30 seconds.
+ *		<li><b>dem</b>: Elevation file path, defaults to <i>GTOPO30/NAME/NAME.DEM</i>.
+ *		<li><b>src</b>: Source map file path, defaults to <i>GTOPO30/NAME/NAME.SRC</i>.
+ *	 </ul>
+ *	<li><i>[layer NAME]</i>: WORLDCLIM layer, the section holds the following keys:
+ *	 <ul>
+ *		<li><b>source</b>: Data source description.
+ *		<li><b>months</b>: Number of months, 0 means the layer has no monthly series.
+ *		<li><b>extent</b>: Minimum and maximum latitude, minimum and maximum longitude.
+ *		<li><b>grid</b>: Number of rows and columns, defaults to the extent at 30 seconds.
+ *		<li><b>type</b>: Sample type, <i>int16</i> (default) or <i>uint8</i>.
+ *		<li><b>scale</b>: Scale factor applied to the values, defaults to 1.
+ *		<li><b>layout</b>: Monthly series storage, <i>bsq</i> (default) means a file per
+ *			month, <i>bip</i> means a single band interleaved by pixel cube holding the
+ *			months of each cell adjacent, see RepackLayer().
+ *		<li><b>path</b>: File path, monthly <i>bsq</i> layers must hold a <i>%d</i>
+ *			placeholder for the month number; defaults to
+ *			<i>WORLDCLIM30/NAME/NAME[_%d].bil</i>, or <i>WORLDCLIM30/NAME/NAME.bip</i> for
+ *			<i>bip</i> layers.
+ *		<li><b>derived</b>: Derived layer kind, derived layers are not read from files, but
+ *			computed from the monthly <i>tmin</i>, <i>tmax</i> and <i>prec</i> layers, the
+ *			file and geometry keys are ignored:
+ *		 <ul>
+ *			<li><i>bioclim</i>: Bioclimatic variable, the layer name must be <i>bio1</i> to
+ *				<i>bio19</i>.
+ *			<li><i>gdd</i>: Growing degree days above the <b>base</b> temperature in
+ *				degrees, which defaults to 10.
+ *			<li><i>pet</i>: Annual potential evapotranspiration (Hargreaves).
+ *			<li><i>aridity</i>: Aridity index.
+ *			<li><i>frost</i>: Number of frost months.
+ *		 </ul>
+ *	 </ul>
+ *	<li><i>[scenario NAME]</i>: Climate scenario, a scenario shares the grid and the layers
+ *		of the base dataset, but its files are located in a different directory:
+ *	 <ul>
+ *		<li><b>source</b>: Data source description.
+ *		<li><b>directory</b>: Scenario directory, the layer paths are resolved against it.
+ *		<li><b>layers</b>: Blank separated list of the provided layers, defaults to all.
+ *	 </ul>
+ * </ul>
+ *
+ * Relative paths are resolved against the base directory; lines starting with <i>;</i>
+ * or <i>#</i> are comments. If the manifest does not define sources, tiles or layers, the
+ * built-in tables are used for the missing part.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Registry.cpp									*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * System includes.
+ */
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+#if defined( __ARM_NEON ) && defined( __aarch64__ )
+#include <arm_neon.h>
+#endif
+
+/**
+ * Local includes.
+ */
+#include "Errors.h"											// Error codes.
+#include "Constants.h"										// Constants.
+#include "Registry.h"										// Registry.
+#include "Bioclim.h"										// Bioclimatic variables.
+#include "Uring.h"											// Asynchronous reads.
+#include "Stats.h"											// Statistics.
+#include "Decode.h"											// Decoding.
+
+
+/**
+ * Maximum read run.
+ *
+ * This constant holds the maximum number of adjacent points read at once by ReadBands().
+ */
+static const size_t kMaxRun = 16;
+
+/**
+ * Maximum read span.
+ *
+ * This constant holds the size in bytes of the file span read at once by ReadBandSpans()
+ * to serve the reads of an unmapped band falling within it.
+ */
+static const UInt64 kMaxSpan = 4096;
+
+/**
+ * Cell block.
+ *
+ * This constant holds the number of points whose rows and columns are computed at once
+ * by GetCellOffsets().
+ */
+static const size_t kCellBlock = 256;
+
+/**
+ * Prewarm window.
+ *
+ * This constant holds the size of the file window, containing a data point, that is
+ * loaded by PrewarmBands(); it is a multiple of the page size.
+ */
+static const UInt64 kPrewarmSize = 65536;
+
+/**
+ * Huge page size.
+ *
+ * This constant holds the size of a transparent huge page, the mapped files are aligned
+ * to it when huge pages are requested, see MapBand().
+ */
+static const UInt64 kHugePageSize = 2 << 20;
+
+/**
+ * Conversion block.
+ *
+ * This constant holds the number of bytes converted at once by ConvertDataset().
+ */
+static const size_t kConvertSize = 1 << 20;
+
+#ifdef __linux__
+/**
+ * I/O priority.
+ *
+ * These constants hold the <i>ioprio_set</i> arguments used by PrewarmBands() to issue
+ * its reads in the idle I/O class, which the headers do not export.
+ */
+static const int kIOPRIO_WhoProcess = 1;
+static const int kIOPRIO_ClassIdle = 3;
+static const int kIOPRIO_ClassShift = 13;
+#endif
+
+
+/*===================================================================================
+ *	SetGrid																			*
+ *==================================================================================*/
+
+/**
+ * Set grid geometry.
+ *
+ * This function will fill the provided grid with the provided bounds and counts and
+ * precompute the cell size and the number of points per degree; if the counts are zero,
+ * they will be computed from the bounds at the default resolution.
+ *
+ * @param GRID_T *			theGrid				Receives grid.
+ * @param const AREA_T &	theArea				Grid bounds.
+ * @param UInt64			theCountY			Number of rows.
+ * @param UInt64			theCountX			Number of columns.
+ *
+ * @access private
+ * @return void
+ */
+static void SetGrid( GRID_T * theGrid, const AREA_T & theArea,
+					 UInt64 theCountY, UInt64 theCountX )
+{
+	//
+	// Set bounds.
+	//
+	theGrid->area = theArea;
+
+	//
+	// Set counts.
+	//
+	theGrid->countY = ( theCountY )
+					? theCountY
+					: (UInt64) ((theArea.latMax - theArea.latMin) * kPointsLatDegree);
+	theGrid->countX = ( theCountX )
+					? theCountX
+					: (UInt64) ((theArea.lonMax - theArea.lonMin) * kPointsLonDegree);
+
+	//
+	// Set units.
+	//
+	theGrid->unitY = (theArea.latMax - theArea.latMin) / theGrid->countY;
+	theGrid->unitX = (theArea.lonMax - theArea.lonMin) / theGrid->countX;
+
+	//
+	// Set resolution.
+	//
+	theGrid->pointsY = theGrid->countY / (theArea.latMax - theArea.latMin);
+	theGrid->pointsX = theGrid->countX / (theArea.lonMax - theArea.lonMin);
+
+} // SetGrid.
+
+
+/*===================================================================================
+ *	SameGrid																		*
+ *==================================================================================*/
+
+/**
+ * Compare grids.
+ *
+ * This function will return TRUE if the provided grids have the same bounds and counts,
+ * so that a row and column offset of one addresses the same cell in the other.
+ *
+ * @param const GRID_T &	theGrid				Grid.
+ * @param const GRID_T &	theOther			Other grid.
+ *
+ * @access public
+ * @return bool
+ */
+bool SameGrid( const GRID_T & theGrid, const GRID_T & theOther )
+{
+	return (theGrid.countY == theOther.countY)
+		&& (theGrid.countX == theOther.countX)
+		&& (theGrid.area.latMin == theOther.area.latMin)
+		&& (theGrid.area.latMax == theOther.area.latMax)
+		&& (theGrid.area.lonMin == theOther.area.lonMin)
+		&& (theGrid.area.lonMax == theOther.area.lonMax);						// ==>
+
+} // SameGrid.
+
+
+/*===================================================================================
+ *	AddBand																			*
+ *==================================================================================*/
+
+/**
+ * Add band.
+ *
+ * This function will append a band to the dataset and return its index; the file is not
+ * opened here. GTOPO-30 elevations are stored big-endian, other bands are taken to be in
+ * the host byte order until their header is read, see ReadBandHeader().
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param const string &	thePath				File path.
+ * @param int				theLayer			Layer index.
+ * @param int				theMonth			Month.
+ * @param int				theType				Sample type.
+ * @param const GRID_T &	theGrid				Band grid.
+ *
+ * @access private
+ * @return int
+ */
+static int AddBand( DATASET_T * theDataset, const string & thePath,
+					int theLayer, int theMonth, int theType, const GRID_T & theGrid )
+{
+	//
+	// Init band.
+	//
+	BAND_T band;
+	band.path = ( thePath.size() && (thePath[ 0 ] == '/') )
+			  ? thePath
+			  : theDataset->directory + thePath;
+	band.layer = theLayer;
+	band.month = theMonth;
+	band.months = 1;
+	band.type = theType;
+	band.swapped = (theLayer < 0) && (theType == kTYPE_SINT16) && (! kHOST_BigEndian);
+	band.pointSize = ( theType == kTYPE_UINT8 ) ? 1 : 2;
+	band.stride = theGrid.countX * band.pointSize;
+	band.points = theGrid.countY * theGrid.countX;
+	band.fd = -1;
+	band.data = NULL;
+	band.size = 0;
+	band.locked = 0;
+
+	//
+	// Add band.
+	//
+	theDataset->bands.push_back( band );
+
+	return theDataset->bands.size() - 1;										// ==>
+
+} // AddBand.
+
+
+/*===================================================================================
+ *	AddLayerBands																	*
+ *==================================================================================*/
+
+/**
+ * Add layer bands.
+ *
+ * This function will append the bands of the provided layer located in the provided
+ * directory to the dataset and return the index of the first band; the layer path
+ * template must contain a <i>%d</i> placeholder if the layer has monthly series stored
+ * in a file per month. Interleaved layers have a single band holding all months. An
+ * absolute layer path is used as is, it is only valid for the base dataset, see
+ * AddScenario().
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param int				theLayer			Layer index.
+ * @param const string &	theDirectory		Layer directory.
+ *
+ * @access private
+ * @return int
+ */
+static int AddLayerBands( DATASET_T * theDataset, int theLayer,
+						  const string & theDirectory )
+{
+	//
+	// Init local storage.
+	//
+	const LAYER_T layer = theDataset->layers[ theLayer ];
+	if( layer.derived != kDERIVED_NONE )
+		return -1;																// ==>
+
+	string path = ( layer.path.size() && (layer.path[ 0 ] == '/') )
+				? layer.path
+				: theDirectory + layer.path;
+
+	//
+	// Handle single band.
+	//
+	if( ! layer.months )
+		return AddBand( theDataset, path, theLayer, 0, layer.type, layer.grid );	// ==>
+
+	//
+	// Handle monthly cube.
+	//
+	if( layer.interleaved )
+	{
+		int band = AddBand( theDataset, path, theLayer, 0, layer.type, layer.grid );
+		BAND_T & cube = theDataset->bands[ band ];
+		cube.months = layer.months;
+		cube.stride *= layer.months;
+		cube.points *= layer.months;
+
+		return band;															// ==>
+	}
+
+	//
+	// Split template.
+	//
+	size_t mark = path.find( "%d" );
+	string head = path.substr( 0, mark );
+	string tail = path.substr( mark + 2 );
+
+	//
+	// Add months.
+	//
+	int first = -1;
+	char buffer [16];
+	for( int month = 1; month <= layer.months; month++ )
+	{
+		sprintf( buffer, "%d", month );
+		int band = AddBand( theDataset, head + buffer + tail,
+							theLayer, month, layer.type, layer.grid );
+		if( month == 1 )
+			first = band;
+
+	} // Iterating months.
+
+	return first;																// ==>
+
+} // AddLayerBands.
+
+
+/*===================================================================================
+ *	AddLayer																		*
+ *==================================================================================*/
+
+/**
+ * Add layer.
+ *
+ * This function will append a layer and its base dataset bands to the dataset; layers
+ * named <i>bio1</i> to <i>bio19</i> are flagged with their bioclimatic variable number.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param LAYER_T &			theLayer			Layer.
+ * @param const string &	thePath				Path template.
+ * @param int				theType				Sample type.
+ *
+ * @access private
+ * @return void
+ */
+static void AddLayer( DATASET_T * theDataset, LAYER_T & theLayer,
+					  const string & thePath, int theType )
+{
+	//
+	// Add layer.
+	//
+	theLayer.path = thePath;
+	theLayer.type = theType;
+	theLayer.band = -1;
+	theLayer.bioclim = 0;
+	if( theLayer.name.compare( 0, 3, "bio" ) == 0 )
+	{
+		int variable = atoi( theLayer.name.c_str() + 3 );
+		if( (variable >= 1)
+		 && (variable <= kBIOCLIM_Count) )
+			theLayer.bioclim = variable;
+	}
+	theDataset->layers.push_back( theLayer );
+
+	//
+	// Add bands.
+	//
+	int index = theDataset->layers.size() - 1;
+	theDataset->layers[ index ].band = AddLayerBands( theDataset, index, "" );
+
+} // AddLayer.
+
+
+/*===================================================================================
+ *	AddScenario																		*
+ *==================================================================================*/
+
+/**
+ * Add scenario.
+ *
+ * This function will append a scenario and the bands of the provided layers to the
+ * dataset; if the layers list is empty, all layers are added. Layer files are resolved
+ * in the scenario directory, layers with an absolute path cannot be and are rejected,
+ * rather than resolved to the base dataset files.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param SCENARIO_T &		theScenario			Scenario.
+ * @param const string &	theLayers			Blank separated layer names.
+ * @param string *			theMessage			Receives error message.
+ *
+ * @access private
+ * @return int
+ */
+static int AddScenario( DATASET_T * theDataset, SCENARIO_T & theScenario,
+						const string & theLayers, string * theMessage )
+{
+	//
+	// Init bands.
+	//
+	theScenario.bands.assign( theDataset->layers.size(), -1 );
+
+	//
+	// Normalise directory.
+	//
+	if( theScenario.directory.size()
+	 && (theScenario.directory[ theScenario.directory.size() - 1 ] != '/') )
+		theScenario.directory += '/';
+
+	//
+	// Select all layers.
+	//
+	vector<int> layers;
+	if( theLayers.empty() )
+	{
+		for( size_t layer = 0; layer < theDataset->layers.size(); layer++ )
+			layers.push_back( layer );
+	}
+
+	//
+	// Select listed layers.
+	//
+	else
+	{
+		string name;
+		istringstream stream( theLayers );
+		while( stream >> name )
+		{
+			int layer = FindLayer( *theDataset, name );
+			if( layer < 0 )
+			{
+				*theMessage = "Unknown layer [" + name + "] in scenario ["
+							+ theScenario.name + "]";
+				return kERROR_INVALID_MANIFEST;									// ==>
+			}
+			layers.push_back( layer );
+
+		} // Iterating layers.
+	}
+
+	//
+	// Add layers.
+	//
+	for( size_t i = 0; i < layers.size(); i++ )
+	{
+		const LAYER_T & layer = theDataset->layers[ layers[ i ] ];
+		if( (layer.derived == kDERIVED_NONE)
+		 && layer.path.size()
+		 && (layer.path[ 0 ] == '/') )
+		{
+			*theMessage = "Layer [" + layer.name + "] has an absolute path, it cannot "
+						+ "be resolved in scenario [" + theScenario.name + "]";
+			return kERROR_INVALID_MANIFEST;										// ==>
+		}
+
+		theScenario.bands[ layers[ i ] ]
+			= AddLayerBands( theDataset, layers[ i ], theScenario.directory );
+
+	} // Iterating layers.
+
+	//
+	// Add scenario.
+	//
+	theDataset->scenarios.push_back( theScenario );
+
+	return kERROR_OK;															// ==>
+
+} // AddScenario.
+
+
+/*===================================================================================
+ *	AddBaseScenario																	*
+ *==================================================================================*/
+
+/**
+ * Add base scenario.
+ *
+ * This function will add the base dataset as the first scenario, its bands are the
+ * layer bands.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ *
+ * @access private
+ * @return void
+ */
+static void AddBaseScenario( DATASET_T * theDataset )
+{
+	SCENARIO_T scenario;
+	scenario.name = kBaseScenario;
+	for( size_t layer = 0; layer < theDataset->layers.size(); layer++ )
+		scenario.bands.push_back( theDataset->layers[ layer ].band );
+
+	theDataset->scenarios.insert( theDataset->scenarios.begin(), scenario );
+
+} // AddBaseScenario.
+
+
+/*===================================================================================
+ *	AddTile																			*
+ *==================================================================================*/
+
+/**
+ * Add tile.
+ *
+ * This function will append a GTOPO-30 tile and its elevation and source bands to the
+ * dataset.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param TILE_T &			theTile				Tile.
+ * @param const string &	theDEM				Elevation file path.
+ * @param const string &	theSRC				Source map file path.
+ *
+ * @access private
+ * @return void
+ */
+static void AddTile( DATASET_T * theDataset, TILE_T & theTile,
+					 const string & theDEM, const string & theSRC )
+{
+	theTile.dem = AddBand( theDataset, theDEM, -1, 0, kTYPE_SINT16, theTile.grid );
+	theTile.src = AddBand( theDataset, theSRC, -1, 0, kTYPE_UINT8, theTile.grid );
+	theDataset->tiles.push_back( theTile );
+
+} // AddTile.
+
+
+/*===================================================================================
+ *	LoadBuiltinTiles																*
+ *==================================================================================*/
+
+/**
+ * Load built-in tiles.
+ *
+ * This function will load the GTOPO-30 tiles and sources from the built-in tables.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param bool				doSources			TRUE means load sources.
+ * @param bool				doTiles				TRUE means load tiles.
+ *
+ * @access private
+ * @return void
+ */
+static void LoadBuiltinTiles( DATASET_T * theDataset, bool doSources, bool doTiles )
+{
+	//
+	// Load sources.
+	//
+	if( doSources )
+	{
+		for( int source = 0; source < kGTOPO30_SourcesCount; source++ )
+			theDataset->sources.push_back( kGTOPO30_Sources[ source ] );
+	}
+
+	//
+	// Load tiles.
+	//
+	if( doTiles )
+	{
+		for( int tile = 0; tile < kGTOPO30_TilesCount; tile++ )
+		{
+			const TILES_T & table = kGTOPO30_Tiles[ tile ];
+			TILE_T entry;
+			entry.name = table.name;
+			SetGrid( &entry.grid, table.area, table.countY, table.countX );
+
+			string path = table.path;
+			AddTile( theDataset, entry, path + ".DEM", path + ".SRC" );
+
+		} // Iterating tiles.
+	}
+
+} // LoadBuiltinTiles.
+
+
+/*===================================================================================
+ *	LoadBuiltinLayers																*
+ *==================================================================================*/
+
+/**
+ * Load built-in layers.
+ *
+ * This function will load the WORLDCLIM layers from the built-in tables.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ *
+ * @access private
+ * @return void
+ */
+static void LoadBuiltinLayers( DATASET_T * theDataset )
+{
+	//
+	// Load file layers.
+	//
+	for( int feature = 0; feature < kWORLDCLIM_FilesCount; feature++ )
+	{
+		//
+		// Init layer.
+		//
+		const WORLDCLIM_T & table = kWORLDCLIM_Tiles[ feature ];
+		LAYER_T layer;
+		layer.name = table.name;
+		layer.source = table.source;
+		layer.months = table.months;
+		layer.scale = 1.0;
+		layer.interleaved = false;
+		layer.derived = kDERIVED_NONE;
+		layer.base = 0;
+
+		//
+		// Set grid.
+		//
+		AREA_T area;
+		area.latMin = table.latMin;
+		area.latMax = table.latMax;
+		area.lonMin = table.lonMin;
+		area.lonMax = table.lonMax;
+		SetGrid( &layer.grid, area, table.countY, table.countX );
+
+		//
+		// Add layer.
+		//
+		AddLayer( theDataset, layer, table.path, kTYPE_SINT16 );
+
+	} // Iterating features.
+
+	//
+	// Load derived layers.
+	//
+	for( int feature = 0; feature < kDERIVED_LayersCount; feature++ )
+	{
+		LAYER_T layer;
+		layer.name = kDERIVED_Layers[ feature ].name;
+		layer.source = kDERIVED_Layers[ feature ].source;
+		layer.months = 0;
+		layer.scale = 1.0;
+		layer.interleaved = false;
+		layer.derived = kDERIVED_Layers[ feature ].kind;
+		layer.base = kDERIVED_Layers[ feature ].base;
+		layer.grid = GRID_T();
+		AddLayer( theDataset, layer, "", kTYPE_SINT16 );
+
+	} // Iterating derived features.
+
+} // LoadBuiltinLayers.
+
+
+/*===================================================================================
+ *	Trim																			*
+ *==================================================================================*/
+
+/**
+ * Trim string.
+ *
+ * This function will return the provided string without leading and trailing blanks.
+ *
+ * @param const string &	theString			String.
+ *
+ * @access private
+ * @return string
+ */
+static string Trim( const string & theString )
+{
+	size_t start = theString.find_first_not_of( " \t\r\n" );
+	if( start == string::npos )
+		return "";																// ==>
+
+	size_t end = theString.find_last_not_of( " \t\r\n" );
+
+	return theString.substr( start, end - start + 1 );							// ==>
+
+} // Trim.
+
+
+/*===================================================================================
+ *	ParseManifest																	*
+ *==================================================================================*/
+
+/**
+ * Parse manifest.
+ *
+ * This function will parse the provided manifest file into the provided dataset, see the
+ * file header for the manifest structure. Parts that are not defined in the manifest are
+ * loaded from the built-in tables.
+ *
+ * @param const string &	theManifest			Manifest file path.
+ * @param DATASET_T *		theDataset			Receives registry.
+ * @param string *			theMessage			Receives error message.
+ *
+ * @access private
+ * @return int
+ */
+static int ParseManifest( const string & theManifest, DATASET_T * theDataset,
+						  string * theMessage )
+{
+	//
+	// Open manifest.
+	//
+	ifstream file( theManifest.c_str() );
+	if( ! file.is_open() )
+	{
+		*theMessage = "Unable to open manifest [" + theManifest + "]";
+		return kERROR_INVALID_MANIFEST;											// ==>
+	}
+
+	//
+	// Init local storage.
+	//
+	int count = 0;
+	string line, kind, name;
+	bool got_sources = false, got_tiles = false, got_layers = false;
+	string dem, src, path;
+	int type = kTYPE_SINT16;
+	AREA_T area = { 0, 0, 0, 0 };
+	UInt64 count_y = 0, count_x = 0;
+	bool got_extent = false;
+	LAYER_T layer;
+	SCENARIO_T scenario;
+	vector<SCENARIO_T> scenarios;
+	vector<string> scenario_layers, scenario_names;
+	string layers;
+	ostringstream error;
+
+	//
+	// Iterate lines.
+	// The extra iteration flushes the last section.
+	//
+	bool more = true;
+	while( more )
+	{
+		//
+		// Read line.
+		//
+		if( ! getline( file, line ) )
+		{
+			more = false;
+			line = "[]";
+		}
+		else
+			count++;
+
+		//
+		// Skip comments and blanks.
+		//
+		line = Trim( line );
+		if( line.empty()
+		 || (line[ 0 ] == ';')
+		 || (line[ 0 ] == '#') )
+			continue;															// =>
+
+		//
+		// Handle section.
+		//
+		if( line[ 0 ] == '[' )
+		{
+			//
+			// Check section.
+			//
+			if( line[ line.size() - 1 ] != ']' )
+			{
+				error << "Invalid section at line " << count;
+				break;															// =>
+			}
+
+			//
+			// Flush previous scenario.
+			// Scenarios are added once all layers are known.
+			//
+			if( kind == "scenario" )
+			{
+				if( scenario.directory.empty() )
+				{
+					error << "Missing directory for scenario [" << name << "]";
+					break;														// =>
+				}
+
+				scenario.name = name;
+				scenarios.push_back( scenario );
+				scenario_layers.push_back( layers );
+			}
+
+			//
+			// Flush previous tile or layer.
+			//
+			else if( (kind == "tile")
+			 || (kind == "layer") )
+			{
+				//
+				// Check extent.
+				// Derived layers have no files.
+				//
+				if( (! got_extent)
+				 && ((kind == "tile") || (layer.derived == kDERIVED_NONE)) )
+				{
+					error << "Missing extent for " << kind << " [" << name << "]";
+					break;														// =>
+				}
+
+				//
+				// Handle tile.
+				//
+				if( kind == "tile" )
+				{
+					TILE_T tile;
+					tile.name = name;
+					SetGrid( &tile.grid, area, count_y, count_x );
+					if( dem.empty() )
+						dem = "GTOPO30/" + name + "/" + name + ".DEM";
+					if( src.empty() )
+						src = "GTOPO30/" + name + "/" + name + ".SRC";
+					AddTile( theDataset, tile, dem, src );
+				}
+
+				//
+				// Handle layer.
+				//
+				else if( layer.derived != kDERIVED_NONE )
+				{
+					layer.name = name;
+					layer.months = 0;
+					layer.grid = GRID_T();
+					if( layer.source.empty() )
+						layer.source = "Computed from monthly tmin, tmax and prec";
+					AddLayer( theDataset, layer, "", type );
+					if( (layer.derived == kDERIVED_BIOCLIM)
+					 && (! theDataset->layers.back().bioclim) )
+					{
+						error << "Invalid bioclimatic layer name [" << name << "]";
+						break;													// =>
+					}
+				}
+
+				//
+				// Handle layer files.
+				//
+				else
+				{
+					//
+					// Set default path.
+					//
+					layer.name = name;
+					if( ! layer.months )
+						layer.interleaved = false;
+					if( path.empty() )
+						path = "WORLDCLIM30/" + name + "/" + name
+							 + (( layer.interleaved ) ? ".bip"
+							 : (( layer.months ) ? "_%d.bil" : ".bil"));
+
+					//
+					// Check month placeholder.
+					//
+					if( layer.months
+					 && (! layer.interleaved)
+					 && (path.find( "%d" ) == string::npos) )
+					{
+						error << "Missing month placeholder in path of layer ["
+							  << name << "]";
+						break;													// =>
+					}
+
+					SetGrid( &layer.grid, area, count_y, count_x );
+					AddLayer( theDataset, layer, path, type );
+				}
+
+			} // Flush section.
+
+			//
+			// Parse section header.
+			//
+			string header = Trim( line.substr( 1, line.size() - 2 ) );
+			size_t mark = header.find_first_of( " \t" );
+			kind = header.substr( 0, mark );
+			name = ( mark != string::npos ) ? Trim( header.substr( mark ) ) : "";
+
+			//
+			// Reset section data.
+			//
+			dem = src = path = layers = "";
+			scenario.source = scenario.directory = "";
+			type = kTYPE_SINT16;
+			count_y = count_x = 0;
+			got_extent = false;
+			layer.source = "";
+			layer.months = 0;
+			layer.scale = 1.0;
+			layer.interleaved = false;
+			layer.derived = kDERIVED_NONE;
+			layer.base = 10;
+
+			//
+			// Check section kind.
+			//
+			if( kind == "sources" )
+				got_sources = true;
+			else if( kind == "tile" )
+				got_tiles = true;
+			else if( kind == "layer" )
+				got_layers = true;
+			else if( kind == "scenario" )
+			{
+				if( (name == kBaseScenario)
+				 || (find( scenario_names.begin(), scenario_names.end(), name )
+					 != scenario_names.end()) )
+				{
+					error << "Duplicate scenario [" << name << "] at line " << count;
+					break;														// =>
+				}
+				scenario_names.push_back( name );
+			}
+			else if( more )
+			{
+				error << "Unknown section [" << kind << "] at line " << count;
+				break;															// =>
+			}
+
+			//
+			// Check name.
+			//
+			if( ((kind == "tile") || (kind == "layer") || (kind == "scenario"))
+			 && name.empty() )
+			{
+				error << "Missing " << kind << " name at line " << count;
+				break;															// =>
+			}
+
+			continue;															// =>
+
+		} // Section.
+
+		//
+		// Parse key and value.
+		//
+		size_t mark = line.find( '=' );
+		if( (mark == string::npos)
+		 || kind.empty() )
+		{
+			error << "Invalid entry at line " << count;
+			break;																// =>
+		}
+		string key = Trim( line.substr( 0, mark ) );
+		string value = Trim( line.substr( mark + 1 ) );
+		istringstream stream( value );
+		bool valid = true;
+
+		//
+		// Handle sources.
+		//
+		if( kind == "sources" )
+		{
+			int code = atoi( key.c_str() );
+			if( (code < 0)
+			 || (code > 255) )
+				valid = false;
+			else
+			{
+				if( (int) theDataset->sources.size() <= code )
+					theDataset->sources.resize( code + 1 );
+				theDataset->sources[ code ] = value;
+			}
+		}
+
+		//
+		// Handle scenarios.
+		//
+		else if( kind == "scenario" )
+		{
+			if( key == "source" )
+				scenario.source = value;
+			else if( key == "directory" )
+				scenario.directory = value;
+			else if( key == "layers" )
+				layers = value;
+			else
+				valid = false;
+		}
+
+		//
+		// Handle geometry.
+		//
+		else if( key == "extent" )
+			valid = got_extent = (bool) (stream >> area.latMin >> area.latMax
+												>> area.lonMin >> area.lonMax)
+								&& (area.latMax > area.latMin)
+								&& (area.lonMax > area.lonMin);
+		else if( key == "grid" )
+			valid = (bool) (stream >> count_y >> count_x)
+				 && count_y
+				 && count_x;
+
+		//
+		// Handle tile files.
+		//
+		else if( (kind == "tile")
+			  && (key == "dem") )
+			dem = value;
+		else if( (kind == "tile")
+			  && (key == "src") )
+			src = value;
+
+		//
+		// Handle layer attributes.
+		//
+		else if( (kind == "layer")
+			  && (key == "source") )
+			layer.source = value;
+		else if( (kind == "layer")
+			  && (key == "months") )
+			valid = (bool) (stream >> layer.months)
+				 && (layer.months >= 0)
+				 && (layer.months <= 12);
+		else if( (kind == "layer")
+			  && (key == "scale") )
+			valid = (bool) (stream >> layer.scale);
+		else if( (kind == "layer")
+			  && (key == "path") )
+			path = value;
+		else if( (kind == "layer")
+			  && (key == "layout") )
+		{
+			if( value == "bsq" )
+				layer.interleaved = false;
+			else if( value == "bip" )
+				layer.interleaved = true;
+			else
+				valid = false;
+		}
+		else if( (kind == "layer")
+			  && (key == "derived") )
+		{
+			if( value == "bioclim" )
+				layer.derived = kDERIVED_BIOCLIM;
+			else if( value == "gdd" )
+				layer.derived = kDERIVED_GDD;
+			else if( value == "pet" )
+				layer.derived = kDERIVED_PET;
+			else if( value == "aridity" )
+				layer.derived = kDERIVED_ARIDITY;
+			else if( value == "frost" )
+				layer.derived = kDERIVED_FROST;
+			else
+				valid = false;
+		}
+		else if( (kind == "layer")
+			  && (key == "base") )
+			valid = (bool) (stream >> layer.base);
+		else if( (kind == "layer")
+			  && (key == "type") )
+		{
+			if( value == "int16" )
+				type = kTYPE_SINT16;
+			else if( value == "uint8" )
+				type = kTYPE_UINT8;
+			else
+				valid = false;
+		}
+		else
+			valid = false;
+
+		//
+		// Check entry.
+		//
+		if( ! valid )
+		{
+			error << "Invalid entry [" << key << "] at line " << count;
+			break;																// =>
+		}
+
+	} // Iterating lines.
+
+	//
+	// Handle errors.
+	//
+	if( error.str().size() )
+	{
+		*theMessage = error.str() + " of manifest [" + theManifest + "]";
+		return kERROR_INVALID_MANIFEST;											// ==>
+	}
+
+	//
+	// Load missing parts.
+	//
+	LoadBuiltinTiles( theDataset, ! got_sources, ! got_tiles );
+	if( ! got_layers )
+		LoadBuiltinLayers( theDataset );
+
+	//
+	// Add scenarios.
+	//
+	AddBaseScenario( theDataset );
+	for( size_t i = 0; i < scenarios.size(); i++ )
+	{
+		int status = AddScenario( theDataset, scenarios[ i ], scenario_layers[ i ],
+								  theMessage );
+		if( status )
+		{
+			*theMessage += " of manifest [" + theManifest + "]";
+			return status;														// ==>
+		}
+	}
+
+	return kERROR_OK;															// ==>
+
+} // ParseManifest.
+
+
+/*===================================================================================
+ *	GetHeaderPath																	*
+ *==================================================================================*/
+
+/**
+ * Get band header path.
+ *
+ * This function will return the path of the ESRI header of the provided band file, the
+ * file path with the <i>.hdr</i> extension, or <i>.HDR</i> if only that one exists, as
+ * in the GTOPO-30 tiles.
+ *
+ * @param const string &	thePath				Band file path.
+ *
+ * @access private
+ * @return string
+ */
+static string GetHeaderPath( const string & thePath )
+{
+	size_t dot = thePath.rfind( '.' );
+	if( (dot == string::npos)
+	 || (thePath.find( '/', dot ) != string::npos) )
+		dot = thePath.size();
+	string lower = thePath.substr( 0, dot ) + ".hdr";
+	string upper = thePath.substr( 0, dot ) + ".HDR";
+
+	return ( access( lower.c_str(), F_OK )
+		  && (! access( upper.c_str(), F_OK )) ) ? upper : lower;				// ==>
+
+} // GetHeaderPath.
+
+
+/*===================================================================================
+ *	ReadBandHeader																	*
+ *==================================================================================*/
+
+/**
+ * Read band header.
+ *
+ * This function will set the byte order and the sample type of the provided band from
+ * its ESRI header, if it exists: <i>BYTEORDER</i> is <i>I</i> for little-endian and
+ * <i>M</i> for big-endian samples, <i>NBITS</i> of 8 declares byte samples. Byte bands
+ * are left as they are, they have no byte order and GTOPO-30 source maps share the
+ * header of the elevations.
+ *
+ * @param BAND_T *			theBand				Band.
+ *
+ * @access private
+ * @return void
+ */
+static void ReadBandHeader( BAND_T * theBand )
+{
+	//
+	// Open header.
+	//
+	if( theBand->type == kTYPE_UINT8 )
+		return;																	// ==>
+	ifstream file( GetHeaderPath( theBand->path ).c_str() );
+
+	//
+	// Parse entries.
+	//
+	string line;
+	while( getline( file, line ) )
+	{
+		string key, value;
+		istringstream stream( line );
+		if( ! (stream >> key >> value) )
+			continue;															// =>
+		transform( key.begin(), key.end(), key.begin(), ::toupper );
+
+		if( (key == "BYTEORDER")
+		 && ((value == "I") || (value == "i")) )
+			theBand->swapped = kHOST_BigEndian;
+		else if( (key == "BYTEORDER")
+			  && ((value == "M") || (value == "m")) )
+			theBand->swapped = ! kHOST_BigEndian;
+		else if( (key == "NBITS")
+			  && (value == "8") )
+		{
+			theBand->stride /= theBand->pointSize;
+			theBand->type = kTYPE_UINT8;
+			theBand->pointSize = 1;
+		}
+	}
+
+} // ReadBandHeader.
+
+
+/*===================================================================================
+ *	MapBand																			*
+ *==================================================================================*/
+
+/**
+ * Map band file.
+ *
+ * This function will map the provided band file and disable its readahead, since point
+ * lookups are random; the function will return NULL if the file cannot be mapped.
+ *
+ * If huge pages are requested, the mapping is placed at a
+ * <i>{@link kHugePageSize kHugePageSize}</i> boundary and advised with
+ * <i>MADV_HUGEPAGE</i>, so that the kernel may back it with huge pages and a random
+ * lookup costs one translation entry per 2 MB rather than per page; where the system
+ * does not support huge pages for files the advice has no effect.
+ *
+ * @param const BAND_T &	theBand				Band.
+ * @param const bool		doHuge				TRUE means huge pages.
+ *
+ * @access private
+ * @return const char *
+ */
+static const char * MapBand( const BAND_T & theBand, const bool doHuge )
+{
+	//
+	// Map file.
+	//
+	void * data = MAP_FAILED;
+	if( ! doHuge )
+		data = mmap( NULL, theBand.size, PROT_READ, MAP_SHARED, theBand.fd, 0 );
+
+	//
+	// Map aligned file.
+	// An anonymous range a huge page larger is reserved, the file is mapped over its
+	// aligned part and the rest is released.
+	//
+	else
+	{
+		UInt64 page = sysconf( _SC_PAGESIZE );
+		UInt64 length = ((theBand.size + page - 1) / page) * page;
+		void * range = mmap( NULL, length + kHugePageSize, PROT_NONE,
+							 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+		if( range == MAP_FAILED )
+			return NULL;														// ==>
+		char * base = (char *) range;
+		char * start = base + ((kHugePageSize - ((size_t) base % kHugePageSize))
+							   % kHugePageSize);
+		data = mmap( start, theBand.size, PROT_READ, MAP_SHARED | MAP_FIXED,
+					 theBand.fd, 0 );
+		if( data == MAP_FAILED )
+		{
+			munmap( range, length + kHugePageSize );
+			return NULL;														// ==>
+		}
+		if( start > base )
+			munmap( base, start - base );
+		munmap( start + length, kHugePageSize - (start - base) );
+#ifdef MADV_HUGEPAGE
+		madvise( data, theBand.size, MADV_HUGEPAGE );
+#endif
+	}
+
+	if( data == MAP_FAILED )
+		return NULL;															// ==>
+
+	madvise( data, theBand.size, MADV_RANDOM );
+
+	return (const char *) data;													// ==>
+
+} // MapBand.
+
+
+/*===================================================================================
+ *	OpenBands																		*
+ *==================================================================================*/
+
+/**
+ * Open bands.
+ *
+ * This function will open and map all the dataset bands; files that cannot be opened are
+ * left closed and their values will be reported as missing, files that cannot be mapped
+ * are left open and will be read with <i>pread</i>. In <i>{@link kIO_URING kIO_URING}</i>
+ * mode files are not mapped and the read queue is opened, if the queue is not available
+ * files are read with <i>pread</i>; in <i>{@link kIO_PREAD kIO_PREAD}</i> mode files are
+ * never mapped and are all read with <i>pread</i>. The byte order and sample type of each
+ * opened file are taken from its header, see ReadBandHeader(); files are mapped by
+ * MapBand().
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ *
+ * @access private
+ * @return void
+ */
+static void OpenBands( DATASET_T * theDataset )
+{
+	//
+	// Open read queue.
+	//
+	if( theDataset->io == kIO_URING )
+	{
+		theDataset->ring = new URING_T;
+		if( ! OpenRing( theDataset->ring, kURING_Entries ) )
+		{
+			delete theDataset->ring;
+			theDataset->ring = NULL;
+		}
+	}
+
+	for( size_t i = 0; i < theDataset->bands.size(); i++ )
+	{
+		//
+		// Open file.
+		//
+		BAND_T & band = theDataset->bands[ i ];
+		band.fd = open( band.path.c_str(), O_RDONLY );
+		if( band.fd < 0 )
+			continue;															// =>
+		ReadBandHeader( &band );
+
+		//
+		// Get size.
+		//
+		struct stat info;
+		if( fstat( band.fd, &info ) )
+			continue;															// =>
+		band.size = info.st_size;
+
+		//
+		// Map file.
+		//
+		if( band.size
+		 && (theDataset->io == kIO_MMAP) )
+			band.data = MapBand( band, theDataset->huge );
+
+	} // Iterating bands.
+
+} // OpenBands.
+
+
+/*===================================================================================
+ *	LoadDataset																		*
+ *==================================================================================*/
+
+/**
+ * Load dataset.
+ *
+ * This function will load the dataset registry from the provided manifest, or from the
+ * built-in tables if the manifest is empty, and open all the dataset files for the
+ * provided I/O mode; mapped files are backed with huge pages if requested.
+ *
+ * @param const string &	theDirectory		Base dataset directory path.
+ * @param const string &	theManifest			Manifest file path.
+ * @param const int			theIO				I/O mode.
+ * @param const bool		doHuge				TRUE means huge pages.
+ * @param DATASET_T *		theDataset			Receives dataset.
+ * @param string *			theMessage			Receives error message.
+ *
+ * @access public
+ * @return int
+ */
+int LoadDataset( const string & theDirectory, const string & theManifest,
+				 const int theIO, const bool doHuge, DATASET_T * theDataset,
+				 string * theMessage )
+{
+	//
+	// Init dataset.
+	//
+	theDataset->directory = theDirectory;
+	theDataset->io = theIO;
+	theDataset->huge = doHuge;
+	theDataset->ring = NULL;
+	theDataset->epoch = 0;
+	theDataset->users = 0;
+	theDataset->shortfall = 0;
+	theDataset->sources.clear();
+	theDataset->tiles.clear();
+	theDataset->layers.clear();
+	theDataset->scenarios.clear();
+	theDataset->bands.clear();
+
+	//
+	// Load registry.
+	//
+	if( theManifest.size() )
+	{
+		int error = ParseManifest( theManifest, theDataset, theMessage );
+		if( error )
+			return error;														// ==>
+	}
+	else
+	{
+		LoadBuiltinTiles( theDataset, true, true );
+		LoadBuiltinLayers( theDataset );
+		AddBaseScenario( theDataset );
+	}
+
+	//
+	// Resolve derived layers inputs.
+	// Inputs must be monthly series.
+	//
+	int * inputs[] = { &theDataset->tmin, &theDataset->tmax, &theDataset->prec };
+	const char * names[] = { "tmin", "tmax", "prec" };
+	for( int i = 0; i < 3; i++ )
+	{
+		*inputs[ i ] = FindLayer( *theDataset, names[ i ] );
+		if( (*inputs[ i ] >= 0)
+		 && (theDataset->layers[ *inputs[ i ] ].months != kBIOCLIM_Months) )
+			*inputs[ i ] = -1;
+	}
+
+	//
+	// Open files.
+	//
+	OpenBands( theDataset );
+
+	return kERROR_OK;															// ==>
+
+} // LoadDataset.
+
+
+/*===================================================================================
+ *	CloseDataset																	*
+ *==================================================================================*/
+
+/**
+ * Close dataset.
+ *
+ * This function will unmap and close all the dataset files and the read queue; locked
+ * pages are unlocked with their mapping.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ *
+ * @access public
+ * @return void
+ */
+void CloseDataset( DATASET_T * theDataset )
+{
+	for( size_t i = 0; i < theDataset->bands.size(); i++ )
+	{
+		BAND_T & band = theDataset->bands[ i ];
+		if( band.data != NULL )
+			munmap( (void *) band.data, band.size );
+		if( band.fd >= 0 )
+			close( band.fd );
+		band.data = NULL;
+		band.fd = -1;
+		band.locked = 0;
+
+	} // Iterating bands.
+
+	if( theDataset->ring != NULL )
+	{
+		CloseRing( theDataset->ring );
+		delete theDataset->ring;
+		theDataset->ring = NULL;
+	}
+
+} // CloseDataset.
+
+
+/*===================================================================================
+ *	FindLayer																		*
+ *==================================================================================*/
+
+/**
+ * Find layer.
+ *
+ * This function will return the index of the layer matching the provided name, or -1.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const string &	theName				Layer name.
+ *
+ * @access public
+ * @return int
+ */
+int FindLayer( const DATASET_T & theDataset, const string & theName )
+{
+	for( size_t i = 0; i < theDataset.layers.size(); i++ )
+	{
+		if( theDataset.layers[ i ].name == theName )
+			return i;															// ==>
+	}
+
+	return -1;																	// ==>
+
+} // FindLayer.
+
+
+/*===================================================================================
+ *	FindScenario																	*
+ *==================================================================================*/
+
+/**
+ * Find scenario.
+ *
+ * This function will return the index of the scenario matching the provided name, or -1.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const string &	theName				Scenario name.
+ *
+ * @access public
+ * @return int
+ */
+int FindScenario( const DATASET_T & theDataset, const string & theName )
+{
+	for( size_t i = 0; i < theDataset.scenarios.size(); i++ )
+	{
+		if( theDataset.scenarios[ i ].name == theName )
+			return i;															// ==>
+	}
+
+	return -1;																	// ==>
+
+} // FindScenario.
+
+
+/*===================================================================================
+ *	FindTile																		*
+ *==================================================================================*/
+
+/**
+ * Find tile.
+ *
+ * This function will return the index of the elevation tile containing the provided
+ * coordinates, or -1 if the coordinates are out of map; tiles exclude their southern and
+ * eastern bounds.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param double			theLatitude			Latitude.
+ * @param double			theLongitude		Longitude.
+ *
+ * @access public
+ * @return int
+ */
+int FindTile( const DATASET_T & theDataset, double theLatitude, double theLongitude )
+{
+	for( size_t i = 0; i < theDataset.tiles.size(); i++ )
+	{
+		const AREA_T & area = theDataset.tiles[ i ].grid.area;
+		if( (theLatitude > area.latMin)
+		 && (theLatitude <= area.latMax)
+		 && (theLongitude >= area.lonMin)
+		 && (theLongitude < area.lonMax) )
+			return i;															// ==>
+	}
+
+	return -1;																	// ==>
+
+} // FindTile.
+
+
+/*===================================================================================
+ *	GetCellOffset																	*
+ *==================================================================================*/
+
+/**
+ * Get cell offset.
+ *
+ * This function will return the offset of the data point containing the provided
+ * coordinates in the provided grid, the row and column are returned in the provided
+ * arguments.
+ *
+ * Coordinates outside the grid get the offset of the cell past the last one, which band
+ * reads reject, as in GetCellOffsets(); a row or column outside the grid is returned as
+ * the number of rows or columns.
+ *
+ * @param const GRID_T &	theGrid				Grid.
+ * @param double			theLatitude			Latitude.
+ * @param double			theLongitude		Longitude.
+ * @param UInt64 *			theRow				Receives row.
+ * @param UInt64 *			theColumn			Receives column.
+ *
+ * @access public
+ * @return UInt64
+ */
+UInt64 GetCellOffset( const GRID_T & theGrid, double theLatitude, double theLongitude,
+					  UInt64 * theRow, UInt64 * theColumn )
+{
+	double row = ceil( (theGrid.area.latMax - theLatitude) * theGrid.pointsY );
+	double column = floor( (theLongitude - theGrid.area.lonMin) * theGrid.pointsX );
+	bool inside_row = (row >= 0) && (row < (double) theGrid.countY);
+	bool inside_column = (column >= 0) && (column < (double) theGrid.countX);
+	*theRow = ( inside_row ) ? (UInt64) row : theGrid.countY;
+	*theColumn = ( inside_column ) ? (UInt64) column : theGrid.countX;
+
+	if( ! (inside_row && inside_column) )
+		return theGrid.countY * theGrid.countX;									// ==>
+
+	return (*theRow * theGrid.countX) + *theColumn;								// ==>
+
+} // GetCellOffset.
+
+
+/*===================================================================================
+ *	GetCellOffsets																	*
+ *==================================================================================*/
+
+/**
+ * Get cell offsets.
+ *
+ * This function will set the offsets of the data points containing the provided
+ * coordinates in the provided grid, as GetCellOffset() does, for all the coordinates at
+ * once: rows and columns are computed a block at a time, four points at once with AVX,
+ * two with SSE4.1 or on ARM, with the same double operations and rounding as
+ * GetCellOffset(), so that points on cell boundaries fall in the same cells.
+ *
+ * Coordinates outside the grid get the offset of the cell past the last one, which band
+ * reads reject, rather than wrapping into another row.
+ *
+ * @param const GRID_T &	theGrid				Grid.
+ * @param const double *	theLatitudes		Latitudes.
+ * @param const double *	theLongitudes		Longitudes.
+ * @param size_t			theCount			Number of points.
+ * @param UInt64 *			theOffsets			Receives offsets.
+ *
+ * @access public
+ * @return void
+ */
+void GetCellOffsets( const GRID_T & theGrid, const double * theLatitudes,
+					 const double * theLongitudes, size_t theCount, UInt64 * theOffsets )
+{
+	double rows [ kCellBlock ], columns [ kCellBlock ];
+	double countY = theGrid.countY, countX = theGrid.countX;
+	UInt64 none = theGrid.countY * theGrid.countX;
+	for( size_t first = 0; first < theCount; first += kCellBlock )
+	{
+		//
+		// Compute rows and columns.
+		//
+		size_t count = ( (theCount - first) < kCellBlock ) ? (theCount - first)
+														   : kCellBlock;
+		const double * latitudes = theLatitudes + first;
+		const double * longitudes = theLongitudes + first;
+		size_t i = 0;
+
+#if defined( __AVX__ )
+		const __m256d top = _mm256_set1_pd( theGrid.area.latMax );
+		const __m256d left = _mm256_set1_pd( theGrid.area.lonMin );
+		const __m256d pointsY = _mm256_set1_pd( theGrid.pointsY );
+		const __m256d pointsX = _mm256_set1_pd( theGrid.pointsX );
+		for( ; (i + 4) <= count; i += 4 )
+		{
+			__m256d latitude = _mm256_loadu_pd( latitudes + i );
+			__m256d longitude = _mm256_loadu_pd( longitudes + i );
+			_mm256_storeu_pd( rows + i, _mm256_ceil_pd(
+				_mm256_mul_pd( _mm256_sub_pd( top, latitude ), pointsY ) ) );
+			_mm256_storeu_pd( columns + i, _mm256_floor_pd(
+				_mm256_mul_pd( _mm256_sub_pd( longitude, left ), pointsX ) ) );
+		}
+#elif defined( __SSE4_1__ )
+		const __m128d top = _mm_set1_pd( theGrid.area.latMax );
+		const __m128d left = _mm_set1_pd( theGrid.area.lonMin );
+		const __m128d pointsY = _mm_set1_pd( theGrid.pointsY );
+		const __m128d pointsX = _mm_set1_pd( theGrid.pointsX );
+		for( ; (i + 2) <= count; i += 2 )
+		{
+			__m128d latitude = _mm_loadu_pd( latitudes + i );
+			__m128d longitude = _mm_loadu_pd( longitudes + i );
+			_mm_storeu_pd( rows + i,
+						   _mm_ceil_pd( _mm_mul_pd( _mm_sub_pd( top, latitude ),
+													pointsY ) ) );
+			_mm_storeu_pd( columns + i,
+						   _mm_floor_pd( _mm_mul_pd( _mm_sub_pd( longitude, left ),
+													 pointsX ) ) );
+		}
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+		const float64x2_t top = vdupq_n_f64( theGrid.area.latMax );
+		const float64x2_t left = vdupq_n_f64( theGrid.area.lonMin );
+		const float64x2_t pointsY = vdupq_n_f64( theGrid.pointsY );
+		const float64x2_t pointsX = vdupq_n_f64( theGrid.pointsX );
+		for( ; (i + 2) <= count; i += 2 )
+		{
+			float64x2_t latitude = vld1q_f64( latitudes + i );
+			float64x2_t longitude = vld1q_f64( longitudes + i );
+			vst1q_f64( rows + i,
+					   vrndpq_f64( vmulq_f64( vsubq_f64( top, latitude ), pointsY ) ) );
+			vst1q_f64( columns + i,
+					   vrndmq_f64( vmulq_f64( vsubq_f64( longitude, left ), pointsX ) ) );
+		}
+#endif
+
+		for( ; i < count; i++ )
+		{
+			rows[ i ] = ceil( (theGrid.area.latMax - latitudes[ i ]) * theGrid.pointsY );
+			columns[ i ] = floor( (longitudes[ i ] - theGrid.area.lonMin)
+								  * theGrid.pointsX );
+		}
+
+		//
+		// Set offsets.
+		//
+		for( i = 0; i < count; i++ )
+			theOffsets[ first + i ] = ( (rows[ i ] >= 0)
+									 && (rows[ i ] < countY)
+									 && (columns[ i ] >= 0)
+									 && (columns[ i ] < countX) )
+									? (((UInt64) rows[ i ] * theGrid.countX)
+									   + (UInt64) columns[ i ])
+									: none;
+
+	} // Iterating blocks.
+
+} // GetCellOffsets.
+
+
+/*===================================================================================
+ *	QueueBands																		*
+ *==================================================================================*/
+
+/**
+ * Queue band reads.
+ *
+ * This function will convert the provided list of reads into file reads for the read
+ * queue: each run of adjacent points of the same band becomes one file read, points of a
+ * run crossing the end of the band are read one by one. The file reads are performed by
+ * the caller, then CompleteBands() sets the values of the reads.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param READ_T *			theReads			Reads.
+ * @param size_t			theCount			Number of reads.
+ * @param QUEUE_T *			theQueue			Receives file reads.
+ *
+ * @access public
+ * @return void
+ */
+void QueueBands( const DATASET_T & theDataset, READ_T * theReads, size_t theCount,
+				 QUEUE_T * theQueue )
+{
+	//
+	// Init queue.
+	// The values of each point are received at the point index of the buffer.
+	//
+	theQueue->buffer.resize( theCount );
+	theQueue->reads.clear();
+	theQueue->first.clear();
+	theQueue->runs.clear();
+
+	//
+	// Collect file reads.
+	//
+	for( size_t i = 0; i < theCount; )
+	{
+		//
+		// Get run.
+		//
+		size_t run = 1;
+		while( ((i + run) < theCount)
+			&& (theReads[ i + run ].band == theReads[ i ].band)
+			&& (theReads[ i + run ].offset == (theReads[ i ].offset + run)) )
+			run++;
+
+		//
+		// Check run.
+		//
+		const BAND_T & band = theDataset.bands[ theReads[ i ].band ];
+		UInt64 position = theReads[ i ].offset * band.pointSize;
+		if( (run > 1)
+		 && (((theReads[ i ].offset + run) > band.points)
+		  || ((position + (run * band.pointSize)) > band.size)) )
+			run = 1;
+
+		for( size_t j = 0; j < run; j++ )
+			theReads[ i + j ].done = false;
+		if( (band.fd < 0)
+		 || ((theReads[ i ].offset + run) > band.points)
+		 || ((position + (run * band.pointSize)) > band.size) )
+		{
+			i += run;
+			continue;															// =>
+		}
+
+		//
+		// Add read.
+		//
+		IO_READ_T read;
+		read.fd = band.fd;
+		read.buffer = &theQueue->buffer[ i ];
+		read.length = run * band.pointSize;
+		read.offset = position;
+		read.result = 0;
+		read.owner = NULL;
+		theQueue->reads.push_back( read );
+		theQueue->first.push_back( i );
+		theQueue->runs.push_back( run );
+
+		i += run;
+
+	} // Iterating reads.
+
+} // QueueBands.
+
+
+/*===================================================================================
+ *	CompleteBands																	*
+ *==================================================================================*/
+
+/**
+ * Complete queued band reads.
+ *
+ * This function will set the values of the provided reads from the performed file reads
+ * of the provided queue, see QueueBands(); reads whose file read failed are left not
+ * done.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param READ_T *			theReads			Reads.
+ * @param QUEUE_T *			theQueue			Performed file reads.
+ *
+ * @access public
+ * @return void
+ */
+void CompleteBands( const DATASET_T & theDataset, READ_T * theReads, QUEUE_T * theQueue )
+{
+	//
+	// Set values.
+	// Runs are decoded in place.
+	//
+	vector<SInt16> & buffer = theQueue->buffer;
+	for( size_t r = 0; r < theQueue->reads.size(); r++ )
+	{
+		if( theQueue->reads[ r ].result != (int) theQueue->reads[ r ].length )
+			continue;															// =>
+
+		size_t i = theQueue->first[ r ];
+		size_t run = theQueue->runs[ r ];
+		const BAND_T & band = theDataset.bands[ theReads[ i ].band ];
+		AddLayerReads( band.layer, theQueue->reads[ r ].length, 0 );
+		DecodeRow( &buffer[ i ], run, band.type, band.swapped );
+
+		for( size_t j = 0; j < run; j++ )
+		{
+			theReads[ i + j ].value = buffer[ i + j ];
+			theReads[ i + j ].done = true;
+		}
+
+	} // Iterating file reads.
+
+} // CompleteBands.
+
+
+/*===================================================================================
+ *	ReadBandSpans																	*
+ *==================================================================================*/
+
+/**
+ * Read unmapped band values.
+ *
+ * This function will perform the provided reads of unmapped bands with <i>pread</i>: the
+ * reads are sorted by band and offset, and the reads of a band whose points fall within
+ * <i>{@link kMaxSpan kMaxSpan}</i> bytes are served by a single call reading the whole
+ * span, such as the months of a cell in an interleaved cube or the points of a batch
+ * sharing a row. Reads of mapped bands are skipped.
+ *
+ * The sort buffer is kept from one call to the next: the process runs a single thread.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param READ_T *			theReads			Reads.
+ * @param size_t			theCount			Number of reads.
+ *
+ * @access private
+ * @return void
+ */
+static void ReadBandSpans( const DATASET_T & theDataset, READ_T * theReads,
+						   size_t theCount )
+{
+	//
+	// Sort reads.
+	//
+	static vector< pair< pair<int, UInt64>, size_t > > order;
+	order.clear();
+	for( size_t i = 0; i < theCount; i++ )
+	{
+		if( theDataset.bands[ theReads[ i ].band ].data == NULL )
+			order.push_back( make_pair( make_pair( theReads[ i ].band,
+												   theReads[ i ].offset ), i ) );
+	}
+	sort( order.begin(), order.end() );
+
+	//
+	// Read spans.
+	//
+	char buffer [ kMaxSpan ];
+	for( size_t first = 0; first < order.size(); )
+	{
+		//
+		// Get span.
+		//
+		int index = order[ first ].first.first;
+		const BAND_T & band = theDataset.bands[ index ];
+		UInt64 start = order[ first ].first.second * band.pointSize;
+		size_t last = first + 1;
+		while( (last < order.size())
+			&& (order[ last ].first.first == index)
+			&& ((((order[ last ].first.second + 1) * band.pointSize) - start)
+				<= kMaxSpan) )
+			last++;
+		UInt64 end = (order[ last - 1 ].first.second + 1) * band.pointSize;
+
+		//
+		// Read single points.
+		// Points of a span crossing the end of the band are read one by one.
+		//
+		if( (last == (first + 1))
+		 || (order[ last - 1 ].first.second >= band.points)
+		 || (end > band.size) )
+		{
+			for( size_t j = first; j < last; j++ )
+			{
+				READ_T & read = theReads[ order[ j ].second ];
+				read.done = ReadBand( theDataset, read.band, read.offset, &read.value );
+			}
+		}
+
+		//
+		// Read span.
+		//
+		else
+		{
+			AddLayerReads( band.layer, end - start, 1 );
+			bool done = (pread( band.fd, buffer, end - start, start )
+						 == (ssize_t) (end - start));
+			for( size_t j = first; j < last; j++ )
+			{
+				READ_T & read = theReads[ order[ j ].second ];
+				read.done = done;
+				if( done )
+					read.value = DecodeValue( buffer + ((read.offset * band.pointSize)
+														- start),
+											  band.type, band.swapped );
+			}
+		}
+
+		first = last;
+
+	} // Iterating spans.
+
+} // ReadBandSpans.
+
+
+/*===================================================================================
+ *	ReadBands																		*
+ *==================================================================================*/
+
+/**
+ * Read band values.
+ *
+ * This function will perform the provided list of reads in one pass: the mapped pages of
+ * all the reads are first prefetched and then copied, so that the reads of all layers and
+ * scenarios of a query are issued together; adjacent points of the same band are copied
+ * with a single read. Reads of unmapped bands are performed with <i>pread</i>, those of
+ * a band falling within a span sharing a single call, see ReadBandSpans(). If the
+ * dataset has a read queue, all the reads are submitted to it at once, see QueueBands().
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param READ_T *			theReads			Reads.
+ * @param size_t			theCount			Number of reads.
+ *
+ * @access public
+ * @return void
+ */
+void ReadBands( const DATASET_T & theDataset, READ_T * theReads, size_t theCount )
+{
+	//
+	// Handle read queue.
+	//
+	if( theDataset.ring != NULL )
+	{
+		QUEUE_T queue;
+		QueueBands( theDataset, theReads, theCount, &queue );
+		if( queue.reads.size() )
+			ReadRing( theDataset.ring, &queue.reads[ 0 ], queue.reads.size() );
+		CompleteBands( theDataset, theReads, &queue );
+		return;																	// ==>
+	}
+
+	//
+	// Prefetch mapped points.
+	//
+	for( size_t i = 0; i < theCount; i++ )
+	{
+		const BAND_T & band = theDataset.bands[ theReads[ i ].band ];
+		if( (band.data != NULL)
+		 && (theReads[ i ].offset < band.points) )
+			__builtin_prefetch( band.data + (theReads[ i ].offset * band.pointSize) );
+	}
+
+	//
+	// Read points.
+	// Runs of adjacent points of the same band, such as the months of a cell in an
+	// interleaved cube, are read at once; unmapped bands are read afterwards.
+	//
+	SInt16 values [ kMaxRun ];
+	bool unmapped = false;
+	for( size_t i = 0; i < theCount; )
+	{
+		if( theDataset.bands[ theReads[ i ].band ].data == NULL )
+		{
+			unmapped = true;
+			i++;
+			continue;															// =>
+		}
+		
+		//
+		// Get run.
+		//
+		size_t run = 1;
+		while( ((i + run) < theCount)
+			&& (run < kMaxRun)
+			&& (theReads[ i + run ].band == theReads[ i ].band)
+			&& (theReads[ i + run ].offset == (theReads[ i ].offset + run)) )
+			run++;
+
+		//
+		// Read run.
+		//
+		if( (run > 1)
+		 && ReadBandRow( theDataset, theReads[ i ].band, theReads[ i ].offset,
+						 run, values ) )
+		{
+			for( size_t j = 0; j < run; j++ )
+			{
+				theReads[ i + j ].value = values[ j ];
+				theReads[ i + j ].done = true;
+			}
+		}
+
+		//
+		// Read points.
+		// Points of a run crossing the end of the band are read one by one.
+		//
+		else
+		{
+			for( size_t j = 0; j < run; j++ )
+				theReads[ i + j ].done = ReadBand( theDataset, theReads[ i + j ].band,
+												   theReads[ i + j ].offset,
+												   &theReads[ i + j ].value );
+		}
+
+		i += run;
+
+	} // Iterating reads.
+
+	//
+	// Read unmapped points.
+	//
+	if( unmapped )
+		ReadBandSpans( theDataset, theReads, theCount );
+
+} // ReadBands.
+
+
+/*===================================================================================
+ *	PrewarmBands																	*
+ *==================================================================================*/
+
+/**
+ * Prewarm band pages.
+ *
+ * This function will ask the system to load into the page cache the file window of
+ * <i>{@link kPrewarmSize kPrewarmSize}</i> bytes containing each of the provided reads,
+ * without waiting for it: mapped bands are advised with <i>MADV_WILLNEED</i>, other
+ * bands with the file read-ahead advice. Each window is advised once.
+ *
+ * On Linux the advice is issued in the idle I/O class, so that the read-ahead does not
+ * compete with the reads of requests, and the previous class is restored.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const READ_T *	theReads			Reads.
+ * @param size_t			theCount			Number of reads.
+ *
+ * @access public
+ * @return void
+ */
+void PrewarmBands( const DATASET_T & theDataset, const READ_T * theReads, size_t theCount )
+{
+	//
+	// Collect windows.
+	//
+	vector< pair<int, UInt64> > windows;
+	windows.reserve( theCount );
+	for( size_t i = 0; i < theCount; i++ )
+	{
+		const BAND_T & band = theDataset.bands[ theReads[ i ].band ];
+		UInt64 position = theReads[ i ].offset * band.pointSize;
+		if( (band.fd >= 0)
+		 && (position < band.size) )
+			windows.push_back( make_pair( theReads[ i ].band, position / kPrewarmSize ) );
+	}
+	sort( windows.begin(), windows.end() );
+	windows.erase( unique( windows.begin(), windows.end() ), windows.end() );
+
+	//
+	// Lower I/O priority.
+	//
+#ifdef __linux__
+	int priority = syscall( SYS_ioprio_get, kIOPRIO_WhoProcess, 0 );
+	syscall( SYS_ioprio_set, kIOPRIO_WhoProcess, 0,
+			 kIOPRIO_ClassIdle << kIOPRIO_ClassShift );
+#endif
+
+	//
+	// Advise windows.
+	//
+	for( size_t i = 0; i < windows.size(); i++ )
+	{
+		const BAND_T & band = theDataset.bands[ windows[ i ].first ];
+		UInt64 start = windows[ i ].second * kPrewarmSize;
+		UInt64 length = ( (band.size - start) < kPrewarmSize )
+					  ? (band.size - start)
+					  : kPrewarmSize;
+		if( band.data != NULL )
+			madvise( (void *) (band.data + start), length, MADV_WILLNEED );
+		else
+		{
+#ifdef __linux__
+			posix_fadvise( band.fd, start, length, POSIX_FADV_WILLNEED );
+#else
+			struct radvisory advice;
+			advice.ra_offset = start;
+			advice.ra_count = length;
+			fcntl( band.fd, F_RDADVISE, &advice );
+#endif
+		}
+
+	} // Iterating windows.
+
+	//
+	// Restore I/O priority.
+	//
+#ifdef __linux__
+	if( priority >= 0 )
+		syscall( SYS_ioprio_set, kIOPRIO_WhoProcess, 0, priority );
+#endif
+
+} // PrewarmBands.
+
+
+/*===================================================================================
+ *	LockBands																		*
+ *==================================================================================*/
+
+/**
+ * Lock band pages.
+ *
+ * This function will lock in memory the mapped pages of the provided dataset within the
+ * provided budget in bytes, so that lookups never fault on them: the file windows of
+ * <i>{@link kPrewarmSize kPrewarmSize}</i> bytes containing the provided reads, the hot
+ * part of the data, are locked first, then whole bands, in dataset order, while they fit
+ * in the rest of the budget. Locking stops at the first failure, such as when the locked
+ * memory limit of the process is reached, and the part of the budget left unlocked is
+ * recorded in the dataset <i>shortfall</i>, with the failure in <i>errno</i>. Bands
+ * that are not mapped are skipped.
+ *
+ * The locked bytes of each band are recorded in the band; the function will return the
+ * locked bytes of the dataset.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param const READ_T *	theReads			Reads.
+ * @param size_t			theCount			Number of reads.
+ * @param UInt64			theBudget			Budget in bytes.
+ *
+ * @access public
+ * @return UInt64
+ */
+UInt64 LockBands( DATASET_T * theDataset, const READ_T * theReads, size_t theCount,
+				  UInt64 theBudget )
+{
+	//
+	// Collect windows.
+	//
+	vector< pair<int, UInt64> > windows;
+	windows.reserve( theCount );
+	for( size_t i = 0; i < theCount; i++ )
+	{
+		const BAND_T & band = theDataset->bands[ theReads[ i ].band ];
+		UInt64 position = theReads[ i ].offset * band.pointSize;
+		if( (band.data != NULL)
+		 && (band.locked < band.size)
+		 && (position < band.size) )
+			windows.push_back( make_pair( theReads[ i ].band, position / kPrewarmSize ) );
+	}
+	sort( windows.begin(), windows.end() );
+	windows.erase( unique( windows.begin(), windows.end() ), windows.end() );
+
+	//
+	// Count locked bytes.
+	//
+	UInt64 locked = 0;
+	for( size_t i = 0; i < theDataset->bands.size(); i++ )
+		locked += theDataset->bands[ i ].locked;
+
+	//
+	// Lock windows.
+	//
+	for( size_t i = 0; i < windows.size(); i++ )
+	{
+		BAND_T & band = theDataset->bands[ windows[ i ].first ];
+		UInt64 start = windows[ i ].second * kPrewarmSize;
+		UInt64 length = ( (band.size - start) < kPrewarmSize )
+					  ? (band.size - start)
+					  : kPrewarmSize;
+		if( (locked + length) > theBudget )
+			break;																// =>
+		if( mlock( band.data + start, length ) )
+		{
+			theDataset->shortfall = theBudget - locked;
+			return locked;														// ==>
+		}
+		band.locked += length;
+		locked += length;
+	}
+
+	//
+	// Lock bands.
+	// Locking the whole band again covers its windows.
+	//
+	for( size_t i = 0; i < theDataset->bands.size(); i++ )
+	{
+		BAND_T & band = theDataset->bands[ i ];
+		if( (band.data == NULL)
+		 || (band.locked == band.size)
+		 || ((locked + (band.size - band.locked)) > theBudget) )
+			continue;															// =>
+		if( mlock( band.data, band.size ) )
+		{
+			theDataset->shortfall = theBudget - locked;
+			break;																// =>
+		}
+		locked += band.size - band.locked;
+		band.locked = band.size;
+	}
+
+	return locked;																// ==>
+
+} // LockBands.
+
+
+/*===================================================================================
+ *	UnlockBands																		*
+ *==================================================================================*/
+
+/**
+ * Unlock band pages.
+ *
+ * This function will unlock the locked pages of the provided dataset, see LockBands(),
+ * and clear its shortfall; the pages stay mapped.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ *
+ * @access public
+ * @return void
+ */
+void UnlockBands( DATASET_T * theDataset )
+{
+	for( size_t i = 0; i < theDataset->bands.size(); i++ )
+	{
+		BAND_T & band = theDataset->bands[ i ];
+		if( band.locked )
+			munlock( band.data, band.size );
+		band.locked = 0;
+	}
+
+	theDataset->shortfall = 0;
+
+} // UnlockBands.
+
+
+/*===================================================================================
+ *	ReadBand																		*
+ *==================================================================================*/
+
+/**
+ * Read band value.
+ *
+ * This function will read the data point at the provided offset of the provided band,
+ * the value is returned in the host byte order. The function will return FALSE if the
+ * file is not available or if the offset is out of range.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const int			theBand				Band index.
+ * @param const UInt64		theOffset			Data point offset.
+ * @param SInt16 *			theValue			Receives value.
+ *
+ * @access public
+ * @return bool
+ */
+bool ReadBand( const DATASET_T & theDataset, const int theBand, const UInt64 theOffset,
+			   SInt16 * theValue )
+{
+	//
+	// Check offset.
+	//
+	const BAND_T & band = theDataset.bands[ theBand ];
+	UInt64 position = theOffset * band.pointSize;
+	if( (theOffset >= band.points)
+	 || ((position + band.pointSize) > band.size) )
+		return false;															// ==>
+
+	//
+	// Read value.
+	//
+	char buffer [2];
+	AddLayerReads( band.layer, band.pointSize, ( band.data != NULL ) ? 0 : 1 );
+	if( band.data != NULL )
+		memcpy( buffer, band.data + position, band.pointSize );
+	else if( pread( band.fd, buffer, band.pointSize, position ) != band.pointSize )
+		return false;															// ==>
+
+	//
+	// Decode value.
+	//
+	*theValue = DecodeValue( buffer, band.type, band.swapped );
+
+	return true;																// ==>
+
+} // ReadBand.
+
+
+/*===================================================================================
+ *	ReadBandRow																		*
+ *==================================================================================*/
+
+/**
+ * Read band row segment.
+ *
+ * This function will read the provided number of consecutive data points starting at the
+ * provided offset of the provided band, the values are copied as stored and decoded in
+ * place, see DecodeRow(). The function will return FALSE if the file is not available or
+ * if the segment is out of range.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const int			theBand				Band index.
+ * @param const UInt64		theOffset			First data point offset.
+ * @param const size_t		theCount			Number of data points.
+ * @param SInt16 *			theValues			Receives values.
+ *
+ * @access public
+ * @return bool
+ */
+bool ReadBandRow( const DATASET_T & theDataset, const int theBand, const UInt64 theOffset,
+				  const size_t theCount, SInt16 * theValues )
+{
+	//
+	// Check segment.
+	//
+	const BAND_T & band = theDataset.bands[ theBand ];
+	UInt64 position = theOffset * band.pointSize;
+	UInt64 length = theCount * band.pointSize;
+	if( ((theOffset + theCount) > band.points)
+	 || ((position + length) > band.size) )
+		return false;															// ==>
+
+	//
+	// Read values.
+	//
+	AddLayerReads( band.layer, length, ( band.data != NULL ) ? 0 : 1 );
+	if( band.data != NULL )
+		memcpy( theValues, band.data + position, length );
+	else if( pread( band.fd, theValues, length, position ) != (ssize_t) length )
+		return false;															// ==>
+
+	//
+	// Decode values.
+	//
+	DecodeRow( theValues, theCount, band.type, band.swapped );
+
+	return true;																// ==>
+
+} // ReadBandRow.
+
+
+/*===================================================================================
+ *	SetLayerRead																	*
+ *==================================================================================*/
+
+/**
+ * Set layer read.
+ *
+ * This function will fill the provided read with the band and offset of the provided
+ * month of the cell at the provided offset, starting from the first band of a layer; the
+ * months of a layer are either stored in consecutive bands, or adjacent in a single
+ * interleaved band.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const int			theBand				Layer first band.
+ * @param const int			theMonth			Month index [0 - 11], 0 for single bands.
+ * @param const UInt64		theOffset			Cell offset.
+ * @param READ_T *			theRead				Receives read.
+ *
+ * @access public
+ * @return void
+ */
+void SetLayerRead( const DATASET_T & theDataset, const int theBand, const int theMonth,
+				   const UInt64 theOffset, READ_T * theRead )
+{
+	const BAND_T & band = theDataset.bands[ theBand ];
+	if( band.months > 1 )
+	{
+		theRead->band = theBand;
+		theRead->offset = (theOffset * band.months) + theMonth;
+	}
+	else
+	{
+		theRead->band = theBand + theMonth;
+		theRead->offset = theOffset;
+	}
+	theRead->done = false;
+
+} // SetLayerRead.
+
+
+/*===================================================================================
+ *	ReadSeriesRow																	*
+ *==================================================================================*/
+
+/**
+ * Read monthly series row segment.
+ *
+ * This function will read the provided number of months of the provided number of
+ * consecutive cells starting at the provided cell offset, starting from the first band of
+ * a layer; the values are returned month-major: month <i>m</i> of cell <i>c</i> is at
+ * <i>m * count + c</i>. The function will return FALSE if any of the values could not be
+ * read.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const int			theBand				Layer first band.
+ * @param const int			theMonths			Number of months.
+ * @param const UInt64		theOffset			First cell offset.
+ * @param const size_t		theCount			Number of cells.
+ * @param SInt16 *			theValues			Receives values.
+ *
+ * @access public
+ * @return bool
+ */
+bool ReadSeriesRow( const DATASET_T & theDataset, const int theBand, const int theMonths,
+					const UInt64 theOffset, const size_t theCount, SInt16 * theValues )
+{
+	//
+	// Handle month bands.
+	//
+	const BAND_T & cube = theDataset.bands[ theBand ];
+	if( cube.months <= 1 )
+	{
+		for( int month = 0; month < theMonths; month++ )
+		{
+			if( ! ReadBandRow( theDataset, theBand + month, theOffset, theCount,
+							   theValues + (month * theCount) ) )
+				return false;													// ==>
+		}
+
+		return true;															// ==>
+	}
+
+	//
+	// Read cube.
+	//
+	if( cube.months < theMonths )
+		return false;															// ==>
+
+	vector<SInt16> buffer( theCount * cube.months );
+	if( ! ReadBandRow( theDataset, theBand, theOffset * cube.months,
+					   theCount * cube.months, &buffer[ 0 ] ) )
+		return false;															// ==>
+
+	//
+	// Transpose cube.
+	//
+	for( size_t cell = 0; cell < theCount; cell++ )
+	{
+		for( int month = 0; month < theMonths; month++ )
+			theValues[ (month * theCount) + cell ]
+				= buffer[ (cell * cube.months) + month ];
+	}
+
+	return true;																// ==>
+
+} // ReadSeriesRow.
+
+
+/*===================================================================================
+ *	RepackLayer																		*
+ *==================================================================================*/
+
+/**
+ * Repack layer.
+ *
+ * This function will write the monthly series of the provided layer of the base dataset
+ * into a band interleaved by pixel cube: the months of each cell are stored adjacent, so
+ * that the series of a cell is read with a single access. The cube is written one grid
+ * row at a time, in the host byte order; the layer can then be declared in the manifest
+ * with <i>layout = bip</i>.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const int			theLayer			Layer index.
+ * @param const string &	thePath				Cube file path.
+ * @param string *			theMessage			Receives error message.
+ *
+ * @access public
+ * @return int
+ */
+int RepackLayer( const DATASET_T & theDataset, const int theLayer, const string & thePath,
+				 string * theMessage )
+{
+	//
+	// Check layer.
+	//
+	const LAYER_T & layer = theDataset.layers[ theLayer ];
+	if( (! layer.months)
+	 || (layer.band < 0) )
+	{
+		*theMessage = "Layer [" + layer.name + "] has no monthly series";
+		return kERROR_INVALID_FEATURE_REFERENCE;								// ==>
+	}
+	if( layer.interleaved )
+	{
+		*theMessage = "Layer [" + layer.name + "] is already interleaved";
+		return kERROR_INVALID_FEATURE_REFERENCE;								// ==>
+	}
+
+	//
+	// Create file.
+	//
+	int fd = open( thePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if( fd < 0 )
+	{
+		*theMessage = "Unable to create [" + thePath + "]";
+		return kERROR_REPACK_FAILED;											// ==>
+	}
+
+	//
+	// Init buffers.
+	//
+	const BAND_T & band = theDataset.bands[ layer.band ];
+	size_t width = layer.grid.countX;
+	size_t size = width * layer.months * band.pointSize;
+	vector<SInt16> values( width * layer.months );
+	vector<char> cube( size );
+
+	//
+	// Write rows.
+	//
+	for( UInt64 row = 0; row < layer.grid.countY; row++ )
+	{
+		//
+		// Read row.
+		//
+		if( ! ReadSeriesRow( theDataset, layer.band, layer.months, row * width, width,
+							 &values[ 0 ] ) )
+		{
+			ostringstream error;
+			error << "Unable to read row " << row << " of layer [" << layer.name << "]";
+			*theMessage = error.str();
+			close( fd );
+			return kERROR_REPACK_FAILED;										// ==>
+		}
+
+		//
+		// Interleave months.
+		//
+		for( size_t cell = 0; cell < width; cell++ )
+		{
+			for( int month = 0; month < layer.months; month++ )
+			{
+				SInt16 value = values[ (month * width) + cell ];
+				size_t point = (cell * layer.months) + month;
+				if( band.pointSize == 1 )
+					cube[ point ] = (char) value;
+				else
+					memcpy( &cube[ point * 2 ], &value, 2 );
+			}
+		}
+
+		//
+		// Write row.
+		//
+		size_t done = 0;
+		while( done < size )
+		{
+			ssize_t count = write( fd, &cube[ done ], size - done );
+			if( count <= 0 )
+			{
+				*theMessage = "Unable to write [" + thePath + "]";
+				close( fd );
+				return kERROR_REPACK_FAILED;									// ==>
+			}
+			done += count;
+		}
+
+	} // Iterating rows.
+
+	//
+	// Close file.
+	//
+	if( close( fd ) )
+	{
+		*theMessage = "Unable to write [" + thePath + "]";
+		return kERROR_REPACK_FAILED;											// ==>
+	}
+
+	return kERROR_OK;															// ==>
+
+} // RepackLayer.
+
+
+/*===================================================================================
+ *	MakeParent																		*
+ *==================================================================================*/
+
+/**
+ * Create parent directories.
+ *
+ * This function will create the missing directories of the provided file path, the
+ * function returns FALSE if a directory could not be created.
+ *
+ * @param const string &	thePath				File path.
+ *
+ * @access private
+ * @return bool
+ */
+static bool MakeParent( const string & thePath )
+{
+	for( size_t slash = thePath.find( '/', 1 );
+		 slash != string::npos;
+		 slash = thePath.find( '/', slash + 1 ) )
+	{
+		string directory = thePath.substr( 0, slash );
+		if( mkdir( directory.c_str(), 0755 )
+		 && (errno != EEXIST) )
+			return false;														// ==>
+	}
+
+	return true;																// ==>
+
+} // MakeParent.
+
+
+/*===================================================================================
+ *	WriteAll																		*
+ *==================================================================================*/
+
+/**
+ * Write buffer.
+ *
+ * This function will write the provided buffer to the provided file, retrying short
+ * writes; the function returns FALSE if the file could not be written.
+ *
+ * @param int				theFile				File descriptor.
+ * @param const void *		theBuffer			Buffer.
+ * @param size_t			theSize				Buffer size.
+ *
+ * @access private
+ * @return bool
+ */
+static bool WriteAll( int theFile, const void * theBuffer, size_t theSize )
+{
+	const char * buffer = (const char *) theBuffer;
+	size_t done = 0;
+	while( done < theSize )
+	{
+		ssize_t count = write( theFile, buffer + done, theSize - done );
+		if( count <= 0 )
+			return false;														// ==>
+		done += count;
+	}
+
+	return true;																// ==>
+
+} // WriteAll.
+
+
+/*===================================================================================
+ *	GetSyntheticElevation															*
+ *==================================================================================*/
+
+/**
+ * Get synthetic elevation.
+ *
+ * This function will return the synthetic elevation in meters of the provided
+ * coordinates, from its latitude term, <i>sin( latitude * 0.12 + 0.5 )</i>, and its
+ * longitude term, <i>cos( longitude * 0.09 )</i>; cells below zero are sea, which covers
+ * about two thirds of the globe, as on the earth.
+ *
+ * @param double			theLatitudeTerm		Latitude term.
+ * @param double			theLongitudeTerm	Longitude term.
+ *
+ * @access private
+ * @return double
+ */
+static inline double GetSyntheticElevation( double theLatitudeTerm,
+											double theLongitudeTerm )
+{
+	return (3000 * theLatitudeTerm * theLongitudeTerm) - 800;					// ==>
+
+} // GetSyntheticElevation.
+
+
+/*===================================================================================
+ *	WriteSyntheticHeader															*
+ *==================================================================================*/
+
+/**
+ * Write synthetic layer header.
+ *
+ * This function will write the ESRI <i>.hdr</i> file of the provided <i>.bil</i> file,
+ * declaring the grid of the provided layer, 16 bit samples in the host byte order and
+ * the sea token as missing value.
+ *
+ * @param const string &	thePath				Layer file path.
+ * @param const WORLDCLIM_T &	theLayer		Layer.
+ * @param UInt64			theRows				Number of rows.
+ * @param UInt64			theColumns			Number of columns.
+ *
+ * @access private
+ * @return bool
+ */
+static bool WriteSyntheticHeader( const string & thePath, const WORLDCLIM_T & theLayer,
+								  UInt64 theRows, UInt64 theColumns )
+{
+	UInt16 probe = 1;
+	bool little = (*((UInt8 *) &probe) == 1);
+	double unitY = (theLayer.latMax - theLayer.latMin) / theRows;
+	double unitX = (theLayer.lonMax - theLayer.lonMin) / theColumns;
+
+	ofstream header( (thePath.substr( 0, thePath.rfind( '.' ) ) + ".hdr").c_str() );
+	header.precision( 12 );
+	header << "BYTEORDER      " << (( little ) ? "I" : "M") << '\n'
+		   << "LAYOUT         BIL\n"
+		   << "NROWS          " << theRows << '\n'
+		   << "NCOLS          " << theColumns << '\n'
+		   << "NBANDS         1\n"
+		   << "NBITS          16\n"
+		   << "BANDROWBYTES   " << (theColumns * 2) << '\n'
+		   << "TOTALROWBYTES  " << (theColumns * 2) << '\n'
+		   << "BANDGAPBYTES   0\n"
+		   << "NODATA         " << kSeaToken << '\n'
+		   << "ULXMAP         " << (theLayer.lonMin + (unitX / 2)) << '\n'
+		   << "ULYMAP         " << (theLayer.latMax - (unitY / 2)) << '\n'
+		   << "XDIM           " << unitX << '\n'
+		   << "YDIM           " << unitY << '\n';
+	header.close();
+
+	return (bool) header;														// ==>
+
+} // WriteSyntheticHeader.
+
+
+/*===================================================================================
+ *	GenerateDataset																	*
+ *==================================================================================*/
+
+/**
+ * Generate synthetic dataset.
+ *
+ * This function will write into the provided directory a synthetic dataset with the
+ * layout of the built-in tables, <i>{@link kGTOPO30_Tiles kGTOPO30_Tiles}</i> and
+ * <i>{@link kWORLDCLIM_Tiles kWORLDCLIM_Tiles}</i>, with grids of
+ * <i>theScale</i> times the 30 seconds resolution, along with a manifest declaring them:
+ * the directory can then be queried and benchmarked as the real dataset, of which a
+ * scale of 1 has the size.
+ *
+ * Values are smooth functions of the coordinates: a terrain whose negative half is sea,
+ * temperatures falling with latitude and elevation with a seasonal cycle opposite in
+ * the two hemispheres, and precipitation varying with latitude and longitude; the
+ * bioclimatic variables are computed from the monthly series with ComputeBioclim(). The
+ * values are reproducible, so benchmarks on datasets of the same scale compare.
+ *
+ * GTOPO-30 elevations are written big-endian, as in the real tiles, WORLDCLIM layers in
+ * the host byte order, declared in their <i>.hdr</i> files. Each tile is written to its
+ * own files, the function fails if two tiles share a name.
+ *
+ * @param const string &	theDirectory		Base directory.
+ * @param const int			theScale			Resolution divisor.
+ * @param string *			theMessage			Receives error message.
+ *
+ * @access public
+ * @return int
+ */
+int GenerateDataset( const string & theDirectory, const int theScale, string * theMessage )
+{
+	ostringstream manifest;
+	manifest << ";\n; Synthetic dataset, " << (30 * theScale) << " seconds grid.\n;\n";
+
+	//
+	// Write tiles.
+	// Each tile has its own files, tiles sharing a name would overwrite each other.
+	//
+	vector<string> written;
+	for( int tile = 0; tile < kGTOPO30_TilesCount; tile++ )
+	{
+		//
+		// Declare tile.
+		//
+		const TILES_T & entry = kGTOPO30_Tiles[ tile ];
+		const AREA_T & area = entry.area;
+		UInt64 rows = entry.countY / theScale;
+		UInt64 columns = entry.countX / theScale;
+		manifest << "\n[tile " << entry.name << "]\n"
+				 << "extent = " << area.latMin << ' ' << area.latMax << ' '
+				 << area.lonMin << ' ' << area.lonMax << '\n'
+				 << "grid = " << rows << ' ' << columns << '\n';
+		if( find( written.begin(), written.end(), entry.name ) != written.end() )
+		{
+			*theMessage = "Duplicate tile [" + string( entry.name ) + "]";
+			return kERROR_GENERATE_FAILED;										// ==>
+		}
+		written.push_back( entry.name );
+
+		//
+		// Create files.
+		//
+		string path = theDirectory + entry.path;
+		int dem = ( MakeParent( path ) )
+				? open( (path + ".DEM").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 )
+				: -1;
+		int src = ( dem >= 0 )
+				? open( (path + ".SRC").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 )
+				: -1;
+		if( src < 0 )
+		{
+			if( dem >= 0 )
+				close( dem );
+			*theMessage = "Unable to create [" + path + "]";
+			return kERROR_GENERATE_FAILED;										// ==>
+		}
+
+		//
+		// Write rows.
+		// Elevations are big-endian.
+		//
+		double unitY = (area.latMax - area.latMin) / rows;
+		double unitX = (area.lonMax - area.lonMin) / columns;
+		vector<double> terms( columns );
+		for( UInt64 column = 0; column < columns; column++ )
+			terms[ column ] = cos( (area.lonMin + ((column + 0.5) * unitX)) * 0.09 );
+		vector<UInt16> elevations( columns );
+		vector<UInt8> sources( columns );
+		bool failed = false;
+		for( UInt64 row = 0; (row < rows) && (! failed); row++ )
+		{
+			double term = sin( ((area.latMax - ((row + 0.5) * unitY)) * 0.12) + 0.5 );
+			for( UInt64 column = 0; column < columns; column++ )
+			{
+				double elevation = GetSyntheticElevation( term, terms[ column ] );
+				UInt16 value = ( elevation > 0 ) ? (UInt16) elevation
+												 : (UInt16) kSeaToken;
+				elevations[ column ] = (UInt16) ((value << 8) | (value >> 8));
+				sources[ column ] = ( elevation > 0 ) ? (1 + ((column / 64) % 9)) : 0;
+			}
+			failed = ((! WriteAll( dem, &elevations[ 0 ], columns * 2 ))
+				   || (! WriteAll( src, &sources[ 0 ], columns )));
+		}
+		failed = (close( dem ) != 0) || failed;
+		failed = (close( src ) != 0) || failed;
+		if( failed )
+		{
+			*theMessage = "Unable to write [" + path + "]";
+			return kERROR_GENERATE_FAILED;										// ==>
+		}
+
+	} // Iterating tiles.
+
+	//
+	// Create layer files.
+	// All layers share the grid of the first one.
+	//
+	const WORLDCLIM_T & grid = kWORLDCLIM_Tiles[ 0 ];
+	UInt64 rows = grid.countY / theScale;
+	UInt64 columns = grid.countX / theScale;
+	vector<int> files;
+	vector<int> sources;
+	string message;
+	for( int layer = 0; (layer < kWORLDCLIM_FilesCount) && message.empty(); layer++ )
+	{
+		//
+		// Declare layer.
+		//
+		const WORLDCLIM_T & entry = kWORLDCLIM_Tiles[ layer ];
+		string name = entry.name;
+		manifest << "\n[layer " << entry.name << "]\n"
+				 << "source = " << entry.source << '\n'
+				 << "months = " << entry.months << '\n'
+				 << "extent = " << entry.latMin << ' ' << entry.latMax << ' '
+				 << entry.lonMin << ' ' << entry.lonMax << '\n'
+				 << "grid = " << rows << ' ' << columns << '\n'
+				 << "type = int16\n"
+				 << "path = " << entry.path << '\n';
+
+		//
+		// Resolve source series.
+		// Sources are 0 for elevation, 1 to 12 for mean, 13 to 24 for minimum, 25 to 36
+		// for maximum temperatures, 37 to 48 for precipitation, 49 to 67 for bioclimatic
+		// variables.
+		//
+		int source = 0;
+		if( name == "tmean" )
+			source = 1;
+		else if( name == "tmin" )
+			source = 13;
+		else if( name == "tmax" )
+			source = 25;
+		else if( name == "prec" )
+			source = 37;
+		else if( name.compare( 0, 3, "bio" ) == 0 )
+			source = 48 + atoi( name.c_str() + 3 );
+
+		//
+		// Open month files.
+		//
+		int months = ( entry.months ) ? entry.months : 1;
+		for( int month = 1; month <= months; month++ )
+		{
+			char month_path [ 1024 ];
+			snprintf( month_path, sizeof( month_path ), entry.path, month );
+			string file = theDirectory + month_path;
+			int fd = ( MakeParent( file )
+					&& WriteSyntheticHeader( file, entry, rows, columns ) )
+				   ? open( file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 )
+				   : -1;
+			if( fd < 0 )
+			{
+				message = "Unable to create [" + file + "]";
+				break;															// =>
+			}
+			files.push_back( fd );
+			sources.push_back( ( entry.months ) ? (source + month - 1) : source );
+		}
+
+	} // Iterating layers.
+
+	//
+	// Declare derived layers.
+	//
+	static const char * const kinds [] =
+		{ "", "bioclim", "gdd", "pet", "aridity", "frost" };
+	for( int layer = 0; layer < kDERIVED_LayersCount; layer++ )
+	{
+		manifest << "\n[layer " << kDERIVED_Layers[ layer ].name << "]\n"
+				 << "source = " << kDERIVED_Layers[ layer ].source << '\n'
+				 << "derived = " << kinds[ kDERIVED_Layers[ layer ].kind ] << '\n';
+		if( kDERIVED_Layers[ layer ].kind == kDERIVED_GDD )
+			manifest << "base = " << kDERIVED_Layers[ layer ].base << '\n';
+	}
+
+	//
+	// Write layer rows.
+	// All the series of a row are computed at once, then written to each file.
+	//
+	double unitY = (grid.latMax - grid.latMin) / rows;
+	double unitX = (grid.lonMax - grid.lonMin) / columns;
+	vector<double> terms( columns );
+	for( UInt64 column = 0; column < columns; column++ )
+		terms[ column ] = cos( (grid.lonMin + ((column + 0.5) * unitX)) * 0.09 );
+	vector<SInt16> series( 68 * columns );
+	vector<float> bioclim( kBIOCLIM_Count * columns );
+	for( UInt64 row = 0; (row < rows) && message.empty(); row++ )
+	{
+		//
+		// Compute monthly series.
+		//
+		double latitude = grid.latMax - ((row + 0.5) * unitY);
+		double term = sin( (latitude * 0.12) + 0.5 );
+		double hemisphere = ( latitude >= 0 ) ? 1 : -1;
+		for( UInt64 column = 0; column < columns; column++ )
+		{
+			double longitude = grid.lonMin + ((column + 0.5) * unitX);
+			double elevation = GetSyntheticElevation( term, terms[ column ] );
+			series[ column ] = ( elevation > 0 ) ? (SInt16) elevation : kSeaToken;
+			for( int month = 0; month < 12; month++ )
+			{
+				double season = hemisphere * 3 * fabs( latitude )
+							  * cos( 2 * M_PI * (month - 6) / 12 );
+				double mean = 280 - (5 * fabs( latitude )) - (0.065 * elevation) + season;
+				double range = 40 + fabs( latitude );
+				double rain = 60 + (120 * cos( latitude * 0.04 ))
+							+ (50 * sin( (2 * M_PI * month / 12) + (longitude * 0.05) ));
+				series[ ((1 + month) * columns) + column ] = (SInt16) mean;
+				series[ ((13 + month) * columns) + column ] = (SInt16) (mean - range);
+				series[ ((25 + month) * columns) + column ] = (SInt16) (mean + range);
+				series[ ((37 + month) * columns) + column ] = ( rain > 0 ) ? (SInt16) rain
+																			: 0;
+			}
+		}
+
+		//
+		// Compute bioclimatic variables.
+		//
+		ComputeBioclim( &series[ 13 * columns ], &series[ 25 * columns ],
+						&series[ 37 * columns ], columns, &bioclim[ 0 ] );
+		for( size_t i = 0; i < bioclim.size(); i++ )
+		{
+			float value = bioclim[ i ];
+			if( value > 32767 )
+				value = 32767;
+			else if( value < -32767 )
+				value = -32767;
+			series[ (49 * columns) + i ] = (SInt16) lrintf( value );
+		}
+
+		//
+		// Mask sea.
+		//
+		for( UInt64 column = 0; column < columns; column++ )
+		{
+			if( series[ column ] == kSeaToken )
+			{
+				for( int source = 1; source < 68; source++ )
+					series[ (source * columns) + column ] = kSeaToken;
+			}
+		}
+
+		//
+		// Write row.
+		//
+		for( size_t file = 0; file < files.size(); file++ )
+		{
+			if( ! WriteAll( files[ file ], &series[ sources[ file ] * columns ],
+							columns * 2 ) )
+			{
+				message = "Unable to write synthetic layers";
+				break;															// =>
+			}
+		}
+
+	} // Iterating rows.
+
+	//
+	// Close files.
+	//
+	for( size_t file = 0; file < files.size(); file++ )
+	{
+		if( close( files[ file ] )
+		 && message.empty() )
+			message = "Unable to write synthetic layers";
+	}
+	if( message.size() )
+	{
+		*theMessage = message;
+		return kERROR_GENERATE_FAILED;											// ==>
+	}
+
+	//
+	// Write manifest.
+	//
+	string path = theDirectory + kManifestName;
+	ofstream file( path.c_str() );
+	file << manifest.str();
+	file.close();
+	if( ! file )
+	{
+		*theMessage = "Unable to write [" + path + "]";
+		return kERROR_GENERATE_FAILED;											// ==>
+	}
+
+	return kERROR_OK;															// ==>
+
+} // GenerateDataset.
+
+
+/*===================================================================================
+ *	WriteNativeHeader																*
+ *==================================================================================*/
+
+/**
+ * Write native header.
+ *
+ * This function will write to the provided file a copy of the provided band header, or
+ * a new header if it does not exist, declaring the host byte order; the function returns
+ * FALSE if the file could not be written.
+ *
+ * @param const string &	theHeader			Header path.
+ * @param const string &	thePath				Output path.
+ *
+ * @access private
+ * @return bool
+ */
+static bool WriteNativeHeader( const string & theHeader, const string & thePath )
+{
+	//
+	// Copy entries.
+	//
+	ostringstream header;
+	header << "BYTEORDER      " << (( kHOST_BigEndian ) ? "M" : "I") << '\n';
+	ifstream input( theHeader.c_str() );
+	string line;
+	while( getline( input, line ) )
+	{
+		string key;
+		istringstream stream( line );
+		stream >> key;
+		transform( key.begin(), key.end(), key.begin(), ::toupper );
+		if( key != "BYTEORDER" )
+			header << line << '\n';
+	}
+
+	//
+	// Write header.
+	//
+	ofstream output( thePath.c_str() );
+	output << header.str();
+	output.close();
+
+	return (bool) output;														// ==>
+
+} // WriteNativeHeader.
+
+
+/*===================================================================================
+ *	ConvertDataset																	*
+ *==================================================================================*/
+
+/**
+ * Convert dataset byte order.
+ *
+ * This function will rewrite the files of the provided dataset, of all scenarios, that
+ * are stored in the byte order opposite to the host byte order, so that their values
+ * are read without conversion; the number of converted files is returned in the
+ * provided counter.
+ *
+ * Each file is converted into a copy which then replaces it, after its header is
+ * replaced by one declaring the new byte order; if the file cannot be replaced the old
+ * header is restored, so that a failed conversion leaves the file as it was.
+ * Files listed more than once are converted once.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param size_t *			theCount			Receives number of converted files.
+ * @param string *			theMessage			Receives error message.
+ *
+ * @access public
+ * @return int
+ */
+int ConvertDataset( const DATASET_T & theDataset, size_t * theCount, string * theMessage )
+{
+	vector<string> converted;
+	vector<SInt16> buffer( kConvertSize / 2 );
+	*theCount = 0;
+	for( size_t i = 0; i < theDataset.bands.size(); i++ )
+	{
+		//
+		// Skip native files.
+		//
+		const BAND_T & band = theDataset.bands[ i ];
+		if( (! band.swapped)
+		 || (band.fd < 0)
+		 || (find( converted.begin(), converted.end(), band.path ) != converted.end()) )
+			continue;															// =>
+		converted.push_back( band.path );
+
+		//
+		// Create copies.
+		//
+		string header = GetHeaderPath( band.path );
+		string copy = band.path + ".native";
+		int fd = ( WriteNativeHeader( header, header + ".native" ) )
+			   ? open( copy.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 )
+			   : -1;
+		if( fd < 0 )
+		{
+			unlink( (header + ".native").c_str() );
+			*theMessage = "Unable to create [" + copy + "]";
+			return kERROR_CONVERT_FAILED;										// ==>
+		}
+
+		//
+		// Convert blocks.
+		//
+		bool failed = false;
+		for( UInt64 position = 0; (position < band.size) && (! failed); )
+		{
+			size_t length = ( (band.size - position) < kConvertSize )
+						  ? (size_t) (band.size - position)
+						  : kConvertSize;
+			failed = (pread( band.fd, &buffer[ 0 ], length, position )
+					  != (ssize_t) length);
+			if( ! failed )
+			{
+				SwapRow( (UInt16 *) &buffer[ 0 ], length / 2 );
+				failed = ! WriteAll( fd, &buffer[ 0 ], length );
+			}
+			position += length;
+		}
+		failed = (close( fd ) != 0) || failed;
+
+		//
+		// Replace header.
+		// The current header is kept as a link until the data file is replaced.
+		//
+		string backup = header + ".swapped";
+		bool exists = ! access( header.c_str(), F_OK );
+		unlink( backup.c_str() );
+		if( failed
+		 || (exists && link( header.c_str(), backup.c_str() ))
+		 || rename( (header + ".native").c_str(), header.c_str() ) )
+		{
+			unlink( copy.c_str() );
+			unlink( (header + ".native").c_str() );
+			unlink( backup.c_str() );
+			*theMessage = "Unable to convert [" + band.path + "]";
+			return kERROR_CONVERT_FAILED;										// ==>
+		}
+
+		//
+		// Replace data.
+		// On failure the header is restored, it must match the data.
+		//
+		if( rename( copy.c_str(), band.path.c_str() ) )
+		{
+			if( exists )
+				rename( backup.c_str(), header.c_str() );
+			else
+				unlink( header.c_str() );
+			unlink( copy.c_str() );
+			*theMessage = "Unable to convert [" + band.path + "]";
+			return kERROR_CONVERT_FAILED;										// ==>
+		}
+		unlink( backup.c_str() );
+		(*theCount)++;
+
+	} // Iterating bands.
+
+	return kERROR_OK;															// ==>
+
+} // ConvertDataset.
@@ -0,0 +1,187 @@
+/**
+ * Dataset registry definitions.
+ *
+ * This file contains the dataset registry declarations: the registry describes the
+ * GTOPO-30 tiles and the WORLDCLIM layers, it is loaded once at startup either from a
+ * manifest file or from the built-in tables and all the referenced files are opened and
+ * mapped once.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Types.h"
+
+using namespace std;
+
+#include "Structures.h"
+
+/**
+ * LoadDataset.
+ *
+ * Load dataset registry and open files.
+ */
+int LoadDataset( const string & theDirectory, const string & theManifest,
+				 const int theIO, const bool doHuge, DATASET_T * theDataset,
+				 string * theMessage );
+
+/**
+ * CloseDataset.
+ *
+ * Unmap and close dataset files.
+ */
+void CloseDataset( DATASET_T * theDataset );
+
+/**
+ * FindLayer.
+ *
+ * Find layer by name.
+ */
+int FindLayer( const DATASET_T & theDataset, const string & theName );
+
+/**
+ * FindScenario.
+ *
+ * Find scenario by name.
+ */
+int FindScenario( const DATASET_T & theDataset, const string & theName );
+
+/**
+ * SameGrid.
+ *
+ * Check whether two grids have the same geometry.
+ */
+bool SameGrid( const GRID_T & theGrid, const GRID_T & theOther );
+
+/**
+ * FindTile.
+ *
+ * Find elevation tile of coordinates.
+ */
+int FindTile( const DATASET_T & theDataset, double theLatitude, double theLongitude );
+
+/**
+ * GetCellOffset.
+ *
+ * Get data point offset of coordinates in grid.
+ */
+UInt64 GetCellOffset( const GRID_T & theGrid, double theLatitude, double theLongitude,
+					  UInt64 * theRow, UInt64 * theColumn );
+
+/**
+ * GetCellOffsets.
+ *
+ * Get data point offsets of a set of coordinates in grid.
+ */
+void GetCellOffsets( const GRID_T & theGrid, const double * theLatitudes,
+					 const double * theLongitudes, size_t theCount, UInt64 * theOffsets );
+
+/**
+ * ReadBands.
+ *
+ * Read a list of data points.
+ */
+void ReadBands( const DATASET_T & theDataset, READ_T * theReads, size_t theCount );
+
+/**
+ * QueueBands.
+ *
+ * Convert a list of data points reads into file reads.
+ */
+void QueueBands( const DATASET_T & theDataset, READ_T * theReads, size_t theCount,
+				 QUEUE_T * theQueue );
+
+/**
+ * CompleteBands.
+ *
+ * Set data points from performed file reads.
+ */
+void CompleteBands( const DATASET_T & theDataset, READ_T * theReads, QUEUE_T * theQueue );
+
+/**
+ * PrewarmBands.
+ *
+ * Load the pages of a list of data points into the page cache.
+ */
+void PrewarmBands( const DATASET_T & theDataset, const READ_T * theReads, size_t theCount );
+
+/**
+ * LockBands.
+ *
+ * Lock the mapped pages of a dataset in memory within a budget.
+ */
+UInt64 LockBands( DATASET_T * theDataset, const READ_T * theReads, size_t theCount,
+				  UInt64 theBudget );
+
+/**
+ * UnlockBands.
+ *
+ * Unlock the locked pages of a dataset.
+ */
+void UnlockBands( DATASET_T * theDataset );
+
+/**
+ * ReadBand.
+ *
+ * Read a data point from a band.
+ */
+bool ReadBand( const DATASET_T & theDataset, const int theBand, const UInt64 theOffset,
+			   SInt16 * theValue );
+
+/**
+ * ReadBandRow.
+ *
+ * Read consecutive data points from a band.
+ */
+bool ReadBandRow( const DATASET_T & theDataset, const int theBand, const UInt64 theOffset,
+				  const size_t theCount, SInt16 * theValues );
+
+/**
+ * SetLayerRead.
+ *
+ * Set the read of a layer month.
+ */
+void SetLayerRead( const DATASET_T & theDataset, const int theBand, const int theMonth,
+				   const UInt64 theOffset, READ_T * theRead );
+
+/**
+ * ReadSeriesRow.
+ *
+ * Read the monthly series of consecutive cells.
+ */
+bool ReadSeriesRow( const DATASET_T & theDataset, const int theBand, const int theMonths,
+					const UInt64 theOffset, const size_t theCount, SInt16 * theValues );
+
+/**
+ * RepackLayer.
+ *
+ * Write a layer monthly series into an interleaved cube.
+ */
+int RepackLayer( const DATASET_T & theDataset, const int theLayer, const string & thePath,
+				 string * theMessage );
+
+/**
+ * GenerateDataset.
+ *
+ * Write a synthetic dataset.
+ */
+int GenerateDataset( const string & theDirectory, const int theScale, string * theMessage );
+
+/**
+ * ConvertDataset.
+ *
+ * Convert the dataset files to the host byte order.
+ */
+int ConvertDataset( const DATASET_T & theDataset, size_t * theCount, string * theMessage );
+
+#endif // REGISTRY_H
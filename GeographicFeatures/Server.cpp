@@ -0,0 +1,1487 @@
+/**
+ * HTTP server.
+ *
+ * This file contains the embedded HTTP/1.1 server, it replaces the script bridge which
+ * started a shell and a new process for each request: the dataset is loaded once and the
+ * requests are served by a single event loop, based on <i>epoll</i> on Linux and on
+ * <i>kqueue</i> elsewhere.
+ *
+ * Sockets are non blocking; each connection buffers its input until complete requests are
+ * available, all the complete requests are handled in order, so that pipelined requests
+ * are answered in sequence, and the responses are appended to the connection output.
+ * Connections are persistent unless the client asks otherwise or uses HTTP/1.0 without
+ * <i>keep-alive</i>, idle connections are closed after
+ * <i>{@link kSERVER_IdleTimeout kSERVER_IdleTimeout}</i> seconds.
+ *
+ * The server only parses the protocol: the handler receives the method, path, query
+ * string and body, and fills the status, content type and body of the response.
+ * Request bodies must have a <i>Content-Length</i>, chunked requests are rejected.
+ *
+ * The handler may also leave a response pending, to be completed later by the poll
+ * function, which is called when a descriptor provided to RunServer() is readable: the
+ * responses of a connection are queued in request order and only sent once all the
+ * preceding responses are complete, so that the event loop keeps serving other requests
+ * while the data of a pending one is read.
+ *
+ * Parsed requests are not handled at once: they wait for admission in a queue per
+ * client and priority, and are handed to the handler while fewer than the configured
+ * number of requests are in progress; interactive requests go first and clients are
+ * served in turn, so that one client cannot starve the others. Requests exceeding the
+ * queue size, or waiting longer than the deadline, are answered with <i>503</i> and a
+ * <i>Retry-After</i> estimated from the recent throughput, so that bursts are shed
+ * instead of piling up.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Server.cpp										*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * System includes.
+ */
+#include <map>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#endif
+
+/**
+ * Local includes.
+ */
+#include "Errors.h"											// Error codes.
+#include "Server.h"											// HTTP server.
+#include "Stats.h"											// Statistics.
+
+/**
+ * Maximum events.
+ *
+ * This constant holds the maximum number of events handled per loop iteration.
+ */
+static const int kMaxEvents = 256;
+
+/**
+ * Read size.
+ *
+ * This constant holds the size of the socket read buffer.
+ */
+static const size_t kReadSize = 16384;
+
+/**
+ * Maximum pending output.
+ *
+ * This constant holds the size of the pending output above which a connection stops
+ * being read and its requests handled, until the client reads the responses.
+ */
+static const size_t kMaxOutput = 1048576;
+
+/**
+ * Maximum pending responses.
+ *
+ * This constant holds the number of incomplete responses above which a connection stops
+ * being read and its requests handled, until the responses are completed.
+ */
+static const size_t kMaxPending = 64;
+
+/**
+ * Maximum write fragments.
+ *
+ * This constant holds the number of output fragments gathered by a single write.
+ */
+static const int kMaxFragments = 64;
+
+
+/*===================================================================================
+ *	PollerCreate																	*
+ *==================================================================================*/
+
+/**
+ * Create poller.
+ *
+ * This function will create the event queue, it returns -1 on failure.
+ *
+ * @access private
+ * @return int
+ */
+static int PollerCreate()
+{
+#ifdef __linux__
+	return epoll_create1( 0 );													// ==>
+#else
+	return kqueue();															// ==>
+#endif
+
+} // PollerCreate.
+
+
+/*===================================================================================
+ *	PollerSet																		*
+ *==================================================================================*/
+
+/**
+ * Set socket events.
+ *
+ * This function will register the provided socket for read events if <i>doRead</i> is
+ * set and for write events if <i>doWrite</i> is set; <i>isNew</i> is set when the socket
+ * is first registered. Closed sockets are removed from the queue by the system.
+ *
+ * @param int				thePoller			Event queue.
+ * @param int				theSocket			Socket.
+ * @param bool				doRead				Poll for reading.
+ * @param bool				doWrite				Poll for writing.
+ * @param bool				isNew				New socket.
+ *
+ * @access private
+ * @return bool
+ */
+static bool PollerSet( int thePoller, int theSocket, bool doRead, bool doWrite,
+					   bool isNew )
+{
+#ifdef __linux__
+	struct epoll_event event;
+	memset( &event, 0, sizeof( event ) );
+	event.events = (( doRead ) ? (uint32_t) EPOLLIN : 0)
+				 | (( doWrite ) ? (uint32_t) EPOLLOUT : 0);
+	event.data.fd = theSocket;
+
+	return epoll_ctl( thePoller, ( isNew ) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD,
+					  theSocket, &event ) == 0;									// ==>
+#else
+	struct kevent changes[ 2 ];
+	EV_SET( &changes[ 0 ], theSocket, EVFILT_READ,
+			EV_ADD | (( doRead ) ? EV_ENABLE : EV_DISABLE), 0, 0, NULL );
+	EV_SET( &changes[ 1 ], theSocket, EVFILT_WRITE,
+			EV_ADD | (( doWrite ) ? EV_ENABLE : EV_DISABLE), 0, 0, NULL );
+
+	return kevent( thePoller, changes, 2, NULL, 0, NULL ) == 0;				// ==>
+#endif
+
+} // PollerSet.
+
+
+/*===================================================================================
+ *	PollerWait																		*
+ *==================================================================================*/
+
+/**
+ * Wait for events.
+ *
+ * This function will wait up to the provided number of milliseconds for socket events
+ * and return the number of events, or -1 on failure; for each event the socket is
+ * returned in <i>theSockets</i> and the writable flag in <i>theWritable</i>. Errors and
+ * hang-ups are returned as read events, so that they are detected by the next read.
+ *
+ * @param int				thePoller			Event queue.
+ * @param int *				theSockets			Receives sockets.
+ * @param bool *			theWritable			Receives writable flags.
+ * @param int				theTimeout			Timeout in milliseconds.
+ *
+ * @access private
+ * @return int
+ */
+static int PollerWait( int thePoller, int * theSockets, bool * theWritable, int theTimeout )
+{
+#ifdef __linux__
+	struct epoll_event events[ kMaxEvents ];
+	int count = epoll_wait( thePoller, events, kMaxEvents, theTimeout );
+	for( int i = 0; i < count; i++ )
+	{
+		theSockets[ i ] = events[ i ].data.fd;
+		theWritable[ i ] = ((events[ i ].events & EPOLLOUT) != 0)
+						&& ((events[ i ].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) == 0);
+	}
+#else
+	struct kevent events[ kMaxEvents ];
+	struct timespec timeout;
+	timeout.tv_sec = theTimeout / 1000;
+	timeout.tv_nsec = (theTimeout % 1000) * 1000000;
+	int count = kevent( thePoller, NULL, 0, events, kMaxEvents, &timeout );
+	for( int i = 0; i < count; i++ )
+	{
+		theSockets[ i ] = (int) events[ i ].ident;
+		theWritable[ i ] = (events[ i ].filter == EVFILT_WRITE)
+						&& ((events[ i ].flags & (EV_EOF | EV_ERROR)) == 0);
+	}
+#endif
+
+	return count;																// ==>
+
+} // PollerWait.
+
+
+/*===================================================================================
+ *	OpenListener																	*
+ *==================================================================================*/
+
+/**
+ * Open listening socket.
+ *
+ * This function will open a non blocking socket listening on the provided address, which
+ * has the form <i>[host:]port</i>; if the host is omitted the server listens on all
+ * interfaces, if the port is omitted <i>{@link kSERVER_DefaultPort kSERVER_DefaultPort}</i>
+ * is used. The function returns -1 on failure.
+ *
+ * @param const string &	theAddress			Server address.
+ * @param string *			theMessage			Receives error message.
+ *
+ * @access private
+ * @return int
+ */
+static int OpenListener( const string & theAddress, string * theMessage )
+{
+	//
+	// Split address.
+	//
+	string host, port = theAddress;
+	size_t colon = theAddress.rfind( ':' );
+	if( colon != string::npos )
+	{
+		host = theAddress.substr( 0, colon );
+		port = theAddress.substr( colon + 1 );
+	}
+	if( (host.size() > 1)
+	 && (host[ 0 ] == '[')
+	 && (host[ host.size() - 1 ] == ']') )
+		host = host.substr( 1, host.size() - 2 );
+	if( port.empty() )
+		port = kSERVER_DefaultPort;
+
+	//
+	// Resolve address.
+	//
+	struct addrinfo hints, * addresses;
+	memset( &hints, 0, sizeof( hints ) );
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+	if( getaddrinfo( ( host.size() ) ? host.c_str() : NULL, port.c_str(),
+					 &hints, &addresses ) )
+	{
+		*theMessage = "Invalid server address [" + theAddress + "]";
+		return -1;																// ==>
+	}
+
+	//
+	// Bind first usable address.
+	//
+	int listener = -1;
+	for( struct addrinfo * address = addresses;
+		 (listener < 0) && (address != NULL);
+		 address = address->ai_next )
+	{
+		listener = socket( address->ai_family, address->ai_socktype,
+						   address->ai_protocol );
+		if( listener < 0 )
+			continue;															// =>
+
+		int flag = 1;
+		setsockopt( listener, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof( flag ) );
+		if( bind( listener, address->ai_addr, address->ai_addrlen )
+		 || listen( listener, SOMAXCONN )
+		 || (fcntl( listener, F_SETFL, fcntl( listener, F_GETFL ) | O_NONBLOCK ) < 0) )
+		{
+			close( listener );
+			listener = -1;
+		}
+	}
+	freeaddrinfo( addresses );
+
+	if( listener < 0 )
+		*theMessage = "Unable to listen on [" + theAddress + "]: " + strerror( errno );
+
+	return listener;															// ==>
+
+} // OpenListener.
+
+
+/*===================================================================================
+ *	GetReason																		*
+ *==================================================================================*/
+
+/**
+ * Get status reason.
+ *
+ * This function will return the reason phrase of the provided status code.
+ *
+ * @param int				theStatus			Status code.
+ *
+ * @access private
+ * @return const char *
+ */
+static const char * GetReason( int theStatus )
+{
+	switch( theStatus )
+	{
+		case 200:	return "OK";												// ==>
+		case 400:	return "Bad Request";										// ==>
+		case 404:	return "Not Found";											// ==>
+		case 405:	return "Method Not Allowed";								// ==>
+		case 413:	return "Payload Too Large";									// ==>
+		case 431:	return "Request Header Fields Too Large";					// ==>
+		case 500:	return "Internal Server Error";								// ==>
+		case 501:	return "Not Implemented";									// ==>
+		case 503:	return "Service Unavailable";								// ==>
+		case 505:	return "HTTP Version Not Supported";						// ==>
+	}
+
+	return "Unknown";															// ==>
+
+} // GetReason.
+
+
+/*===================================================================================
+ *	AppendResponse																	*
+ *==================================================================================*/
+
+/**
+ * Append response.
+ *
+ * This function will append the provided response to the connection output; the body is
+ * omitted for <i>HEAD</i> requests, but its length is still returned. The header and the
+ * body are appended as separate fragments, the body is moved out of the response rather
+ * than copied.
+ *
+ * @param CONNECTION_T *	theConnection		Connection.
+ * @param HTTP_RESPONSE_T *	theResponse			Response.
+ *
+ * @access private
+ * @return void
+ */
+static void AppendResponse( CONNECTION_T * theConnection, HTTP_RESPONSE_T * theResponse )
+{
+	ostringstream header;
+	header << "HTTP/1.1 " << theResponse->status << ' ' << GetReason( theResponse->status )
+		   << "\r\nServer: GeographicFeatures";
+	if( theResponse->type.size() )
+		header << "\r\nContent-Type: " << theResponse->type;
+	header << "\r\nContent-Length: " << theResponse->body.size()
+		   << "\r\nConnection: " << (( theResponse->closing ) ? "close" : "keep-alive")
+		   << "\r\n" << theResponse->headers << "\r\n";
+
+	theConnection->output.push_back( header.str() );
+	theConnection->queued += theConnection->output.back().size();
+	if( (! theResponse->head)
+	 && theResponse->body.size() )
+	{
+		theConnection->output.push_back( string() );
+		theConnection->output.back().swap( theResponse->body );
+		theConnection->queued += theConnection->output.back().size();
+	}
+
+} // AppendResponse.
+
+
+/*===================================================================================
+ *	FlushResponses																	*
+ *==================================================================================*/
+
+/**
+ * Flush responses.
+ *
+ * This function will append the complete responses at the head of the provided
+ * connection response queue to its output, stopping at the first pending response.
+ *
+ * @param CONNECTION_T *	theConnection		Connection.
+ *
+ * @access private
+ * @return void
+ */
+static void FlushResponses( CONNECTION_T * theConnection )
+{
+	while( theConnection->responses.size()
+		&& theConnection->responses.front()->ready )
+	{
+		AppendResponse( theConnection, theConnection->responses.front() );
+		delete theConnection->responses.front();
+		theConnection->responses.pop_front();
+	}
+
+} // FlushResponses.
+
+
+/*===================================================================================
+ *	ParseRequest																	*
+ *==================================================================================*/
+
+/**
+ * Parse request.
+ *
+ * This function will parse the request starting at the provided offset of the provided
+ * input: it returns 1 if a complete request was parsed, in which case <i>theSize</i>
+ * receives its size in bytes, 0 if more input is needed and -1 if the request is
+ * invalid, in which case <i>theStatus</i> receives the error status code.
+ *
+ * @param const string &	theInput			Connection input.
+ * @param size_t			theOffset			Request offset.
+ * @param HTTP_REQUEST_T *	theRequest			Receives request.
+ * @param size_t *			theSize				Receives request size.
+ * @param int *				theStatus			Receives error status.
+ *
+ * @access private
+ * @return int
+ */
+static int ParseRequest( const string & theInput, size_t theOffset,
+						 HTTP_REQUEST_T * theRequest, size_t * theSize, int * theStatus )
+{
+	//
+	// Find header end.
+	// Empty lines preceding a request are ignored.
+	//
+	size_t start = theInput.find_first_not_of( "\r\n", theOffset );
+	if( start == string::npos )
+		start = theInput.size();
+	size_t end = theInput.find( "\r\n\r\n", start );
+	if( end == string::npos )
+	{
+		if( (theInput.size() - start) > kSERVER_MaxHeader )
+		{
+			*theStatus = 431;
+			return -1;															// ==>
+		}
+
+		return 0;																// ==>
+	}
+	if( (end - start) > kSERVER_MaxHeader )
+	{
+		*theStatus = 431;
+		return -1;																// ==>
+	}
+
+	//
+	// Parse request line.
+	//
+	istringstream lines( theInput.substr( start, end - start ) );
+	string line, target;
+	getline( lines, line );
+	if( line.size() && (line[ line.size() - 1 ] == '\r') )
+		line.erase( line.size() - 1 );
+	istringstream request( line );
+	if( ! (request >> theRequest->method >> target >> theRequest->version)
+	 || (theRequest->version.compare( 0, 5, "HTTP/" ) != 0) )
+	{
+		*theStatus = 400;
+		return -1;																// ==>
+	}
+	if( (theRequest->version != "HTTP/1.1")
+	 && (theRequest->version != "HTTP/1.0") )
+	{
+		*theStatus = 505;
+		return -1;																// ==>
+	}
+
+	//
+	// Split target.
+	//
+	size_t mark = target.find( '?' );
+	theRequest->path = target.substr( 0, mark );
+	theRequest->query = ( mark != string::npos ) ? target.substr( mark + 1 ) : "";
+
+	//
+	// Parse headers.
+	//
+	size_t length = 0;
+	string connection;
+	while( getline( lines, line ) )
+	{
+		//
+		// Split header.
+		//
+		if( line.size() && (line[ line.size() - 1 ] == '\r') )
+			line.erase( line.size() - 1 );
+		size_t separator = line.find( ':' );
+		if( separator == string::npos )
+		{
+			*theStatus = 400;
+			return -1;															// ==>
+		}
+		string name = line.substr( 0, separator );
+		string value = line.substr( separator + 1 );
+		for( size_t i = 0; i < name.size(); i++ )
+			name[ i ] = tolower( (unsigned char) name[ i ] );
+		for( size_t i = 0; i < value.size(); i++ )
+			value[ i ] = tolower( (unsigned char) value[ i ] );
+		value.erase( 0, value.find_first_not_of( " \t" ) );
+		value.erase( value.find_last_not_of( " \t" ) + 1 );
+
+		//
+		// Handle headers.
+		//
+		if( name == "content-length" )
+		{
+			char * tail;
+			length = strtoul( value.c_str(), &tail, 10 );
+			if( value.empty()
+			 || *tail )
+			{
+				*theStatus = 400;
+				return -1;														// ==>
+			}
+		}
+		else if( name == "transfer-encoding" )
+		{
+			*theStatus = 501;
+			return -1;															// ==>
+		}
+		else if( name == "connection" )
+			connection = value;
+
+	} // Iterating headers.
+
+	//
+	// Set persistence.
+	//
+	if( theRequest->version == "HTTP/1.1" )
+		theRequest->keepAlive = (connection.find( "close" ) == string::npos);
+	else
+		theRequest->keepAlive = (connection.find( "keep-alive" ) != string::npos);
+
+	//
+	// Get body.
+	//
+	if( length > kSERVER_MaxBody )
+	{
+		*theStatus = 413;
+		return -1;																// ==>
+	}
+	if( theInput.size() < (end + 4 + length) )
+		return 0;																// ==>
+
+	theRequest->body = theInput.substr( end + 4, length );
+	*theSize = end + 4 + length - theOffset;
+
+	return 1;																	// ==>
+
+} // ParseRequest.
+
+
+/*===================================================================================
+ *	ReadConnection																	*
+ *==================================================================================*/
+
+/**
+ * Read connection.
+ *
+ * This function will append the available input of the provided connection to its input
+ * buffer. The function returns FALSE if the connection must be closed at once.
+ *
+ * @param CONNECTION_T *	theConnection		Connection.
+ *
+ * @access private
+ * @return bool
+ */
+static bool ReadConnection( CONNECTION_T * theConnection )
+{
+	//
+	// Read input.
+	//
+	char buffer[ kReadSize ];
+	for( ;; )
+	{
+		ssize_t count = recv( theConnection->socket, buffer, sizeof( buffer ), 0 );
+		if( count > 0 )
+		{
+			//
+			// Ignore input after the last request.
+			//
+			if( ! theConnection->closing )
+				theConnection->input.append( buffer, count );
+			continue;															// =>
+		}
+		if( count == 0 )
+			return false;														// ==>
+		if( errno == EINTR )
+			continue;															// =>
+		if( (errno == EAGAIN)
+		 || (errno == EWOULDBLOCK) )
+			break;																// =>
+
+		return false;															// ==>
+	}
+
+	return true;																// ==>
+
+} // ReadConnection.
+
+
+/*===================================================================================
+ *	RejectRequest																	*
+ *==================================================================================*/
+
+/**
+ * Reject request.
+ *
+ * This function will complete the provided response with <i>503</i> and a
+ * <i>Retry-After</i> header holding the number of seconds needed to serve the waiting
+ * requests at the throughput of the last second.
+ *
+ * @param const SCHEDULER_T &	theScheduler	Scheduler.
+ * @param HTTP_RESPONSE_T *	theResponse			Response.
+ *
+ * @access private
+ * @return void
+ */
+static void RejectRequest( const SCHEDULER_T & theScheduler, HTTP_RESPONSE_T * theResponse )
+{
+	size_t delay = 1 + (theScheduler.queued
+						/ (( theScheduler.rate ) ? theScheduler.rate : 1));
+	if( delay > (size_t) kSERVER_IdleTimeout )
+		delay = kSERVER_IdleTimeout;
+
+	ostringstream header;
+	header << "Retry-After: " << delay << "\r\n";
+	theResponse->status = 503;
+	theResponse->headers = header.str();
+	theResponse->ready = true;
+	AddCount( kCOUNT_Rejected );
+
+} // RejectRequest.
+
+
+/*===================================================================================
+ *	HandleRequests																	*
+ *==================================================================================*/
+
+/**
+ * Handle requests.
+ *
+ * This function will parse the complete requests of the provided connection input in
+ * order, queueing their responses on the connection and the requests in the scheduler,
+ * or rejecting them if the scheduler is full; requests are left in the input while the
+ * pending output exceeds <i>{@link kMaxOutput kMaxOutput}</i>, or the pending responses
+ * exceed <i>{@link kMaxPending kMaxPending}</i>, in which case the function returns TRUE.
+ *
+ * @param CONNECTION_T *	theConnection		Connection.
+ * @param SCHEDULER_T *		theScheduler		Scheduler.
+ * @param time_t			theTime				Current time.
+ *
+ * @access private
+ * @return bool
+ */
+static bool HandleRequests( CONNECTION_T * theConnection, SCHEDULER_T * theScheduler,
+							time_t theTime )
+{
+	size_t consumed = 0;
+	bool full = false;
+	while( ! theConnection->closing )
+	{
+		//
+		// Check pending output.
+		//
+		if( ((theConnection->queued - theConnection->sent) > kMaxOutput)
+		 || (theConnection->responses.size() > kMaxPending) )
+		{
+			full = true;
+			break;																// =>
+		}
+		
+		//
+		// Parse request.
+		//
+		ADMISSION_T admission;
+		size_t size = 0;
+		int status = 0;
+		int result = ParseRequest( theConnection->input, consumed,
+								   &admission.request, &size, &status );
+		if( ! result )
+			break;																// =>
+
+		//
+		// Queue response.
+		//
+		HTTP_RESPONSE_T * response = new HTTP_RESPONSE_T;
+		response->socket = theConnection->socket;
+		response->head = (admission.request.method == "HEAD");
+		response->ready = true;
+		theConnection->responses.push_back( response );
+
+		//
+		// Handle invalid request.
+		//
+		if( result < 0 )
+		{
+			theConnection->closing = true;
+			response->status = status;
+			response->closing = true;
+			break;																// =>
+		}
+
+		//
+		// Handle full queue.
+		//
+		consumed += size;
+		theConnection->closing = ! admission.request.keepAlive;
+		response->status = 200;
+		response->closing = theConnection->closing;
+		if( theScheduler->queued >= theScheduler->limits.queue )
+		{
+			RejectRequest( *theScheduler, response );
+			continue;															// =>
+		}
+
+		//
+		// Queue request.
+		//
+		vector<string> priority;
+		GetParameters( admission.request.query, "priority", &priority );
+		int level = ( priority.size() && (priority.back() == "batch") )
+				  ? kSERVER_Batch
+				  : kSERVER_Interactive;
+		admission.response = response;
+		admission.arrival = theTime;
+		response->ready = false;
+		theScheduler->queues[ level ][ theConnection->client ].push_back( admission );
+		theScheduler->queued++;
+		AddCount( ( level == kSERVER_Batch ) ? kCOUNT_Batch : kCOUNT_Interactive );
+
+	} // Handling requests.
+
+	theConnection->input.erase( 0, consumed );
+	FlushResponses( theConnection );
+
+	return full;																// ==>
+
+} // HandleRequests.
+
+
+/*===================================================================================
+ *	DispatchRequests																*
+ *==================================================================================*/
+
+/**
+ * Dispatch requests.
+ *
+ * This function will hand waiting requests to the provided handler while fewer than the
+ * concurrency limit are in progress: interactive requests go before batch requests, and
+ * within a priority the clients are served in turn. Requests past the deadline are
+ * rejected and requests of closed connections are discarded. The sockets of the
+ * connections having new complete responses are appended to the provided list.
+ *
+ * @param SCHEDULER_T *		theScheduler		Scheduler.
+ * @param SERVER_HANDLER_T	theHandler			Request handler.
+ * @param void *			theContext			Handler context.
+ * @param time_t			theTime				Current time.
+ * @param vector<int> *		theSockets			Receives sockets.
+ *
+ * @access private
+ * @return void
+ */
+static void DispatchRequests( SCHEDULER_T * theScheduler, SERVER_HANDLER_T theHandler,
+							  void * theContext, time_t theTime, vector<int> * theSockets )
+{
+	while( theScheduler->queued
+		&& (theScheduler->active < theScheduler->limits.concurrency) )
+	{
+		//
+		// Select next client.
+		//
+		int level = ( theScheduler->queues[ kSERVER_Interactive ].size() )
+				  ? kSERVER_Interactive
+				  : kSERVER_Batch;
+		map<string, deque<ADMISSION_T> > & queues = theScheduler->queues[ level ];
+		map<string, deque<ADMISSION_T> >::iterator client
+			= queues.upper_bound( theScheduler->last[ level ] );
+		if( client == queues.end() )
+			client = queues.begin();
+		theScheduler->last[ level ] = client->first;
+
+		//
+		// Pop request.
+		//
+		ADMISSION_T admission = client->second.front();
+		client->second.pop_front();
+		if( client->second.empty() )
+			queues.erase( client );
+		theScheduler->queued--;
+
+		//
+		// Discard orphaned requests.
+		//
+		HTTP_RESPONSE_T * response = admission.response;
+		if( response->socket < 0 )
+		{
+			delete response;
+			continue;															// =>
+		}
+
+		//
+		// Reject expired requests.
+		//
+		if( (theTime - admission.arrival) > theScheduler->limits.deadline )
+			RejectRequest( *theScheduler, response );
+
+		//
+		// Handle request.
+		//
+		else
+		{
+			response->ready = theHandler( admission.request, response, theContext );
+			if( ! response->ready )
+			{
+				theScheduler->active++;
+				continue;														// =>
+			}
+		}
+
+		theScheduler->served++;
+		theSockets->push_back( response->socket );
+
+	} // Dispatching.
+
+} // DispatchRequests.
+
+
+/*===================================================================================
+ *	ShedRequests																	*
+ *==================================================================================*/
+
+/**
+ * Shed expired requests.
+ *
+ * This function will reject the waiting requests past the deadline and discard the
+ * waiting requests of closed connections; since the requests of a client wait in arrival
+ * order, only the head of each queue is checked. The sockets of the connections having
+ * new complete responses are appended to the provided list.
+ *
+ * @param SCHEDULER_T *		theScheduler		Scheduler.
+ * @param time_t			theTime				Current time.
+ * @param vector<int> *		theSockets			Receives sockets.
+ *
+ * @access private
+ * @return void
+ */
+static void ShedRequests( SCHEDULER_T * theScheduler, time_t theTime,
+						  vector<int> * theSockets )
+{
+	for( int level = kSERVER_Interactive; level <= kSERVER_Batch; level++ )
+	{
+		map<string, deque<ADMISSION_T> > & queues = theScheduler->queues[ level ];
+		map<string, deque<ADMISSION_T> >::iterator client = queues.begin();
+		while( client != queues.end() )
+		{
+			deque<ADMISSION_T> & requests = client->second;
+			while( requests.size()
+				&& ((requests.front().response->socket < 0)
+				 || ((theTime - requests.front().arrival)
+					 > theScheduler->limits.deadline)) )
+			{
+				HTTP_RESPONSE_T * response = requests.front().response;
+				requests.pop_front();
+				theScheduler->queued--;
+				if( response->socket < 0 )
+					delete response;
+				else
+				{
+					RejectRequest( *theScheduler, response );
+					theSockets->push_back( response->socket );
+				}
+			}
+
+			if( requests.empty() )
+				queues.erase( client++ );
+			else
+				++client;
+		}
+	}
+
+} // ShedRequests.
+
+
+/*===================================================================================
+ *	WriteConnection																	*
+ *==================================================================================*/
+
+/**
+ * Write connection.
+ *
+ * This function will send as much pending output of the provided connection as the
+ * socket accepts, gathering up to <i>{@link kMaxFragments kMaxFragments}</i> output
+ * fragments in each write. The function returns FALSE if the connection must be closed,
+ * either because of an error or because all the responses were sent to a closing
+ * connection.
+ *
+ * @param CONNECTION_T *	theConnection		Connection.
+ *
+ * @access private
+ * @return bool
+ */
+static bool WriteConnection( CONNECTION_T * theConnection )
+{
+	//
+	// Send output.
+	//
+	deque<string> & output = theConnection->output;
+	while( output.size() )
+	{
+		//
+		// Gather fragments.
+		// The first fragment may be partially sent.
+		//
+		struct iovec fragments[ kMaxFragments ];
+		int used = 0;
+		for( deque<string>::iterator fragment = output.begin();
+			 (fragment != output.end()) && (used < kMaxFragments);
+			 fragment++, used++ )
+		{
+			fragments[ used ].iov_base = (void *) fragment->data();
+			fragments[ used ].iov_len = fragment->size();
+		}
+		fragments[ 0 ].iov_base = (char *) fragments[ 0 ].iov_base + theConnection->sent;
+		fragments[ 0 ].iov_len -= theConnection->sent;
+
+		//
+		// Write.
+		//
+		ssize_t count = writev( theConnection->socket, fragments, used );
+		if( count > 0 )
+		{
+			//
+			// Drop sent fragments.
+			//
+			size_t remaining = count;
+			while( remaining
+				&& (remaining >= (output.front().size() - theConnection->sent)) )
+			{
+				remaining -= output.front().size() - theConnection->sent;
+				theConnection->queued -= output.front().size();
+				theConnection->sent = 0;
+				output.pop_front();
+			}
+			theConnection->sent += remaining;
+			continue;															// =>
+		}
+		if( (count < 0)
+		 && (errno == EINTR) )
+			continue;															// =>
+		if( (count < 0)
+		 && ((errno == EAGAIN) || (errno == EWOULDBLOCK)) )
+			return true;														// ==>
+
+		return false;															// ==>
+	}
+
+	//
+	// Reset output.
+	//
+	theConnection->queued = 0;
+	theConnection->sent = 0;
+
+	return (! theConnection->closing)
+		|| theConnection->responses.size();										// ==>
+
+} // WriteConnection.
+
+
+/*===================================================================================
+ *	AcceptConnections																*
+ *==================================================================================*/
+
+/**
+ * Accept connections.
+ *
+ * This function will accept all pending connections of the provided listening socket
+ * and register them in the event queue.
+ *
+ * @param int				theListener			Listening socket.
+ * @param int				thePoller			Event queue.
+ * @param map<int, CONNECTION_T> *	theConnections	Connections.
+ *
+ * @access private
+ * @return void
+ */
+static void AcceptConnections( int theListener, int thePoller,
+							   map<int, CONNECTION_T> * theConnections )
+{
+	for( ;; )
+	{
+		//
+		// Accept connection.
+		//
+		struct sockaddr_storage address;
+		socklen_t length = sizeof( address );
+		int socket = accept( theListener, (struct sockaddr *) &address, &length );
+		if( socket < 0 )
+		{
+			if( errno == EINTR )
+				continue;														// =>
+			break;																// =>
+		}
+
+		//
+		// Set socket.
+		//
+		int flag = 1;
+		setsockopt( socket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof( flag ) );
+		if( (fcntl( socket, F_SETFL, fcntl( socket, F_GETFL ) | O_NONBLOCK ) < 0)
+		 || (! PollerSet( thePoller, socket, true, false, true )) )
+		{
+			close( socket );
+			continue;															// =>
+		}
+
+		//
+		// Add connection.
+		//
+		char host[ NI_MAXHOST ];
+		if( getnameinfo( (struct sockaddr *) &address, length, host, sizeof( host ),
+						 NULL, 0, NI_NUMERICHOST ) )
+			host[ 0 ] = 0;
+		CONNECTION_T & connection = (*theConnections)[ socket ];
+		connection.socket = socket;
+		connection.client = host;
+		connection.input.clear();
+		connection.output.clear();
+		connection.queued = 0;
+		connection.sent = 0;
+		connection.reading = true;
+		connection.writing = false;
+		connection.closing = false;
+		connection.active = time( NULL );
+
+	} // Accepting connections.
+
+} // AcceptConnections.
+
+
+/*===================================================================================
+ *	ServeConnection																	*
+ *==================================================================================*/
+
+/**
+ * Serve connection.
+ *
+ * This function will read the provided connection if <i>doRead</i> is set, queue its
+ * requests, write its responses and update its events in the event queue. The function
+ * returns FALSE if the connection must be closed.
+ *
+ * @param CONNECTION_T *	theConnection		Connection.
+ * @param int				thePoller			Event queue.
+ * @param SCHEDULER_T *		theScheduler		Scheduler.
+ * @param time_t			theTime				Current time.
+ * @param bool				doRead				Read input.
+ *
+ * @access private
+ * @return bool
+ */
+static bool ServeConnection( CONNECTION_T * theConnection, int thePoller,
+							 SCHEDULER_T * theScheduler, time_t theTime, bool doRead )
+{
+	//
+	// Read requests.
+	//
+	bool open = true;
+	if( doRead )
+		open = ReadConnection( theConnection );
+
+	//
+	// Handle requests and write responses.
+	// Requests held back by a full output are resumed once it is sent.
+	//
+	bool full = false;
+	while( open )
+	{
+		full = HandleRequests( theConnection, theScheduler, theTime );
+		open = WriteConnection( theConnection );
+		if( (! full)
+		 || theConnection->output.size()
+		 || (theConnection->responses.size() > kMaxPending) )
+			break;																// =>
+	}
+
+	//
+	// Poll for writing while output is pending.
+	// Reading is suspended while the output is full.
+	//
+	bool reading = ! full;
+	bool writing = (theConnection->output.size() > 0);
+	if( open
+	 && ((reading != theConnection->reading) || (writing != theConnection->writing)) )
+	{
+		open = PollerSet( thePoller, theConnection->socket, reading, writing, false );
+		theConnection->reading = reading;
+		theConnection->writing = writing;
+	}
+
+	return open;																// ==>
+
+} // ServeConnection.
+
+
+/*===================================================================================
+ *	CloseConnection																	*
+ *==================================================================================*/
+
+/**
+ * Close connection.
+ *
+ * This function will close the provided connection and remove it from the provided list;
+ * its complete responses are discarded, its pending responses are marked as orphaned,
+ * they are discarded when completed.
+ *
+ * @param map<int, CONNECTION_T> *	theConnections	Connections.
+ * @param map<int, CONNECTION_T>::iterator	theConnection	Connection.
+ *
+ * @access private
+ * @return void
+ */
+static void CloseConnection( map<int, CONNECTION_T> * theConnections,
+							 map<int, CONNECTION_T>::iterator theConnection )
+{
+	deque<HTTP_RESPONSE_T *> & responses = theConnection->second.responses;
+	for( size_t i = 0; i < responses.size(); i++ )
+	{
+		if( responses[ i ]->ready )
+			delete responses[ i ];
+		else
+			responses[ i ]->socket = -1;
+	}
+
+	close( theConnection->first );
+	theConnections->erase( theConnection );
+
+} // CloseConnection.
+
+
+/*===================================================================================
+ *	RunServer																		*
+ *==================================================================================*/
+
+/**
+ * Serve requests.
+ *
+ * This function will listen on the provided address and serve requests until a fatal
+ * error occurs, each admitted request is passed to the provided handler along with the
+ * provided context. The provided poll function is called with the same context whenever
+ * one of the provided descriptors is readable, it returns the pending responses it
+ * completed; it also serves events other than completions, such as reload requests.
+ * The function returns an error code and sets the error message if the server cannot be
+ * started or stops.
+ *
+ * @param const string &	theAddress			Server address, <i>[host:]port</i>.
+ * @param const LIMITS_T &	theLimits			Admission limits.
+ * @param SERVER_HANDLER_T	theHandler			Request handler.
+ * @param SERVER_POLL_T		thePoll				Poll function, or NULL.
+ * @param const vector<int> &	theEvents		Polled descriptors.
+ * @param void *			theContext			Handler context.
+ * @param string *			theMessage			Receives error message.
+ *
+ * @access public
+ * @return int
+ */
+int RunServer( const string & theAddress, const LIMITS_T & theLimits,
+			   SERVER_HANDLER_T theHandler, SERVER_POLL_T thePoll,
+			   const vector<int> & theEvents, void * theContext, string * theMessage )
+{
+	//
+	// Ignore closed peers.
+	//
+	signal( SIGPIPE, SIG_IGN );
+
+	//
+	// Open listener.
+	//
+	int listener = OpenListener( theAddress, theMessage );
+	if( listener < 0 )
+		return kERROR_SERVER_FAILED;											// ==>
+
+	//
+	// Open event queue.
+	//
+	int poller = PollerCreate();
+	bool polled = (poller >= 0)
+			   && PollerSet( poller, listener, true, false, true );
+	for( size_t i = 0; polled && (thePoll != NULL) && (i < theEvents.size()); i++ )
+		polled = PollerSet( poller, theEvents[ i ], true, false, true );
+	if( ! polled )
+	{
+		*theMessage = string( "Unable to create event queue: " ) + strerror( errno );
+		if( poller >= 0 )
+			close( poller );
+		close( listener );
+		return kERROR_SERVER_FAILED;											// ==>
+	}
+
+	//
+	// Init scheduler.
+	//
+	SCHEDULER_T scheduler;
+	scheduler.limits = theLimits;
+	scheduler.queued = 0;
+	scheduler.active = 0;
+	scheduler.served = 0;
+	scheduler.rate = 0;
+
+	//
+	// Serve.
+	//
+	map<int, CONNECTION_T> connections;
+	vector<HTTP_RESPONSE_T *> completed;
+	vector<int> ready;
+	int sockets[ kMaxEvents ];
+	bool writable[ kMaxEvents ];
+	time_t sweep = time( NULL );
+	for( ;; )
+	{
+		//
+		// Wait events.
+		// Admissible requests are dispatched without waiting.
+		//
+		int timeout = ( scheduler.queued
+					 && (scheduler.active < scheduler.limits.concurrency) ) ? 0 : 1000;
+		int count = PollerWait( poller, sockets, writable, timeout );
+		if( count < 0 )
+		{
+			if( errno == EINTR )
+				continue;														// =>
+
+			*theMessage = string( "Unable to wait for events: " ) + strerror( errno );
+			break;																// =>
+		}
+
+		//
+		// Handle events.
+		//
+		time_t now = time( NULL );
+		ready.clear();
+		for( int i = 0; i < count; i++ )
+		{
+			//
+			// Handle new connections.
+			//
+			if( sockets[ i ] == listener )
+			{
+				AcceptConnections( listener, poller, &connections );
+				continue;														// =>
+			}
+
+			//
+			// Handle completed responses.
+			// Responses of closed connections are discarded.
+			//
+			if( (thePoll != NULL)
+			 && (find( theEvents.begin(), theEvents.end(), sockets[ i ] )
+				 != theEvents.end()) )
+			{
+				completed.clear();
+				thePoll( theContext, sockets[ i ], &completed );
+				scheduler.active -= completed.size();
+				scheduler.served += completed.size();
+				for( size_t j = 0; j < completed.size(); j++ )
+				{
+					if( completed[ j ]->socket < 0 )
+					{
+						delete completed[ j ];
+						continue;												// =>
+					}
+
+					completed[ j ]->ready = true;
+					ready.push_back( completed[ j ]->socket );
+				}
+				continue;														// =>
+			}
+
+			//
+			// Get connection.
+			// Connections closed earlier in the same iteration are skipped.
+			//
+			map<int, CONNECTION_T>::iterator found = connections.find( sockets[ i ] );
+			if( found == connections.end() )
+				continue;														// =>
+
+			//
+			// Serve connection.
+			//
+			if( ServeConnection( &found->second, poller, &scheduler, now,
+								 ! writable[ i ] ) )
+				found->second.active = now;
+			else
+				CloseConnection( &connections, found );
+
+		} // Iterating events.
+
+		//
+		// Shed expired requests.
+		// Rates and deadlines are updated once per second.
+		//
+		bool tick = (now != sweep);
+		if( tick )
+		{
+			sweep = now;
+			scheduler.rate = scheduler.served;
+			scheduler.served = 0;
+			ShedRequests( &scheduler, now, &ready );
+		}
+
+		//
+		// Dispatch requests.
+		// Gauges are set first, so that the handler can report them.
+		//
+		SetGauge( kGAUGE_Connections, connections.size() );
+		SetGauge( kGAUGE_Queued, scheduler.queued );
+		SetGauge( kGAUGE_Active, scheduler.active );
+		DispatchRequests( &scheduler, theHandler, theContext, now, &ready );
+
+		//
+		// Write completed responses.
+		//
+		sort( ready.begin(), ready.end() );
+		ready.erase( unique( ready.begin(), ready.end() ), ready.end() );
+		for( size_t i = 0; i < ready.size(); i++ )
+		{
+			map<int, CONNECTION_T>::iterator found = connections.find( ready[ i ] );
+			if( found == connections.end() )
+				continue;														// =>
+
+			if( ServeConnection( &found->second, poller, &scheduler, now, false ) )
+				found->second.active = now;
+			else
+				CloseConnection( &connections, found );
+		}
+
+		//
+		// Close idle connections.
+		// Connections waiting for responses are not idle.
+		//
+		if( tick )
+		{
+			map<int, CONNECTION_T>::iterator connection = connections.begin();
+			while( connection != connections.end() )
+			{
+				if( connection->second.responses.empty()
+				 && ((now - connection->second.active) > kSERVER_IdleTimeout) )
+					CloseConnection( &connections, connection++ );
+				else
+					++connection;
+			}
+		}
+
+	} // Serving.
+
+	//
+	// Close sockets.
+	//
+	while( connections.size() )
+		CloseConnection( &connections, connections.begin() );
+	close( poller );
+	close( listener );
+
+	return kERROR_SERVER_FAILED;												// ==>
+
+} // RunServer.
+
+
+/*===================================================================================
+ *	Decode																			*
+ *==================================================================================*/
+
+/**
+ * Decode query component.
+ *
+ * This function will return the provided query string component with '+' replaced by a
+ * space and percent-encoded characters decoded.
+ *
+ * @param const string &	theComponent		Encoded component.
+ *
+ * @access private
+ * @return string
+ */
+static string Decode( const string & theComponent )
+{
+	string decoded;
+	for( size_t i = 0; i < theComponent.size(); i++ )
+	{
+		char digits[ 3 ] = { 0, 0, 0 };
+		if( theComponent[ i ] == '+' )
+			decoded += ' ';
+		else if( (theComponent[ i ] == '%')
+			  && ((i + 2) < theComponent.size())
+			  && isxdigit( (unsigned char) theComponent[ i + 1 ] )
+			  && isxdigit( (unsigned char) theComponent[ i + 2 ] ) )
+		{
+			digits[ 0 ] = theComponent[ ++i ];
+			digits[ 1 ] = theComponent[ ++i ];
+			decoded += (char) strtol( digits, NULL, 16 );
+		}
+		else
+			decoded += theComponent[ i ];
+	}
+
+	return decoded;																// ==>
+
+} // Decode.
+
+
+/*===================================================================================
+ *	GetParameters																	*
+ *==================================================================================*/
+
+/**
+ * Get query parameters.
+ *
+ * This function will append to the provided list the decoded values of all the
+ * parameters of the provided query string with the provided name, in order; '+' and
+ * percent-encoded characters are decoded and parameters without value get an empty
+ * string. The function returns the number of values found.
+ *
+ * @param const string &	theQuery			Query string.
+ * @param const string &	theName				Parameter name.
+ * @param vector<string> *	theValues			Receives values.
+ *
+ * @access public
+ * @return size_t
+ */
+size_t GetParameters( const string & theQuery, const string & theName,
+					  vector<string> * theValues )
+{
+	size_t found = 0;
+	size_t start = 0;
+	while( start <= theQuery.size() )
+	{
+		//
+		// Get parameter.
+		//
+		size_t end = theQuery.find_first_of( "&;", start );
+		if( end == string::npos )
+			end = theQuery.size();
+		string parameter = theQuery.substr( start, end - start );
+		start = end + 1;
+
+		//
+		// Match name.
+		//
+		size_t equal = parameter.find( '=' );
+		if( Decode( parameter.substr( 0, equal ) ) == theName )
+		{
+			theValues->push_back( ( equal != string::npos )
+								? Decode( parameter.substr( equal + 1 ) )
+								: "" );
+			found++;
+		}
+
+	} // Iterating parameters.
+
+	return found;																// ==>
+
+} // GetParameters.
@@ -0,0 +1,125 @@
+/**
+ * HTTP server definitions.
+ *
+ * This file contains the declarations of the embedded HTTP/1.1 server: the server runs a
+ * single event loop accepting connections, parsing requests, including pipelined requests
+ * on persistent connections, and sending the responses produced by a handler function.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Types.h"
+
+using namespace std;
+
+#include "Structures.h"
+
+
+/**
+ * Default port.
+ *
+ * This constant holds the port used when the server address has none.
+ */
+const char * const kSERVER_DefaultPort = "8080";
+
+/**
+ * Maximum header size.
+ *
+ * This constant holds the maximum size in bytes of a request line and headers.
+ */
+const size_t kSERVER_MaxHeader = 8192;
+
+/**
+ * Maximum body size.
+ *
+ * This constant holds the maximum size in bytes of a request body.
+ */
+const size_t kSERVER_MaxBody = 65536;
+
+/**
+ * Idle timeout.
+ *
+ * This constant holds the number of seconds after which an idle connection is closed.
+ */
+const int kSERVER_IdleTimeout = 60;
+
+/**
+ * Default concurrency.
+ *
+ * This constant holds the default maximum number of requests in progress.
+ */
+const size_t kSERVER_Concurrency = 64;
+
+/**
+ * Default queue size.
+ *
+ * This constant holds the default maximum number of requests waiting for admission.
+ */
+const size_t kSERVER_Queue = 4096;
+
+/**
+ * Default deadline.
+ *
+ * This constant holds the default number of seconds a request may wait for admission.
+ */
+const int kSERVER_Deadline = 5;
+
+/**
+ * Priorities.
+ *
+ * These constants hold the request priorities: interactive requests are admitted before
+ * batch requests, which carry the <i>priority=batch</i> query parameter.
+ */
+const int kSERVER_Interactive = 0;
+const int kSERVER_Batch = 1;
+
+/**
+ * Request handler.
+ *
+ * This type defines the function called for each request, it receives the request, the
+ * response to fill and the context provided to RunServer(); it returns FALSE if the
+ * response is left pending, to be returned later by the poll function.
+ */
+typedef bool (*SERVER_HANDLER_T)( const HTTP_REQUEST_T & theRequest,
+								  HTTP_RESPONSE_T * theResponse, void * theContext );
+
+/**
+ * Poll function.
+ *
+ * This type defines the function called when one of the descriptors provided to
+ * RunServer() is readable, it receives the context and the descriptor, and appends the
+ * pending responses it completed to the provided list.
+ */
+typedef void (*SERVER_POLL_T)( void * theContext, int theDescriptor,
+							   vector<HTTP_RESPONSE_T *> * theResponses );
+
+/**
+ * RunServer.
+ *
+ * Serve requests.
+ */
+int RunServer( const string & theAddress, const LIMITS_T & theLimits,
+			   SERVER_HANDLER_T theHandler, SERVER_POLL_T thePoll,
+			   const vector<int> & theEvents, void * theContext, string * theMessage );
+
+/**
+ * GetParameters.
+ *
+ * Get decoded query parameter values.
+ */
+size_t GetParameters( const string & theQuery, const string & theName,
+					  vector<string> * theValues );
+
+#endif // SERVER_H
@@ -0,0 +1,845 @@
+/**
+ * Statistics.
+ *
+ * This file contains the instrumentation counters: callers take the ticks at the start of
+ * a stage and AddStage() records the elapsed ticks in the stage histogram, the band read
+ * functions account their bytes and system calls with AddReads(). The histograms keep
+ * the leading bits of each duration, as HDR histograms do, so that recording is a few
+ * instructions and percentiles are accurate at any scale.
+ *
+ * The counters are plain process variables: the command and the server run a single
+ * thread, so recording needs neither locks nor atomic operations.
+ *
+ * The points of the command and of the server are counted by result code with
+ * AddPoint(), so that the errors of a batch are summarised along with its timings.
+ *
+ * The server also counts its requests and keeps gauges of its queues; WriteMetrics()
+ * exposes all the counters in the Prometheus text format, with the stage histograms
+ * folded into fixed second buckets.
+ *
+ * Ticks are converted to time when the statistics are written, from the ticks and the
+ * monotonic clock elapsed since StartStats(); page faults are taken from the process
+ * resource usage.
+ *
+ * Built with <i>STATS_ALLOCATIONS</i> defined, the global <i>operator new</i> is
+ * replaced to count the heap allocations, which the benchmark reports per query, so that
+ * allocations creeping back into the query path are noticed; the default build does not
+ * count them.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Stats.cpp										*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * System includes.
+ */
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <new>
+#include <cstdlib>
+#include <sys/resource.h>
+
+/**
+ * Local includes.
+ */
+#include "Stats.h"											// Statistics.
+
+/**
+ * Stage names.
+ */
+static const char * const kStageNames [ kSTAT_Stages ] =
+{
+	"parse", "open", "lookup", "read", "derive", "format", "request"
+};
+
+/**
+ * Counters.
+ */
+static UInt64 startTicks = 0;								// Start ticks.
+static struct timespec startTime;							// Start time.
+static struct rusage startUsage;							// Start resource usage.
+static UInt64 stageCount [ kSTAT_Stages ];					// Durations count.
+static UInt64 stageTotal [ kSTAT_Stages ];					// Durations sum.
+static UInt64 stageMax [ kSTAT_Stages ];					// Longest duration.
+static UInt64 stageBuckets [ kSTAT_Stages ][ kSTAT_Buckets ];	// Histograms.
+static UInt64 readBytes = 0;								// Bytes read.
+static UInt64 readCalls = 0;								// Read system calls.
+static vector<UInt64> layerBytes;							// Bytes read by layer.
+static UInt64 counters [ kCOUNT_Counters ];					// Event counters.
+static UInt64 gauges [ kGAUGE_Gauges ];						// Gauges.
+static map<int, UInt64> points;								// Points by result code.
+static UInt64 batchPoints = 0;								// Batch points.
+static UInt64 batchCells = 0;								// Batch distinct cells.
+static UInt64 allocations = 0;								// Heap allocations.
+
+/**
+ * Counter names.
+ */
+static const char * const kCounterNames [ kCOUNT_Counters ] =
+{
+	"interactive", "batch", "rejected", "location", "invalid", "stats", "coalesced"
+};
+
+/**
+ * Metric bucket limits.
+ *
+ * The limits in seconds of the stage histogram buckets exposed by WriteMetrics().
+ */
+static const double kMetricBuckets [] =
+{
+	0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+	0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+};
+
+
+/*===================================================================================
+ *	GetBucket																		*
+ *==================================================================================*/
+
+/**
+ * Get histogram bucket.
+ *
+ * This function will return the histogram bucket of the provided duration: durations
+ * below <i>2 ^ kSTAT_Precision</i> have a bucket each, larger durations are bucketed by
+ * their highest bit and the <i>kSTAT_Precision</i> bits that follow it.
+ *
+ * @param UInt64			theTicks			Duration.
+ *
+ * @access private
+ * @return int
+ */
+static inline int GetBucket( UInt64 theTicks )
+{
+	if( theTicks < (1 << kSTAT_Precision) )
+		return (int) theTicks;													// ==>
+
+	int bit = 63 - __builtin_clzll( theTicks );
+	int shift = bit - kSTAT_Precision;
+	return ((shift + 1) << kSTAT_Precision)
+		 + (int) ((theTicks >> shift) & ((1 << kSTAT_Precision) - 1));			// ==>
+
+} // GetBucket.
+
+
+/*===================================================================================
+ *	GetBucketValue																	*
+ *==================================================================================*/
+
+/**
+ * Get histogram bucket value.
+ *
+ * This function will return the duration represented by the provided bucket, the middle
+ * of its range.
+ *
+ * @param int				theBucket			Bucket.
+ *
+ * @access private
+ * @return double
+ */
+static double GetBucketValue( int theBucket )
+{
+	if( theBucket < (1 << kSTAT_Precision) )
+		return theBucket;														// ==>
+
+	int shift = (theBucket >> kSTAT_Precision) - 1;
+	UInt64 low = ((UInt64) (1 << kSTAT_Precision)
+			   + (theBucket & ((1 << kSTAT_Precision) - 1))) << shift;
+	return low + ((double) ((UInt64) 1 << shift) / 2);							// ==>
+
+} // GetBucketValue.
+
+
+/*===================================================================================
+ *	GetBucketLimit																	*
+ *==================================================================================*/
+
+/**
+ * Get histogram bucket limit.
+ *
+ * This function will return the smallest duration above the range of the provided
+ * bucket.
+ *
+ * @param int				theBucket			Bucket.
+ *
+ * @access private
+ * @return double
+ */
+static double GetBucketLimit( int theBucket )
+{
+	if( theBucket < (1 << kSTAT_Precision) )
+		return theBucket + 1;													// ==>
+
+	int shift = (theBucket >> kSTAT_Precision) - 1;
+	UInt64 low = ((UInt64) (1 << kSTAT_Precision)
+			   + (theBucket & ((1 << kSTAT_Precision) - 1))) << shift;
+	return low + (double) ((UInt64) 1 << shift);								// ==>
+
+} // GetBucketLimit.
+
+
+/*===================================================================================
+ *	GetScale																		*
+ *==================================================================================*/
+
+/**
+ * Get tick duration.
+ *
+ * This function will return the duration of a tick in seconds, measured from the ticks
+ * and the monotonic clock elapsed since StartStats(), and set the elapsed seconds.
+ *
+ * @param double *			theElapsed			Receives elapsed seconds.
+ *
+ * @access private
+ * @return double
+ */
+static double GetScale( double * theElapsed )
+{
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	UInt64 ticks = GetTicks() - startTicks;
+	*theElapsed = (now.tv_sec - startTime.tv_sec)
+				+ ((now.tv_nsec - startTime.tv_nsec) / 1e9);
+
+	return ( ticks ) ? (*theElapsed / ticks) : 0;								// ==>
+
+} // GetScale.
+
+
+/*===================================================================================
+ *	GetPercentile																	*
+ *==================================================================================*/
+
+/**
+ * Get stage percentile.
+ *
+ * This function will return the duration in ticks below which the provided fraction of
+ * the recorded durations of the provided stage fall, bounded by the longest duration.
+ *
+ * @param int				theStage			Stage.
+ * @param double			theFraction			Fraction [0 - 1].
+ *
+ * @access private
+ * @return double
+ */
+static double GetPercentile( int theStage, double theFraction )
+{
+	UInt64 rank = (UInt64) ceil( theFraction * stageCount[ theStage ] );
+	if( ! rank )
+		rank = 1;
+	UInt64 seen = 0;
+	for( int bucket = 0; bucket < kSTAT_Buckets; bucket++ )
+	{
+		seen += stageBuckets[ theStage ][ bucket ];
+		if( seen >= rank )
+			return min( GetBucketValue( bucket ),
+						(double) stageMax[ theStage ] );						// ==>
+	}
+
+	return stageMax[ theStage ];												// ==>
+
+} // GetPercentile.
+
+
+/*===================================================================================
+ *	StartStats																		*
+ *==================================================================================*/
+
+/**
+ * Start statistics.
+ *
+ * This function will clear the counters and take the start ticks, time and resource
+ * usage, against which the statistics are written.
+ *
+ * @access public
+ * @return void
+ */
+void StartStats()
+{
+	memset( stageCount, 0, sizeof( stageCount ) );
+	memset( stageTotal, 0, sizeof( stageTotal ) );
+	memset( stageMax, 0, sizeof( stageMax ) );
+	memset( stageBuckets, 0, sizeof( stageBuckets ) );
+	memset( counters, 0, sizeof( counters ) );
+	memset( gauges, 0, sizeof( gauges ) );
+	readBytes = 0;
+	readCalls = 0;
+	layerBytes.clear();
+	points.clear();
+	batchPoints = 0;
+	batchCells = 0;
+
+	getrusage( RUSAGE_SELF, &startUsage );
+	clock_gettime( CLOCK_MONOTONIC, &startTime );
+	startTicks = GetTicks();
+
+} // StartStats.
+
+
+/*===================================================================================
+ *	AddStage																		*
+ *==================================================================================*/
+
+/**
+ * Record stage duration.
+ *
+ * This function will record in the provided stage histogram the ticks elapsed since the
+ * provided start ticks, and return the current ticks, which callers use as the start of
+ * the next stage.
+ *
+ * @param int				theStage			Stage, one of the kSTAT_ constants.
+ * @param UInt64			theStart			Stage start ticks.
+ *
+ * @access public
+ * @return UInt64
+ */
+UInt64 AddStage( int theStage, UInt64 theStart )
+{
+	UInt64 now = GetTicks();
+	UInt64 ticks = ( now > theStart ) ? (now - theStart) : 0;
+	stageCount[ theStage ]++;
+	stageTotal[ theStage ] += ticks;
+	if( ticks > stageMax[ theStage ] )
+		stageMax[ theStage ] = ticks;
+	stageBuckets[ theStage ][ GetBucket( ticks ) ]++;
+
+	return now;																	// ==>
+
+} // AddStage.
+
+
+/*===================================================================================
+ *	AddReads																		*
+ *==================================================================================*/
+
+/**
+ * Record band reads.
+ *
+ * This function will account the provided number of bytes and of read system calls;
+ * values copied from mapped files are accounted without calls.
+ *
+ * @param UInt64			theBytes			Bytes read.
+ * @param UInt64			theCalls			System calls.
+ *
+ * @access public
+ * @return void
+ */
+void AddReads( UInt64 theBytes, UInt64 theCalls )
+{
+	readBytes += theBytes;
+	readCalls += theCalls;
+
+} // AddReads.
+
+
+/*===================================================================================
+ *	AddLayerReads																	*
+ *==================================================================================*/
+
+/**
+ * Record layer band reads.
+ *
+ * This function will account the provided number of bytes and of read system calls, as
+ * AddReads() does, and add the bytes to the provided layer.
+ *
+ * @param int				theLayer			Layer index, -1 for elevation tiles.
+ * @param UInt64			theBytes			Bytes read.
+ * @param UInt64			theCalls			System calls.
+ *
+ * @access public
+ * @return void
+ */
+void AddLayerReads( int theLayer, UInt64 theBytes, UInt64 theCalls )
+{
+	readBytes += theBytes;
+	readCalls += theCalls;
+	size_t index = theLayer + 1;
+	if( index >= layerBytes.size() )
+		layerBytes.resize( index + 1, 0 );
+	layerBytes[ index ] += theBytes;
+
+} // AddLayerReads.
+
+
+/*===================================================================================
+ *	GetReads																		*
+ *==================================================================================*/
+
+/**
+ * Get band reads.
+ *
+ * This function will return the bytes and read system calls accounted so far, callers
+ * take the difference of two readings to get the reads of an operation.
+ *
+ * @param UInt64 *			theBytes			Receives bytes read.
+ * @param UInt64 *			theCalls			Receives system calls.
+ *
+ * @access public
+ * @return void
+ */
+void GetReads( UInt64 * theBytes, UInt64 * theCalls )
+{
+	*theBytes = readBytes;
+	*theCalls = readCalls;
+
+} // GetReads.
+
+
+/*===================================================================================
+ *	GetAllocations																	*
+ *==================================================================================*/
+
+/**
+ * Get heap allocations.
+ *
+ * This function will return the number of heap allocations made so far, callers take
+ * the difference of two readings; it returns 0 unless built with
+ * <i>STATS_ALLOCATIONS</i>.
+ *
+ * @access public
+ * @return UInt64
+ */
+UInt64 GetAllocations()
+{
+	return allocations;															// ==>
+
+} // GetAllocations.
+
+
+#ifdef STATS_ALLOCATIONS
+
+/*===================================================================================
+ *	operator new																	*
+ *==================================================================================*/
+
+/**
+ * Allocate memory.
+ *
+ * This function replaces the global allocation function to count the allocations, the
+ * array forms default to these.
+ *
+ * @param size_t			theSize				Size in bytes.
+ *
+ * @access public
+ * @return void *
+ */
+void * operator new( size_t theSize )
+{
+	allocations++;
+	void * memory = malloc( ( theSize ) ? theSize : 1 );
+	if( memory == NULL )
+		throw bad_alloc();
+
+	return memory;																// ==>
+
+} // operator new.
+
+
+/*===================================================================================
+ *	operator delete																	*
+ *==================================================================================*/
+
+/**
+ * Release memory.
+ *
+ * This function replaces the global deallocation function, pairing operator new.
+ *
+ * @param void *			theMemory			Memory.
+ *
+ * @access public
+ * @return void
+ */
+void operator delete( void * theMemory ) throw()
+{
+	free( theMemory );
+
+} // operator delete.
+
+#ifdef __cpp_sized_deallocation
+/**
+ * Release sized memory.
+ *
+ * This function replaces the sized global deallocation function of the compilers that
+ * provide it, so that it pairs operator new as well.
+ *
+ * @param void *			theMemory			Memory.
+ * @param size_t			theSize				Size in bytes.
+ *
+ * @access public
+ * @return void
+ */
+void operator delete( void * theMemory, size_t theSize ) throw()
+{
+	(void) theSize;
+	free( theMemory );
+
+} // operator delete.
+#endif
+
+#endif // STATS_ALLOCATIONS
+
+
+/*===================================================================================
+ *	AddCount																		*
+ *==================================================================================*/
+
+/**
+ * Increment counter.
+ *
+ * This function will increment the provided counter.
+ *
+ * @param int				theCounter			Counter, one of the kCOUNT_ constants.
+ *
+ * @access public
+ * @return void
+ */
+void AddCount( int theCounter )
+{
+	counters[ theCounter ]++;
+
+} // AddCount.
+
+
+/*===================================================================================
+ *	AddPoint																		*
+ *==================================================================================*/
+
+/**
+ * Record point.
+ *
+ * This function will count a point by its result code.
+ *
+ * @param int				theStatus			Result code, one of the kERROR_ constants.
+ *
+ * @access public
+ * @return void
+ */
+void AddPoint( int theStatus )
+{
+	points[ theStatus ]++;
+
+} // AddPoint.
+
+
+/*===================================================================================
+ *	AddCells																		*
+ *==================================================================================*/
+
+/**
+ * Record batch cells.
+ *
+ * This function will count the points of a batch and the distinct cells they fall in,
+ * which are the cells actually read.
+ *
+ * @param UInt64			thePoints			Number of points.
+ * @param UInt64			theCells			Number of distinct cells.
+ *
+ * @access public
+ * @return void
+ */
+void AddCells( UInt64 thePoints, UInt64 theCells )
+{
+	batchPoints += thePoints;
+	batchCells += theCells;
+
+} // AddCells.
+
+
+/*===================================================================================
+ *	SetGauge																		*
+ *==================================================================================*/
+
+/**
+ * Set gauge.
+ *
+ * This function will set the provided gauge to the provided value.
+ *
+ * @param int				theGauge			Gauge, one of the kGAUGE_ constants.
+ * @param UInt64			theValue			Value.
+ *
+ * @access public
+ * @return void
+ */
+void SetGauge( int theGauge, UInt64 theValue )
+{
+	gauges[ theGauge ] = theValue;
+
+} // SetGauge.
+
+
+/*===================================================================================
+ *	WriteStats																		*
+ *==================================================================================*/
+
+/**
+ * Write statistics.
+ *
+ * This function will write to the provided stream a line per recorded stage, holding the
+ * number of durations, their mean, 50th, 90th and 99th percentiles and maximum in
+ * microseconds, followed by the I/O counters and the page faults since StartStats(),
+ * the number of points by result code if any were recorded and the number of batch
+ * points and of the distinct cells they fall in.
+ *
+ * @param ostream &			theStream			Output stream.
+ *
+ * @access public
+ * @return void
+ */
+void WriteStats( ostream & theStream )
+{
+	//
+	// Calibrate ticks.
+	//
+	double elapsed;
+	double scale = GetScale( &elapsed ) * 1e6;
+	elapsed *= 1e6;
+
+	//
+	// Write stages.
+	//
+	ios::fmtflags flags = theStream.flags();
+	theStream << fixed << setprecision( 1 );
+	theStream << left << setw( 10 ) << "stage" << right
+			  << setw( 12 ) << "count"
+			  << setw( 12 ) << "mean_us"
+			  << setw( 12 ) << "p50_us"
+			  << setw( 12 ) << "p90_us"
+			  << setw( 12 ) << "p99_us"
+			  << setw( 12 ) << "max_us" << '\n';
+	for( int stage = 0; stage < kSTAT_Stages; stage++ )
+	{
+		if( ! stageCount[ stage ] )
+			continue;															// =>
+
+		theStream << left << setw( 10 ) << kStageNames[ stage ] << right
+				  << setw( 12 ) << stageCount[ stage ]
+				  << setw( 12 ) << (stageTotal[ stage ] * scale / stageCount[ stage ])
+				  << setw( 12 ) << (GetPercentile( stage, 0.50 ) * scale)
+				  << setw( 12 ) << (GetPercentile( stage, 0.90 ) * scale)
+				  << setw( 12 ) << (GetPercentile( stage, 0.99 ) * scale)
+				  << setw( 12 ) << (stageMax[ stage ] * scale) << '\n';
+	}
+
+	//
+	// Write counters.
+	//
+	struct rusage usage;
+	getrusage( RUSAGE_SELF, &usage );
+	theStream << "elapsed_us " << elapsed << '\n'
+			  << "read_bytes " << readBytes << '\n'
+			  << "read_calls " << readCalls << '\n'
+			  << "minor_faults " << (usage.ru_minflt - startUsage.ru_minflt) << '\n'
+			  << "major_faults " << (usage.ru_majflt - startUsage.ru_majflt) << '\n';
+	for( map<int, UInt64>::const_iterator point = points.begin();
+		 point != points.end();
+		 ++point )
+		theStream << "points_" << point->first << ' ' << point->second << '\n';
+	if( batchPoints )
+		theStream << "batch_points " << batchPoints << '\n'
+				  << "batch_cells " << batchCells << '\n';
+	theStream.flags( flags );
+
+} // WriteStats.
+
+
+/*===================================================================================
+ *	GetHugePages																	*
+ *==================================================================================*/
+
+/**
+ * Get huge page bytes.
+ *
+ * This function will return the number of bytes of the process mappings backed by huge
+ * pages, anonymous and file backed, as reported by <i>/proc/self/smaps_rollup</i>; it
+ * will return 0 where the file is not available.
+ *
+ * @access private
+ * @return UInt64
+ */
+static UInt64 GetHugePages()
+{
+	UInt64 bytes = 0;
+	ifstream rollup( "/proc/self/smaps_rollup" );
+	string line;
+	while( getline( rollup, line ) )
+	{
+		if( (line.compare( 0, 14, "AnonHugePages:" ) == 0)
+		 || (line.compare( 0, 15, "ShmemPmdMapped:" ) == 0)
+		 || (line.compare( 0, 14, "FilePmdMapped:" ) == 0) )
+			bytes += (UInt64) strtoul( line.c_str() + line.find( ':' ) + 1, NULL, 10 )
+				   << 10;
+	}
+
+	return bytes;																// ==>
+
+} // GetHugePages.
+
+
+/*===================================================================================
+ *	WriteMetrics																	*
+ *==================================================================================*/
+
+/**
+ * Write metrics.
+ *
+ * This function will write to the provided stream all the counters in the Prometheus
+ * text exposition format: the server request and query counters, the points by result
+ * code, the batch points and distinct cells, a histogram in seconds per recorded stage,
+ * the bytes read per layer, named from the provided layer names, the read system calls,
+ * the page faults, the huge page bytes and the server gauges. Stage durations are
+ * counted in the first bucket whose limit is not below their histogram bucket, so bucket
+ * counts are within the histogram precision.
+ *
+ * @param ostream &			theStream			Output stream.
+ * @param const vector<string> &	theLayers	Layer names, by layer index.
+ *
+ * @access public
+ * @return void
+ */
+void WriteMetrics( ostream & theStream, const vector<string> & theLayers )
+{
+	double elapsed;
+	double scale = GetScale( &elapsed );
+	struct rusage usage;
+	getrusage( RUSAGE_SELF, &usage );
+	ios::fmtflags flags = theStream.flags();
+	theStream << setprecision( 9 );
+
+	//
+	// Write request counters.
+	//
+	theStream << "# HELP geofeatures_requests_total Requests admitted, by priority.\n"
+			  << "# TYPE geofeatures_requests_total counter\n";
+	for( int counter = kCOUNT_Interactive; counter <= kCOUNT_Batch; counter++ )
+		theStream << "geofeatures_requests_total{priority=\""
+				  << kCounterNames[ counter ] << "\"} " << counters[ counter ] << '\n';
+	theStream << "# HELP geofeatures_rejected_total Requests answered with 503.\n"
+			  << "# TYPE geofeatures_rejected_total counter\n"
+			  << "geofeatures_rejected_total " << counters[ kCOUNT_Rejected ] << '\n';
+	theStream << "# HELP geofeatures_queries_total Queries handled, by type.\n"
+			  << "# TYPE geofeatures_queries_total counter\n";
+	for( int counter = kCOUNT_Location; counter <= kCOUNT_Stats; counter++ )
+		theStream << "geofeatures_queries_total{type=\""
+				  << kCounterNames[ counter ] << "\"} " << counters[ counter ] << '\n';
+	theStream << "# HELP geofeatures_coalesced_total Location queries answered from the "
+			  << "reads of a query in progress.\n"
+			  << "# TYPE geofeatures_coalesced_total counter\n"
+			  << "geofeatures_coalesced_total " << counters[ kCOUNT_Coalesced ] << '\n';
+	theStream << "# HELP geofeatures_points_total Points answered, by result code, 0 is "
+			  << "success.\n"
+			  << "# TYPE geofeatures_points_total counter\n";
+	for( map<int, UInt64>::const_iterator point = points.begin();
+		 point != points.end();
+		 ++point )
+		theStream << "geofeatures_points_total{code=\"" << point->first << "\"} "
+				  << point->second << '\n';
+	theStream << "# HELP geofeatures_batch_points_total Points of batch queries.\n"
+			  << "# TYPE geofeatures_batch_points_total counter\n"
+			  << "geofeatures_batch_points_total " << batchPoints << '\n'
+			  << "# HELP geofeatures_batch_cells_total Distinct cells read by batch "
+			  << "queries.\n"
+			  << "# TYPE geofeatures_batch_cells_total counter\n"
+			  << "geofeatures_batch_cells_total " << batchCells << '\n';
+
+	//
+	// Write stage histograms.
+	//
+	theStream << "# HELP geofeatures_stage_seconds Query stage durations.\n"
+			  << "# TYPE geofeatures_stage_seconds histogram\n";
+	size_t limits = sizeof( kMetricBuckets ) / sizeof( kMetricBuckets[ 0 ] );
+	for( int stage = 0; stage < kSTAT_Stages; stage++ )
+	{
+		if( ! stageCount[ stage ] )
+			continue;															// =>
+
+		UInt64 count = 0;
+		int bucket = 0;
+		for( size_t limit = 0; limit < limits; limit++ )
+		{
+			while( (bucket < kSTAT_Buckets)
+				&& ((GetBucketLimit( bucket ) * scale) <= kMetricBuckets[ limit ]) )
+				count += stageBuckets[ stage ][ bucket++ ];
+			theStream << "geofeatures_stage_seconds_bucket{stage=\""
+					  << kStageNames[ stage ] << "\",le=\""
+					  << kMetricBuckets[ limit ] << "\"} " << count << '\n';
+		}
+		theStream << "geofeatures_stage_seconds_bucket{stage=\""
+				  << kStageNames[ stage ] << "\",le=\"+Inf\"} "
+				  << stageCount[ stage ] << '\n'
+				  << "geofeatures_stage_seconds_sum{stage=\""
+				  << kStageNames[ stage ] << "\"} " << (stageTotal[ stage ] * scale) << '\n'
+				  << "geofeatures_stage_seconds_count{stage=\""
+				  << kStageNames[ stage ] << "\"} " << stageCount[ stage ] << '\n';
+	}
+
+	//
+	// Write I/O counters.
+	// Layers are matched by index, elevation tiles come first.
+	//
+	theStream << "# HELP geofeatures_read_bytes_total Bytes read, by layer.\n"
+			  << "# TYPE geofeatures_read_bytes_total counter\n";
+	for( size_t index = 0; index < layerBytes.size(); index++ )
+	{
+		if( (! layerBytes[ index ])
+		 || (index > theLayers.size()) )
+			continue;															// =>
+		theStream << "geofeatures_read_bytes_total{layer=\""
+				  << ( ( index ) ? theLayers[ index - 1 ] : string( "elevation" ) )
+				  << "\"} " << layerBytes[ index ] << '\n';
+	}
+	theStream << "# HELP geofeatures_read_calls_total Read system calls.\n"
+			  << "# TYPE geofeatures_read_calls_total counter\n"
+			  << "geofeatures_read_calls_total " << readCalls << '\n'
+			  << "# HELP geofeatures_page_faults_total Page faults, major faults are page "
+			  << "cache misses.\n"
+			  << "# TYPE geofeatures_page_faults_total counter\n"
+			  << "geofeatures_page_faults_total{kind=\"minor\"} "
+			  << (usage.ru_minflt - startUsage.ru_minflt) << '\n'
+			  << "geofeatures_page_faults_total{kind=\"major\"} "
+			  << (usage.ru_majflt - startUsage.ru_majflt) << '\n';
+
+	//
+	// Write gauges.
+	//
+	theStream << "# HELP geofeatures_connections Open connections.\n"
+			  << "# TYPE geofeatures_connections gauge\n"
+			  << "geofeatures_connections " << gauges[ kGAUGE_Connections ] << '\n'
+			  << "# HELP geofeatures_queued_requests Requests waiting for admission.\n"
+			  << "# TYPE geofeatures_queued_requests gauge\n"
+			  << "geofeatures_queued_requests " << gauges[ kGAUGE_Queued ] << '\n'
+			  << "# HELP geofeatures_active_requests Requests in progress.\n"
+			  << "# TYPE geofeatures_active_requests gauge\n"
+			  << "geofeatures_active_requests " << gauges[ kGAUGE_Active ] << '\n'
+			  << "# HELP geofeatures_pending_reads File reads queued or in flight.\n"
+			  << "# TYPE geofeatures_pending_reads gauge\n"
+			  << "geofeatures_pending_reads " << gauges[ kGAUGE_Reads ] << '\n'
+			  << "# HELP geofeatures_mapped_files Mapped dataset files.\n"
+			  << "# TYPE geofeatures_mapped_files gauge\n"
+			  << "geofeatures_mapped_files " << gauges[ kGAUGE_Maps ] << '\n'
+			  << "# HELP geofeatures_locked_bytes Mapped dataset bytes locked in memory.\n"
+			  << "# TYPE geofeatures_locked_bytes gauge\n"
+			  << "geofeatures_locked_bytes " << gauges[ kGAUGE_Locked ] << '\n'
+			  << "# HELP geofeatures_lock_shortfall_bytes Locked memory budget that could "
+			  << "not be locked.\n"
+			  << "# TYPE geofeatures_lock_shortfall_bytes gauge\n"
+			  << "geofeatures_lock_shortfall_bytes " << gauges[ kGAUGE_Shortfall ] << '\n'
+			  << "# HELP geofeatures_huge_page_bytes Mapped bytes backed by huge pages.\n"
+			  << "# TYPE geofeatures_huge_page_bytes gauge\n"
+			  << "geofeatures_huge_page_bytes " << GetHugePages() << '\n'
+			  << "# HELP geofeatures_uptime_seconds Seconds since the server started.\n"
+			  << "# TYPE geofeatures_uptime_seconds gauge\n"
+			  << "geofeatures_uptime_seconds " << elapsed << '\n';
+	theStream.flags( flags );
+
+} // WriteMetrics.
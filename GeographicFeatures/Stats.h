@@ -0,0 +1,234 @@
+/**
+ * Statistics definitions.
+ *
+ * This file contains the declarations of the instrumentation counters: the duration of
+ * each stage of a query is recorded in a histogram per stage, measured with the processor
+ * time stamp counter, along with the bytes and system calls of the band reads and the
+ * server request counters and gauges.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <ctime>
+#include <vector>
+#include "Types.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#elif defined( __APPLE__ )
+#include <mach/mach_time.h>
+#endif
+
+using namespace std;
+
+
+/**
+ * Stages.
+ *
+ * These constants hold the stages of a query whose durations are recorded:
+ *
+ * <ul>
+ *	<li><i>kSTAT_Parse</i>: Coordinates and parameters parsing.
+ *	<li><i>kSTAT_Open</i>: Dataset loading, manifest parsing and file opens.
+ *	<li><i>kSTAT_Lookup</i>: Tile and cell offsets lookup of the reads.
+ *	<li><i>kSTAT_Read</i>: Band reads, including the decoding of the values; in the
+ *		server with a read queue, the time from queueing to completion.
+ *	<li><i>kSTAT_Derive</i>: Derived features computation.
+ *	<li><i>kSTAT_Format</i>: XML document writing.
+ *	<li><i>kSTAT_Request</i>: Server requests, from handling to response.
+ * </ul>
+ */
+const int kSTAT_Parse = 0;
+const int kSTAT_Open = 1;
+const int kSTAT_Lookup = 2;
+const int kSTAT_Read = 3;
+const int kSTAT_Derive = 4;
+const int kSTAT_Format = 5;
+const int kSTAT_Request = 6;
+const int kSTAT_Stages = 7;
+
+/**
+ * Counters.
+ *
+ * These constants hold the server event counters:
+ *
+ * <ul>
+ *	<li><i>kCOUNT_Interactive</i>: Interactive requests admitted to the queue.
+ *	<li><i>kCOUNT_Batch</i>: Batch requests admitted to the queue.
+ *	<li><i>kCOUNT_Rejected</i>: Requests answered with <i>503</i>.
+ *	<li><i>kCOUNT_Location</i>: Location queries answered.
+ *	<li><i>kCOUNT_Invalid</i>: Queries with missing or invalid parameters.
+ *	<li><i>kCOUNT_Stats</i>: Statistics and metrics requests.
+ *	<li><i>kCOUNT_Coalesced</i>: Location queries answered from the reads of a query in
+ *		progress, rather than with their own reads.
+ * </ul>
+ */
+const int kCOUNT_Interactive = 0;
+const int kCOUNT_Batch = 1;
+const int kCOUNT_Rejected = 2;
+const int kCOUNT_Location = 3;
+const int kCOUNT_Invalid = 4;
+const int kCOUNT_Stats = 5;
+const int kCOUNT_Coalesced = 6;
+const int kCOUNT_Counters = 7;
+
+/**
+ * Gauges.
+ *
+ * These constants hold the server gauges, set by their owners as they change:
+ *
+ * <ul>
+ *	<li><i>kGAUGE_Connections</i>: Open connections.
+ *	<li><i>kGAUGE_Queued</i>: Requests waiting for admission.
+ *	<li><i>kGAUGE_Active</i>: Requests in progress.
+ *	<li><i>kGAUGE_Reads</i>: File reads queued or in flight.
+ *	<li><i>kGAUGE_Maps</i>: Mapped files, of the current and replaced datasets.
+ *	<li><i>kGAUGE_Locked</i>: Bytes of the mapped files locked in memory, of the current
+ *		and replaced datasets.
+ *	<li><i>kGAUGE_Shortfall</i>: Bytes of the locked memory budget of the current dataset
+ *		that could not be locked.
+ * </ul>
+ */
+const int kGAUGE_Connections = 0;
+const int kGAUGE_Queued = 1;
+const int kGAUGE_Active = 2;
+const int kGAUGE_Reads = 3;
+const int kGAUGE_Maps = 4;
+const int kGAUGE_Locked = 5;
+const int kGAUGE_Shortfall = 6;
+const int kGAUGE_Gauges = 7;
+
+/**
+ * Histogram precision.
+ *
+ * This constant holds the number of bits of a duration kept by the histograms: each power
+ * of two is split into <i>2 ^ kSTAT_Precision</i> buckets, so that durations are
+ * recorded within 12.5%.
+ */
+const int kSTAT_Precision = 3;
+
+/**
+ * Histogram buckets.
+ *
+ * This constant holds the number of buckets of a stage histogram, covering all 64 bit
+ * durations.
+ */
+const int kSTAT_Buckets = 64 << kSTAT_Precision;
+
+/**
+ * GetTicks.
+ *
+ * Get the current time in ticks.
+ *
+ * The processor time stamp counter is read where available, it costs a few cycles and
+ * no system call; ticks are converted to time when the statistics are written.
+ */
+inline UInt64 GetTicks()
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+	return __rdtsc();
+#elif defined( __APPLE__ )
+	return mach_absolute_time();
+#else
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return ((UInt64) now.tv_sec * 1000000000) + now.tv_nsec;
+#endif
+}
+
+/**
+ * StartStats.
+ *
+ * Start recording statistics.
+ */
+void StartStats();
+
+/**
+ * AddStage.
+ *
+ * Record a stage duration.
+ */
+UInt64 AddStage( int theStage, UInt64 theStart );
+
+/**
+ * AddReads.
+ *
+ * Record band reads.
+ */
+void AddReads( UInt64 theBytes, UInt64 theCalls );
+
+/**
+ * AddLayerReads.
+ *
+ * Record band reads of a layer.
+ */
+void AddLayerReads( int theLayer, UInt64 theBytes, UInt64 theCalls );
+
+/**
+ * GetReads.
+ *
+ * Get band reads.
+ */
+void GetReads( UInt64 * theBytes, UInt64 * theCalls );
+
+/**
+ * GetAllocations.
+ *
+ * Get heap allocations.
+ */
+UInt64 GetAllocations();
+
+/**
+ * AddPoint.
+ *
+ * Record a point result.
+ */
+void AddPoint( int theStatus );
+
+/**
+ * AddCells.
+ *
+ * Record batch points and distinct cells.
+ */
+void AddCells( UInt64 thePoints, UInt64 theCells );
+
+/**
+ * AddCount.
+ *
+ * Increment a counter.
+ */
+void AddCount( int theCounter );
+
+/**
+ * SetGauge.
+ *
+ * Set a gauge.
+ */
+void SetGauge( int theGauge, UInt64 theValue );
+
+/**
+ * WriteStats.
+ *
+ * Write statistics.
+ */
+void WriteStats( ostream & theStream );
+
+/**
+ * WriteMetrics.
+ *
+ * Write statistics in the Prometheus text format.
+ */
+void WriteMetrics( ostream & theStream, const vector<string> & theLayers );
+
+#endif // STATS_H
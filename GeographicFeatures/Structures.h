@@ -10,11 +10,19 @@
  *	@version	1.00 06/01/2010
  */
 
+#ifndef STRUCTURES_H
+#define STRUCTURES_H
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
-#include <CoreServices/CoreServices.h>
+#include <vector>
+#include <deque>
+#include <list>
+#include <map>
+#include <ctime>
+#include "Types.h"
 
 using namespace std;
 
@@ -66,6 +74,8 @@ struct AREA_T
  *			 </ul>
  *		 </ul>
  *	 </ul>
+ *	<li><b>path</b>: The path of the tile files relative to the base directory, without
+ *		extension.
  *	<li><b>area</b>: Tile area bounds:
  *	 <ul>
  *		<li><b>latMin</b>: Minimum latitude of the tile.
@@ -73,20 +83,34 @@ struct AREA_T
  *		<li><b>lonMin</b>: Minimum longitude of the tile.
  *		<li><b>lonMin</b>: Maximum longitude of the tile.
  *	 </ul>
+ *	<li><b>countY</b>: Number of rows at the default resolution.
+ *	<li><b>countX</b>: Number of columns at the default resolution.
  * </ul>
+ *
+ * The structure holds no objects, so that the built-in tables are initialised at compile
+ * time and are read-only.
  */
 struct TILES_T
 {
-	string name;		// Tile name.
+	const char * name;	// Tile name.
+	const char * path;	// Files path.
 	AREA_T area;		// Tile area.
+	UInt32 countY;		// Number of rows.
+	UInt32 countX;		// Number of columns.
 };
 
 /**
  * WORLDCLIM file structure.
  *
- * This structure contains the information regarding the WORLDCLIM file data:
+ * This structure contains the information regarding the WORLDCLIM file data, like
+ * <i>{@link TILES_T TILES_T}</i> it holds no objects:
  *
  * <ul>
+ *	<li><b>name</b>: Layer name.
+ *	<li><b>source</b>: Layer description.
+ *	<li><b>path</b>: File path relative to the base directory, monthly layers hold the
+ *		month number pattern.
+ *	<li><b>months</b>: Number of months, or 0.
  *	<li><b>latMin</b>: Minimum latitude of the tile.
  *	<li><b>latMax</b>: Maximum latitude of the tile.
  *	<li><b>lonMin</b>: Minimum longitude of the tile.
@@ -97,13 +121,731 @@ struct TILES_T
  */
 struct WORLDCLIM_T
 {
-	string name;		// Tile name.
-	string source;		// Data source.
+	const char * name;	// Tile name.
+	const char * source;	// Data source.
+	const char * path;	// File path.
 	int months;			// Number of months.
 	double latMin;		// Minimum latitude.
 	double latMax;		// Maximum latitude.
 	double lonMin;		// Minimum longitude.
 	double lonMax;		// Maximum longitude.
-	double countY;		// Number of rows (latitude points).
-	double countX;		// Number of columns (longitude points).
+	UInt32 countY;		// Number of rows (latitude points).
+	UInt32 countX;		// Number of columns (longitude points).
+};
+
+/**
+ * Derived layer structure.
+ *
+ * This structure contains the information regarding the built-in derived layers:
+ *
+ * <ul>
+ *	<li><b>name</b>: Layer name.
+ *	<li><b>source</b>: Layer description.
+ *	<li><b>kind</b>: Derived layer kind, one of the <i>kDERIVED_</i> constants.
+ *	<li><b>base</b>: Base temperature in degrees of growing degree days layers.
+ * </ul>
+ */
+struct DERIVED_T
+{
+	const char * name;	// Layer name.
+	const char * source;	// Description.
+	int kind;			// Derived kind.
+	double base;		// Base temperature.
+};
+
+/**
+ * Band structure.
+ *
+ * This structure contains the runtime information of a single raster file, a band is
+ * either a GTOPO-30 tile file, or a WORLDCLIM layer file for a specific month; the file is
+ * opened and mapped once when the dataset is loaded:
+ *
+ * <ul>
+ *	<li><b>path</b>: Resolved file path.
+ *	<li><b>layer</b>: Owner layer index, or -1 for GTOPO-30 tiles.
+ *	<li><b>month</b>: Month [1 - 12], or 0 if the layer has no monthly series or if the
+ *		file holds all months.
+ *	<li><b>months</b>: Number of months stored per cell, more than 1 if the file is a
+ *		band interleaved by pixel cube holding all the months of a cell adjacent.
+ *	<li><b>type</b>: Sample type, one of the <i>kTYPE_</i> constants.
+ *	<li><b>swapped</b>: Set if the samples are stored in the byte order opposite to the
+ *		host byte order.
+ *	<li><b>pointSize</b>: Size in bytes of a data point.
+ *	<li><b>stride</b>: Size in bytes of a row.
+ *	<li><b>points</b>: Number of data points in the file, cells times months.
+ *	<li><b>fd</b>: Open file descriptor, or -1 if the file could not be opened.
+ *	<li><b>data</b>: Mapped file contents, or NULL if the file could not be mapped.
+ *	<li><b>size</b>: File size in bytes.
+ *	<li><b>locked</b>: Number of bytes of the mapped contents locked in memory.
+ * </ul>
+ */
+struct BAND_T
+{
+	string path;		// File path.
+	int layer;			// Layer index.
+	int month;			// Month.
+	int months;			// Months per cell.
+	int type;			// Sample type.
+	bool swapped;		// Opposite byte order.
+	int pointSize;		// Point size in bytes.
+	UInt64 stride;		// Row size in bytes.
+	UInt64 points;		// Number of points.
+	int fd;				// File descriptor.
+	const char * data;	// Mapped data.
+	UInt64 size;		// File size.
+	UInt64 locked;		// Locked bytes.
+};
+
+/**
+ * Grid structure.
+ *
+ * This structure contains the geometry of a raster grid, it is shared by GTOPO-30 tiles
+ * and WORLDCLIM layers:
+ *
+ * <ul>
+ *	<li><b>area</b>: Grid bounds.
+ *	<li><b>countY</b>: Number of rows (latitude points).
+ *	<li><b>countX</b>: Number of columns (longitude points).
+ *	<li><b>pointsY</b>: Number of rows per latitude degree.
+ *	<li><b>pointsX</b>: Number of columns per longitude degree.
+ *	<li><b>unitY</b>: Height of a cell in degrees.
+ *	<li><b>unitX</b>: Width of a cell in degrees.
+ * </ul>
+ */
+struct GRID_T
+{
+	AREA_T area;		// Grid area.
+	UInt64 countY;		// Number of rows.
+	UInt64 countX;		// Number of columns.
+	double pointsY;		// Rows per degree.
+	double pointsX;		// Columns per degree.
+	double unitY;		// Cell height.
+	double unitX;		// Cell width.
+};
+
+/**
+ * Tile descriptor structure.
+ *
+ * This structure contains the runtime information of a GTOPO-30 tile:
+ *
+ * <ul>
+ *	<li><b>name</b>: Tile name.
+ *	<li><b>grid</b>: Tile grid.
+ *	<li><b>dem</b>: Index of the elevation band.
+ *	<li><b>src</b>: Index of the source map band.
+ * </ul>
+ */
+struct TILE_T
+{
+	string name;		// Tile name.
+	GRID_T grid;		// Tile grid.
+	int dem;			// Elevation band.
+	int src;			// Source band.
+};
+
+/**
+ * Layer descriptor structure.
+ *
+ * This structure contains the runtime information of a WORLDCLIM layer, the layer
+ * owns <i>months</i> consecutive bands starting at <i>band</i>, or a single band if the
+ * layer has no monthly series:
+ *
+ * <ul>
+ *	<li><b>name</b>: Layer name, it is used as the feature predicate.
+ *	<li><b>source</b>: Data source.
+ *	<li><b>months</b>: Number of months.
+ *	<li><b>scale</b>: Scale factor applied to the stored values.
+ *	<li><b>type</b>: Sample type, one of the <i>kTYPE_</i> constants.
+ *	<li><b>path</b>: File path template, relative to the scenario directory.
+ *	<li><b>grid</b>: Layer grid.
+ *	<li><b>band</b>: Index of the first band in the base scenario.
+ *	<li><b>interleaved</b>: Set if the monthly series is stored in a single band
+ *		interleaved by pixel file, rather than in a file per month.
+ *	<li><b>derived</b>: Derived layer kind, one of the <i>kDERIVED_</i> constants;
+ *		derived layers have no files.
+ *	<li><b>bioclim</b>: Bioclimatic variable number [1 - 19] if the layer is a BIOCLIM
+ *		variable, or 0.
+ *	<li><b>base</b>: Base temperature in degrees of growing degree days layers.
+ * </ul>
+ */
+struct LAYER_T
+{
+	string name;		// Layer name.
+	string source;		// Data source.
+	int months;			// Number of months.
+	double scale;		// Scale factor.
+	int type;			// Sample type.
+	string path;		// Path template.
+	GRID_T grid;		// Layer grid.
+	int band;			// First band.
+	bool interleaved;	// Monthly cube.
+	int derived;		// Derived kind.
+	int bioclim;		// Bioclimatic variable.
+	double base;		// Base temperature.
+};
+
+/**
+ * Scenario structure.
+ *
+ * This structure contains the runtime information of a climate scenario: scenarios share
+ * the grid and the layers of the base dataset, but their files are located in a different
+ * directory. The base dataset is the first scenario:
+ *
+ * <ul>
+ *	<li><b>name</b>: Scenario name.
+ *	<li><b>source</b>: Data source.
+ *	<li><b>directory</b>: Scenario directory.
+ *	<li><b>bands</b>: Index of the first band of each layer, or -1 if the scenario does
+ *		not provide the layer.
+ * </ul>
+ */
+struct SCENARIO_T
+{
+	string name;		// Scenario name.
+	string source;		// Data source.
+	string directory;	// Scenario directory.
+	vector<int> bands;	// Layer bands.
+};
+
+/**
+ * Read structure.
+ *
+ * This structure contains a pending band read, the reads of a query are collected and
+ * issued together:
+ *
+ * <ul>
+ *	<li><b>band</b>: Band index.
+ *	<li><b>offset</b>: Data point offset.
+ *	<li><b>value</b>: Receives the value, in the host byte order.
+ *	<li><b>done</b>: Set if the value was read.
+ * </ul>
+ */
+struct READ_T
+{
+	int band;			// Band index.
+	UInt64 offset;		// Data point offset.
+	SInt16 value;		// Value.
+	bool done;			// Read flag.
+};
+
+/**
+ * I/O read structure.
+ *
+ * This structure contains a file read submitted to an asynchronous queue:
+ *
+ * <ul>
+ *	<li><b>fd</b>: File descriptor.
+ *	<li><b>buffer</b>: Destination buffer.
+ *	<li><b>length</b>: Number of bytes to read.
+ *	<li><b>offset</b>: File offset.
+ *	<li><b>result</b>: Receives the number of bytes read, or a negative error code.
+ *	<li><b>owner</b>: Object waiting for the read, used by asynchronous submissions.
+ * </ul>
+ */
+struct IO_READ_T
+{
+	int fd;				// File descriptor.
+	void * buffer;		// Buffer.
+	UInt32 length;		// Length.
+	UInt64 offset;		// File offset.
+	int result;			// Result.
+	void * owner;		// Owner.
+};
+
+/**
+ * Ring structure.
+ *
+ * This structure contains an io_uring submission and completion queue pair, the kernel
+ * structures are kept opaque so that the structure is declared on every platform:
+ *
+ * <ul>
+ *	<li><b>fd</b>: Ring file descriptor, or -1 if the ring is not open.
+ *	<li><b>entries</b>: Number of submission entries.
+ *	<li><b>sqMap</b>, <b>cqMap</b>, <b>sqeMap</b>: Mapped submission ring, completion
+ *		ring and submission entries.
+ *	<li><b>sqSize</b>, <b>cqSize</b>, <b>sqeSize</b>: Mapped sizes.
+ *	<li><b>sqHead</b>, <b>sqTail</b>, <b>sqMask</b>, <b>sqArray</b>: Submission ring
+ *		fields.
+ *	<li><b>cqHead</b>, <b>cqTail</b>, <b>cqMask</b>, <b>cqes</b>: Completion ring
+ *		fields.
+ *	<li><b>inflight</b>: Number of asynchronous reads submitted and not yet collected.
+ * </ul>
+ */
+struct URING_T
+{
+	int fd;						// Ring descriptor.
+	unsigned entries;			// Submission entries.
+	void * sqMap;				// Submission ring.
+	void * cqMap;				// Completion ring.
+	void * sqeMap;				// Submission entries.
+	size_t sqSize;				// Submission ring size.
+	size_t cqSize;				// Completion ring size.
+	size_t sqeSize;				// Submission entries size.
+	unsigned * sqHead;			// Submission head.
+	unsigned * sqTail;			// Submission tail.
+	unsigned * sqMask;			// Submission mask.
+	unsigned * sqArray;			// Submission index array.
+	unsigned * cqHead;			// Completion head.
+	unsigned * cqTail;			// Completion tail.
+	unsigned * cqMask;			// Completion mask.
+	void * cqes;				// Completion entries.
+	unsigned inflight;			// Reads in flight.
+};
+
+/**
+ * Queued reads structure.
+ *
+ * This structure contains the file reads of a list of band reads, see QueueBands():
+ *
+ * <ul>
+ *	<li><b>buffer</b>: Receives the values, at the index of their band read.
+ *	<li><b>reads</b>: File reads.
+ *	<li><b>first</b>: Index of the first band read of each file read.
+ *	<li><b>runs</b>: Number of band reads of each file read.
+ * </ul>
+ */
+struct QUEUE_T
+{
+	vector<SInt16> buffer;		// Values.
+	vector<IO_READ_T> reads;	// File reads.
+	vector<size_t> first;		// First band reads.
+	vector<size_t> runs;		// Band reads count.
+};
+
+/**
+ * Query structure.
+ *
+ * This structure contains the resolved selection of a query:
+ *
+ * <ul>
+ *	<li><b>scenarios</b>: Scenario indexes, the first one is the base dataset.
+ *	<li><b>layers</b>: Selection flag of each dataset layer.
+ *	<li><b>packed</b>: Set if monthly series are returned as a single packed value.
+ * </ul>
+ */
+struct QUERY_T
+{
+	vector<int> scenarios;		// Scenarios.
+	vector<bool> layers;		// Selected layers.
+	bool packed;				// Packed series.
+};
+
+/**
+ * Arena structure.
+ *
+ * This structure contains a scratch arena, from which the temporary arrays of a request
+ * are allocated and released all at once, see GetArena() and ResetArena():
+ *
+ * <ul>
+ *	<li><b>block</b>: Memory block, kept across resets.
+ *	<li><b>used</b>: Number of bytes of the block in use.
+ *	<li><b>spills</b>: Allocations that did not fit in the block, the block is grown to
+ *		hold them at the next reset; they are kept in a list, so that adding a spill
+ *		never moves the earlier ones.
+ * </ul>
+ */
+struct ARENA_T
+{
+	vector<UInt8> block;			// Block.
+	size_t used;					// Used bytes.
+	list< vector<UInt8> > spills;	// Overflow allocations.
 };
+
+/**
+ * Features structure.
+ *
+ * This structure contains the features of a set of points, the entries of the
+ * <i>first</i> and <i>values</i> arrays are indexed by point, query scenario and layer:
+ *
+ * <ul>
+ *	<li><b>points</b>: Number of points.
+ *	<li><b>cells</b>: Number of distinct cells, points in the same cells share their
+ *		reads.
+ *	<li><b>first</b>: Index of the first read of each entry, or -1 if the layer is not
+ *		read.
+ *	<li><b>elevation</b>: Index of the elevation and source reads of each point, or -1 if
+ *		the point is out of map.
+ *	<li><b>reads</b>: Band reads.
+ *	<li><b>values</b>: Derived value of each entry, or NaN if not computed.
+ *	<li><b>arena</b>: Scratch arena of the lookup temporaries, it is reset when the
+ *		reads are collected; features reused from one query to the next keep both the
+ *		capacity of their arrays and their arena.
+ * </ul>
+ */
+struct FEATURES_T
+{
+	size_t points;				// Number of points.
+	size_t cells;				// Number of distinct cells.
+	vector<int> first;			// First reads.
+	vector<int> elevation;		// Elevation reads.
+	vector<READ_T> reads;		// Reads.
+	vector<float> values;		// Derived values.
+	ARENA_T arena;				// Scratch arena.
+};
+
+/**
+ * Dataset structure.
+ *
+ * This structure contains the dataset registry, it is loaded at startup, and by the
+ * server on reload, either from a manifest file or from the built-in tables:
+ *
+ * <ul>
+ *	<li><b>directory</b>: Base dataset directory.
+ *	<li><b>sources</b>: GTOPO-30 data sources list.
+ *	<li><b>tiles</b>: GTOPO-30 tiles.
+ *	<li><b>layers</b>: WORLDCLIM layers.
+ *	<li><b>scenarios</b>: Climate scenarios, the first one is the base dataset.
+ *	<li><b>bands</b>: Flat array of all tile and layer files.
+ *	<li><b>tmin</b>, <b>tmax</b>, <b>prec</b>: Indexes of the monthly minimum
+ *		temperature, maximum temperature and precipitation layers, or -1; these are the
+ *		inputs of the derived layers.
+ *	<li><b>io</b>: I/O mode, one of the <i>kIO_</i> constants.
+ *	<li><b>huge</b>: Set if the mapped files are aligned and advised for huge pages.
+ *	<li><b>ring</b>: Asynchronous read queue, or NULL if values are read from mapped
+ *		files or with <i>pread</i>.
+ *	<li><b>epoch</b>: Dataset version, incremented by each server reload.
+ *	<li><b>users</b>: Number of server requests in progress on the dataset; a replaced
+ *		dataset is closed once it has no users.
+ *	<li><b>legend</b>: XML legend comment of the layers, written as is by each response.
+ *	<li><b>shortfall</b>: Number of bytes of the locked memory budget that could not be
+ *		locked, see LockBands().
+ * </ul>
+ */
+struct DATASET_T
+{
+	string directory;				// Base directory.
+	vector<string> sources;			// Elevation sources.
+	vector<TILE_T> tiles;			// Elevation tiles.
+	vector<LAYER_T> layers;			// Climate layers.
+	vector<SCENARIO_T> scenarios;	// Climate scenarios.
+	vector<BAND_T> bands;			// Files.
+	int tmin;						// Minimum temperature layer.
+	int tmax;						// Maximum temperature layer.
+	int prec;						// Precipitation layer.
+	int io;							// I/O mode.
+	bool huge;						// Huge pages.
+	URING_T * ring;					// Read queue.
+	UInt32 epoch;					// Version.
+	size_t users;					// Requests in progress.
+	string legend;					// Layers legend.
+	UInt64 shortfall;				// Locked bytes shortfall.
+};
+
+/**
+ * HTTP request structure.
+ *
+ * This structure contains a parsed HTTP request:
+ *
+ * <ul>
+ *	<li><b>method</b>: Request method.
+ *	<li><b>path</b>: Request target path.
+ *	<li><b>query</b>: Request target query string, without the '?'.
+ *	<li><b>version</b>: Protocol version.
+ *	<li><b>body</b>: Request body.
+ *	<li><b>keepAlive</b>: Set if the connection is kept open after the response.
+ * </ul>
+ */
+struct HTTP_REQUEST_T
+{
+	string method;				// Method.
+	string path;				// Path.
+	string query;				// Query string.
+	string version;				// Protocol version.
+	string body;				// Body.
+	bool keepAlive;				// Persistent connection.
+};
+
+/**
+ * HTTP response structure.
+ *
+ * This structure contains the response to an HTTP request:
+ *
+ * <ul>
+ *	<li><b>status</b>: Status code.
+ *	<li><b>type</b>: Content type.
+ *	<li><b>body</b>: Body.
+ *	<li><b>headers</b>: Additional header lines, each terminated by CRLF.
+ *	<li><b>socket</b>: Socket of the connection, -1 if the connection was closed before
+ *		the response was completed.
+ *	<li><b>head</b>: Set if the body is omitted, <i>HEAD</i> requests.
+ *	<li><b>closing</b>: Set if the connection is closed after the response.
+ *	<li><b>ready</b>: Set if the response is complete.
+ * </ul>
+ */
+struct HTTP_RESPONSE_T
+{
+	int status;					// Status code.
+	string type;				// Content type.
+	string body;				// Body.
+	string headers;				// Additional headers.
+	int socket;					// Connection.
+	bool head;					// Omit body.
+	bool closing;				// Last response.
+	bool ready;					// Complete.
+};
+
+/**
+ * Connection structure.
+ *
+ * This structure contains the state of a server connection:
+ *
+ * <ul>
+ *	<li><b>socket</b>: Connection socket.
+ *	<li><b>client</b>: Client address, requests are scheduled fairly among clients.
+ *	<li><b>input</b>: Received data not yet parsed.
+ *	<li><b>output</b>: Responses not yet sent, as the fragments written in a single
+ *		gathered write: the header and body of each response.
+ *	<li><b>queued</b>: Number of output bytes.
+ *	<li><b>sent</b>: Number of bytes of the first output fragment sent.
+ *	<li><b>reading</b>: Set if the socket is polled for reading.
+ *	<li><b>writing</b>: Set if the socket is polled for writing.
+ *	<li><b>closing</b>: Set if the connection is closed once the output is sent.
+ *	<li><b>active</b>: Time of the last activity.
+ *	<li><b>responses</b>: Responses not yet appended to the output, in request order.
+ * </ul>
+ */
+struct CONNECTION_T
+{
+	int socket;					// Socket.
+	string client;				// Client address.
+	string input;				// Input buffer.
+	deque<string> output;		// Output fragments.
+	size_t queued;				// Output bytes.
+	size_t sent;				// Sent bytes.
+	bool reading;				// Read polling.
+	bool writing;				// Write polling.
+	bool closing;				// Close after output.
+	time_t active;				// Last activity.
+	deque<HTTP_RESPONSE_T *> responses;	// Pending responses.
+};
+
+/**
+ * Server limits structure.
+ *
+ * This structure contains the admission limits of the server:
+ *
+ * <ul>
+ *	<li><b>concurrency</b>: Maximum number of requests in progress.
+ *	<li><b>queue</b>: Maximum number of requests waiting for admission, further requests
+ *		are rejected.
+ *	<li><b>deadline</b>: Number of seconds after which a waiting request is rejected.
+ * </ul>
+ */
+struct LIMITS_T
+{
+	size_t concurrency;			// Requests in progress.
+	size_t queue;				// Waiting requests.
+	int deadline;				// Waiting time.
+};
+
+/**
+ * Admission structure.
+ *
+ * This structure contains a request waiting for admission:
+ *
+ * <ul>
+ *	<li><b>request</b>: Request.
+ *	<li><b>response</b>: Response, already queued on its connection.
+ *	<li><b>arrival</b>: Time the request was received.
+ * </ul>
+ */
+struct ADMISSION_T
+{
+	HTTP_REQUEST_T request;		// Request.
+	HTTP_RESPONSE_T * response;	// Response.
+	time_t arrival;				// Arrival time.
+};
+
+/**
+ * Scheduler structure.
+ *
+ * This structure contains the requests waiting for admission, by priority and client;
+ * within a priority clients are served in turn, in address order:
+ *
+ * <ul>
+ *	<li><b>limits</b>: Admission limits.
+ *	<li><b>queues</b>: Waiting requests of each client, by priority.
+ *	<li><b>last</b>: Last client served, by priority.
+ *	<li><b>queued</b>: Number of waiting requests.
+ *	<li><b>active</b>: Number of requests in progress.
+ *	<li><b>served</b>: Number of responses completed in the current second.
+ *	<li><b>rate</b>: Number of responses completed in the last second.
+ * </ul>
+ */
+struct SCHEDULER_T
+{
+	LIMITS_T limits;			// Limits.
+	map<string, deque<ADMISSION_T> > queues [ 2 ];	// Waiting requests.
+	string last [ 2 ];			// Last clients.
+	size_t queued;				// Waiting count.
+	size_t active;				// Running count.
+	size_t served;				// Current rate.
+	size_t rate;				// Last rate.
+};
+
+/**
+ * Task structure.
+ *
+ * This structure contains the state of a server request whose reads are in progress:
+ *
+ * <ul>
+ *	<li><b>response</b>: Pending response.
+ *	<li><b>dataset</b>: Dataset the request runs on, it is kept open until the request
+ *		completes, also if the server reloads meanwhile.
+ *	<li><b>query</b>: Resolved query.
+ *	<li><b>latitude</b>: Point latitude.
+ *	<li><b>longitude</b>: Point longitude.
+ *	<li><b>features</b>: Point features reads.
+ *	<li><b>queue</b>: File reads of the features.
+ *	<li><b>remaining</b>: Number of file reads not yet completed.
+ *	<li><b>key</b>: Cells read by the request, see GetCellsKey().
+ *	<li><b>followers</b>: Requests for the same cells waiting for the reads of this
+ *		request instead of issuing their own.
+ *	<li><b>started</b>: Ticks when the request was handled, see GetTicks().
+ *	<li><b>queued</b>: Ticks when the reads of the request were queued.
+ * </ul>
+ */
+struct TASK_T
+{
+	HTTP_RESPONSE_T * response;	// Response.
+	DATASET_T * dataset;		// Dataset.
+	QUERY_T query;				// Query.
+	double latitude;			// Latitude.
+	double longitude;			// Longitude.
+	FEATURES_T features;		// Features.
+	QUEUE_T queue;				// File reads.
+	size_t remaining;			// Pending file reads.
+	string key;					// Cells key.
+	vector<TASK_T *> followers;	// Coalesced requests.
+	UInt64 started;				// Handling ticks.
+	UInt64 queued;				// Queueing ticks.
+};
+
+/**
+ * Parse error structure.
+ *
+ * This structure contains the outcome of parsing coordinates:
+ *
+ * <ul>
+ *	<li><b>status</b>: Parse status, one of the <i>kPARSE_</i> constants.
+ *	<li><b>field</b>: Field number [1 - 3] of the error, 1 is the latitude, 2 the
+ *		longitude and 3 an unexpected field.
+ *	<li><b>line</b>: Line number of the error, starting from 1.
+ *	<li><b>column</b>: Column of the error in the line, starting from 1.
+ *	<li><b>point</b>: Index of the point of the line in a batch, invalid lines are
+ *		kept as points so that the output matches the input lines.
+ * </ul>
+ */
+struct PARSE_T
+{
+	int status;			// Status.
+	int field;			// Field number.
+	size_t line;		// Line number.
+	size_t column;		// Column number.
+	size_t point;		// Point index.
+};
+
+/**
+ * Options structure.
+ *
+ * This structure contains the parsed command line arguments:
+ *
+ * <ul>
+ *	<li><b>directory</b>: Base dataset directory path.
+ *	<li><b>latitude</b>: Latitude argument.
+ *	<li><b>longitude</b>: Longitude argument.
+ *	<li><b>manifest</b>: Dataset manifest file path, provided with the <i>--manifest</i>
+ *		option; if omitted, the <i>{@link kManifestName kManifestName}</i> file of the base
+ *		directory is used if it exists, otherwise the built-in tables are used.
+ *	<li><b>scenarios</b>: Names of the scenarios to be queried along with the base
+ *		dataset, provided with the <i>--scenario</i> option.
+ *	<li><b>bbox</b>: Set if the <i>--bbox</i> option was provided, in that case the
+ *		latitude and longitude arguments are not expected.
+ *	<li><b>area</b>: Bounding box minimum and maximum latitude, minimum and maximum
+ *		longitude arguments.
+ *	<li><b>layers</b>: Names of the layers to be returned, provided with the
+ *		<i>--layer</i> option; empty means all layers.
+ *	<li><b>batch</b>: Coordinates file provided with the <i>--batch</i> option, in that
+ *		case the latitude and longitude arguments are not expected.
+ *	<li><b>packed</b>: Set if the <i>--packed</i> option was provided.
+ *	<li><b>repack</b>: Layer name and output file provided with the <i>--repack</i>
+ *		option, in that case the latitude and longitude arguments are not expected.
+ *	<li><b>listen</b>: Server address provided with the <i>--listen</i> option, in that
+ *		case the latitude and longitude arguments are not expected.
+ *	<li><b>io</b>: I/O mode provided with the <i>--io</i> option, one of the <i>kIO_</i>
+ *		constants.
+ *	<li><b>huge</b>: Set if the <i>--hugepages</i> option was provided.
+ *	<li><b>lock</b>: Budget in bytes of the mapped pages locked in memory, provided in
+ *		megabytes with the <i>--lock</i> option, or 0.
+ *	<li><b>limits</b>: Server admission limits, provided with the <i>--concurrency</i>,
+ *		<i>--queue</i> and <i>--deadline</i> options.
+ *	<li><b>heatmap</b>: Server heat map file provided with the <i>--heatmap</i> option.
+ *	<li><b>stats</b>: Set if the <i>--stats</i> option was provided.
+ *	<li><b>generate</b>: Synthetic dataset scale provided with the <i>--generate</i>
+ *		option, or 0.
+ *	<li><b>bench</b>: Benchmark queries provided with the <i>--bench</i> option, or 0.
+ *	<li><b>native</b>: Set if the <i>--native</i> option was provided.
+ * </ul>
+ */
+struct OPTIONS_T
+{
+	string directory;			// Base directory.
+	string latitude;			// Latitude.
+	string longitude;			// Longitude.
+	string manifest;			// Manifest file.
+	vector<string> scenarios;	// Scenarios.
+	bool bbox;					// Bounding box query.
+	string area [ 4 ];			// Bounding box.
+	vector<string> layers;		// Layers.
+	string batch;				// Batch file.
+	bool packed;				// Packed series.
+	string repack [ 2 ];		// Repack layer and file.
+	string listen;				// Server address.
+	int io;						// I/O mode.
+	bool huge;					// Huge pages.
+	UInt64 lock;				// Locked bytes budget.
+	LIMITS_T limits;			// Server limits.
+	string heatmap;				// Heat map file.
+	bool stats;					// Write statistics.
+	int generate;				// Synthetic dataset scale.
+	size_t bench;				// Benchmark queries.
+	bool native;				// Convert byte order.
+};
+
+/**
+ * Service structure.
+ *
+ * This structure contains the context of the server request handler:
+ *
+ * <ul>
+ *	<li><b>dataset</b>: Current dataset.
+ *	<li><b>options</b>: Command options, used to reload the dataset.
+ *	<li><b>retired</b>: Replaced datasets still used by requests in progress.
+ *	<li><b>reload</b>: Descriptor signalling reload requests, or -1.
+ *	<li><b>backlog</b>: File reads of pending requests not yet submitted to the read
+ *		queue, in request order; the <i>owner</i> of each read is its task.
+ *	<li><b>inflight</b>: Requests whose reads are in progress, by cells key; keys include
+ *		the dataset epoch, so that requests never attach to reads of a replaced dataset.
+ *	<li><b>ready</b>: Responses of requests completed while serving another request,
+ *		they are returned by the next poll.
+ *	<li><b>wake</b>: Pipe signalling ready responses, both descriptors are -1 if none.
+ *	<li><b>heat</b>: Number of queries of each 30 seconds cell, by global cell index,
+ *		<i>row * 360 * {@link kPointsLonDegree kPointsLonDegree} + column</i>.
+ *	<li><b>recorded</b>: Number of queries recorded since the heat map was saved.
+ * </ul>
+ */
+struct SERVICE_T
+{
+	DATASET_T * dataset;		// Dataset.
+	const OPTIONS_T * options;	// Options.
+	vector<DATASET_T *> retired;	// Replaced datasets.
+	int reload;					// Reload descriptor.
+	vector<IO_READ_T *> backlog;	// Reads to submit.
+	map<string, TASK_T *> inflight;	// Reading requests.
+	vector<HTTP_RESPONSE_T *> ready;	// Completed responses.
+	int wake[ 2 ];				// Ready responses pipe.
+	map<UInt64, UInt32> heat;	// Queried cells.
+	size_t recorded;			// Unsaved queries.
+};
+
+#endif // STRUCTURES_H
@@ -0,0 +1,131 @@
+/**
+ * Scratch arena test.
+ *
+ * This file contains the test of the request scratch arena: several allocations spill
+ * out of the block before a reset, each is filled with its own pattern, and all of them
+ * must still hold their pattern after the later spills; after the reset the block must
+ * hold them all without spilling.
+ *
+ * Build it along with the arena and run it, it returns non zero on failure:
+ *
+ *	g++ -std=c++98 -I.. ArenaTest.cpp ../Arena.cpp -o ArenaTest && ./ArenaTest
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										ArenaTest.cpp									*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * Local includes.
+ */
+#include "Arena.h"											// Scratch arena.
+
+/**
+ * Number of allocations.
+ */
+static const size_t kTEST_Allocations = 64;
+
+
+/*===================================================================================
+ *	CheckPattern																	*
+ *==================================================================================*/
+
+/**
+ * Check allocation pattern.
+ *
+ * This function will return TRUE if the provided allocation is aligned and holds the
+ * pattern of the provided allocation index.
+ *
+ * @param const UInt8 *		theData				Allocation.
+ * @param size_t			theSize				Size in bytes.
+ * @param size_t			theIndex			Allocation index.
+ *
+ * @access private
+ * @return bool
+ */
+static bool CheckPattern( const UInt8 * theData, size_t theSize, size_t theIndex )
+{
+	if( (size_t) theData % kARENA_Alignment )
+		return false;															// ==>
+
+	for( size_t i = 0; i < theSize; i++ )
+	{
+		if( theData[ i ] != (UInt8) (theIndex + i) )
+			return false;														// ==>
+	}
+
+	return true;																// ==>
+
+} // CheckPattern.
+
+
+/*===================================================================================
+ *	main																			*
+ *==================================================================================*/
+
+/**
+ * Test arena.
+ *
+ * @access public
+ * @return int
+ */
+int main()
+{
+	ARENA_T arena;
+	arena.used = 0;
+	ResetArena( &arena );
+
+	for( int pass = 0; pass < 2; pass++ )
+	{
+		//
+		// Allocate.
+		// The first pass spills every allocation, the block starts empty.
+		//
+		UInt8 * data [ kTEST_Allocations ];
+		size_t size [ kTEST_Allocations ];
+		for( size_t i = 0; i < kTEST_Allocations; i++ )
+		{
+			size[ i ] = 1 + (i * 37);
+			data[ i ] = (UInt8 *) GetArena( &arena, size[ i ] );
+			for( size_t j = 0; j < size[ i ]; j++ )
+				data[ i ][ j ] = (UInt8) (i + j);
+		}
+
+		//
+		// Check allocations.
+		//
+		for( size_t i = 0; i < kTEST_Allocations; i++ )
+		{
+			if( ! CheckPattern( data[ i ], size[ i ], i ) )
+			{
+				cerr << "Pass " << pass << ": allocation " << i << " was overwritten\n";
+				return 1;														// ==>
+			}
+		}
+
+		//
+		// Check spills.
+		//
+		if( pass
+		 && (! arena.spills.empty()) )
+		{
+			cerr << "Pass " << pass << ": allocations spilled after the reset\n";
+			return 1;															// ==>
+		}
+
+		ResetArena( &arena );
+	}
+
+	cout << "Arena: OK\n";
+
+	return 0;																	// ==>
+
+} // main.
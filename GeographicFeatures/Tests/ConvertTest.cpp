@@ -0,0 +1,269 @@
+/**
+ * Byte order conversion test.
+ *
+ * This file contains the test of the dataset byte order conversion: a converted file
+ * must hold its samples in the host byte order and its header must declare it, keeping
+ * the other entries; when either the header or the file cannot be replaced the
+ * conversion must fail leaving both as they were, and no temporary file behind.
+ *
+ * Build it along with the registry and run it, it returns non zero on failure:
+ *
+ *	g++ -std=c++98 -I.. ConvertTest.cpp ../Registry.cpp ../Bioclim.cpp ../Decode.cpp \
+ *		../Stats.cpp ../Uring.cpp -o ConvertTest && ./ConvertTest
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										ConvertTest.cpp									*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * Global includes.
+ */
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * Local includes.
+ */
+#include "Registry.h"										// Registry.
+#include "Decode.h"											// Decoding.
+#include "Errors.h"											// Error codes.
+
+/**
+ * Stored samples, in the byte order opposite to the host one.
+ */
+static const char kTEST_Stored [] = { 0x12, 0x34, (char) 0xAB, (char) 0xCD };
+
+/**
+ * Converted samples.
+ */
+static const char kTEST_Native [] = { 0x34, 0x12, (char) 0xCD, (char) 0xAB };
+
+
+/*===================================================================================
+ *	WriteFile																		*
+ *==================================================================================*/
+
+/**
+ * Write file.
+ *
+ * This function will write the provided contents to the provided file.
+ *
+ * @param const string &	thePath				File path.
+ * @param const string &	theContents			File contents.
+ *
+ * @access private
+ * @return void
+ */
+static void WriteFile( const string & thePath, const string & theContents )
+{
+	ofstream file( thePath.c_str(), ios::binary );
+	file << theContents;
+
+} // WriteFile.
+
+
+/*===================================================================================
+ *	ReadFile																		*
+ *==================================================================================*/
+
+/**
+ * Read file.
+ *
+ * This function will return the contents of the provided file.
+ *
+ * @param const string &	thePath				File path.
+ *
+ * @access private
+ * @return string
+ */
+static string ReadFile( const string & thePath )
+{
+	ifstream file( thePath.c_str(), ios::binary );
+	ostringstream contents;
+	contents << file.rdbuf();
+
+	return contents.str();														// ==>
+
+} // ReadFile.
+
+
+/*===================================================================================
+ *	Exists																			*
+ *==================================================================================*/
+
+/**
+ * Check file.
+ *
+ * This function will return TRUE if the provided file exists.
+ *
+ * @param const string &	thePath				File path.
+ *
+ * @access private
+ * @return bool
+ */
+static bool Exists( const string & thePath )
+{
+	return ! access( thePath.c_str(), F_OK );									// ==>
+
+} // Exists.
+
+
+/*===================================================================================
+ *	Convert																			*
+ *==================================================================================*/
+
+/**
+ * Convert band.
+ *
+ * This function will convert a dataset holding a single swapped band, with the provided
+ * path, read from the provided file, and return the conversion status; temporary files
+ * left behind are reported as failures in the provided counter.
+ *
+ * @param const string &	thePath				Band path.
+ * @param const string &	theFile				Band data file.
+ * @param int *				theFailures			Failures counter.
+ *
+ * @access private
+ * @return int
+ */
+static int Convert( const string & thePath, const string & theFile, int * theFailures )
+{
+	DATASET_T dataset;
+	BAND_T band;
+	band.path = thePath;
+	band.swapped = true;
+	band.fd = open( theFile.c_str(), O_RDONLY );
+	band.size = sizeof( kTEST_Stored );
+	dataset.bands.push_back( band );
+
+	size_t count;
+	string message;
+	int error = ConvertDataset( dataset, &count, &message );
+	close( band.fd );
+
+	string stem = thePath.substr( 0, thePath.rfind( '.' ) );
+	if( Exists( thePath + ".native" )
+	 || Exists( stem + ".hdr.native" )
+	 || Exists( stem + ".hdr.swapped" ) )
+	{
+		cerr << "Converting [" << thePath << "] left temporary files\n";
+		(*theFailures)++;
+	}
+
+	return error;																// ==>
+
+} // Convert.
+
+
+/*===================================================================================
+ *	main																			*
+ *==================================================================================*/
+
+/**
+ * Test conversion.
+ *
+ * @access public
+ * @return int
+ */
+int main()
+{
+	int failures = 0;
+	char pattern [] = "/tmp/ConvertTestXXXXXX";
+	if( ! mkdtemp( pattern ) )
+	{
+		cerr << "Unable to create the test directory\n";
+		return 1;																// ==>
+	}
+	string directory = string( pattern ) + "/";
+	string stored( kTEST_Stored, sizeof( kTEST_Stored ) );
+	string native( kTEST_Native, sizeof( kTEST_Native ) );
+	string header = string( "NROWS 1\nBYTEORDER " ) + (( kHOST_BigEndian ) ? "I" : "M")
+				  + "\nNCOLS 2\n";
+
+	//
+	// Convert.
+	//
+	WriteFile( directory + "a.bil", stored );
+	WriteFile( directory + "a.hdr", header );
+	if( (Convert( directory + "a.bil", directory + "a.bil", &failures ) != kERROR_OK)
+	 || (ReadFile( directory + "a.bil" ) != native)
+	 || (ReadFile( directory + "a.hdr" )
+		 != string( "BYTEORDER      " ) + (( kHOST_BigEndian ) ? "M" : "I")
+			+ "\nNROWS 1\nNCOLS 2\n") )
+	{
+		cerr << "The converted file or header is wrong\n";
+		failures++;
+	}
+
+	//
+	// Fail replacing the header.
+	// The header is a directory, the file must keep its samples.
+	//
+	WriteFile( directory + "b.bil", stored );
+	mkdir( (directory + "b.hdr").c_str(), 0755 );
+	if( (Convert( directory + "b.bil", directory + "b.bil", &failures )
+		 != kERROR_CONVERT_FAILED)
+	 || (ReadFile( directory + "b.bil" ) != stored) )
+	{
+		cerr << "The file was converted without its header\n";
+		failures++;
+	}
+
+	//
+	// Fail replacing the file.
+	// The file is a directory, the header must be restored.
+	//
+	WriteFile( directory + "c.raw", stored );
+	WriteFile( directory + "c.hdr", header );
+	mkdir( (directory + "c.bil").c_str(), 0755 );
+	if( (Convert( directory + "c.bil", directory + "c.raw", &failures )
+		 != kERROR_CONVERT_FAILED)
+	 || (ReadFile( directory + "c.hdr" ) != header) )
+	{
+		cerr << "The header was converted without its file\n";
+		failures++;
+	}
+
+	//
+	// Fail replacing a file without header.
+	// No header must be left.
+	//
+	mkdir( (directory + "d.bil").c_str(), 0755 );
+	if( (Convert( directory + "d.bil", directory + "c.raw", &failures )
+		 != kERROR_CONVERT_FAILED)
+	 || Exists( directory + "d.hdr" ) )
+	{
+		cerr << "A header was created without its file\n";
+		failures++;
+	}
+
+	//
+	// Clean up.
+	//
+	const char * files [] = { "a.bil", "a.hdr", "b.bil", "c.raw", "c.hdr" };
+	const char * directories [] = { "b.hdr", "c.bil", "d.bil" };
+	for( size_t i = 0; i < sizeof( files ) / sizeof( files[ 0 ] ); i++ )
+		unlink( (directory + files[ i ]).c_str() );
+	for( size_t i = 0; i < sizeof( directories ) / sizeof( directories[ 0 ] ); i++ )
+		rmdir( (directory + directories[ i ]).c_str() );
+	rmdir( pattern );
+
+	if( failures )
+		return 1;																// ==>
+
+	cout << "Convert: OK\n";
+
+	return 0;																	// ==>
+
+} // main.
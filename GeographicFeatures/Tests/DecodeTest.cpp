@@ -0,0 +1,153 @@
+/**
+ * Sample decoding test.
+ *
+ * This file contains the test of the sample decoding: rows of every length up to a few
+ * vector blocks, at aligned and unaligned addresses, are decoded in place by DecodeRow()
+ * and must match the samples decoded one at a time by DecodeValue(), swapped samples
+ * must read the bytes in the opposite byte order and byte samples must not be sign
+ * extended.
+ *
+ * Build it along with the decoder and run it, it returns non zero on failure; add
+ * <i>-mssse3</i> or <i>-mavx2</i> to test the other vector paths:
+ *
+ *	g++ -std=c++98 -I.. DecodeTest.cpp ../Decode.cpp -o DecodeTest && ./DecodeTest
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										DecodeTest.cpp									*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * Global includes.
+ */
+#include <iostream>
+#include <vector>
+
+/**
+ * Local includes.
+ */
+#include "Decode.h"											// Decoding.
+
+/**
+ * Longest tested row.
+ */
+static const size_t kTEST_Count = 100;
+
+
+/*===================================================================================
+ *	CheckRow																		*
+ *==================================================================================*/
+
+/**
+ * Check row.
+ *
+ * This function will decode a row of the provided length and type, starting at the
+ * provided offset in its buffer, and compare it with the samples decoded one at a time;
+ * it will return FALSE on mismatch.
+ *
+ * @param size_t			theCount			Number of samples.
+ * @param size_t			theOffset			Buffer offset in samples.
+ * @param int				theType				Sample type.
+ * @param bool				doSwap				TRUE means swap bytes.
+ *
+ * @access private
+ * @return bool
+ */
+static bool CheckRow( size_t theCount, size_t theOffset, int theType, bool doSwap )
+{
+	//
+	// Store samples.
+	// Bytes past the stored samples are garbage the decoder must overwrite.
+	//
+	size_t size = ( theType == kTYPE_UINT8 ) ? 1 : 2;
+	vector<SInt16> row( theOffset + theCount + 1, (SInt16) 0x5A5A );
+	char * stored = (char *) &row[ theOffset ];
+	for( size_t i = 0; i < (theCount * size); i++ )
+		stored[ i ] = (char) ((i * 97) + theCount);
+	vector<char> copy( stored, stored + (theCount * size) + 1 );
+
+	//
+	// Decode.
+	//
+	DecodeRow( &row[ theOffset ], theCount, theType, doSwap );
+	for( size_t i = 0; i < theCount; i++ )
+	{
+		if( row[ theOffset + i ] != DecodeValue( &copy[ i * size ], theType, doSwap ) )
+		{
+			cerr << "Type " << theType << ( ( doSwap ) ? " swapped" : "" ) << ", "
+				 << theCount << " samples at " << theOffset << ": sample " << i
+				 << " is " << row[ theOffset + i ] << '\n';
+			return false;														// ==>
+		}
+	}
+
+	if( row[ theOffset + theCount ] != (SInt16) 0x5A5A )
+	{
+		cerr << "Type " << theType << ", " << theCount << " samples at " << theOffset
+			 << ": the sample past the row was overwritten\n";
+		return false;															// ==>
+	}
+
+	return true;																// ==>
+
+} // CheckRow.
+
+
+/*===================================================================================
+ *	main																			*
+ *==================================================================================*/
+
+/**
+ * Test decoding.
+ *
+ * @access public
+ * @return int
+ */
+int main()
+{
+	int failures = 0;
+
+	//
+	// Check values.
+	//
+	const char big [] = { 0x12, 0x34 };
+	const char little [] = { 0x34, 0x12 };
+	const char byte [] = { (char) 0xFE, 0x00 };
+	if( (DecodeValue( big, kTYPE_SINT16, ! kHOST_BigEndian ) != 0x1234)
+	 || (DecodeValue( little, kTYPE_SINT16, kHOST_BigEndian ) != 0x1234)
+	 || (DecodeValue( byte, kTYPE_UINT8, false ) != 254)
+	 || (DecodeValue( byte, kTYPE_UINT8, true ) != 254) )
+	{
+		cerr << "Samples are not decoded in their byte order\n";
+		failures++;
+	}
+
+	//
+	// Check rows.
+	//
+	for( size_t count = 0; count <= kTEST_Count; count++ )
+	{
+		for( size_t offset = 0; offset < 3; offset++ )
+		{
+			failures += ! CheckRow( count, offset, kTYPE_SINT16, false );
+			failures += ! CheckRow( count, offset, kTYPE_SINT16, true );
+			failures += ! CheckRow( count, offset, kTYPE_UINT8, false );
+		}
+	}
+
+	if( failures )
+		return 1;																// ==>
+
+	cout << "Decode: OK\n";
+
+	return 0;																	// ==>
+
+} // main.
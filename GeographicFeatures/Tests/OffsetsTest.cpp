@@ -0,0 +1,229 @@
+/**
+ * Cell offsets test.
+ *
+ * This file contains the test of the batched cell offsets: GetCellOffsets() must return,
+ * for every point, the offset GetCellOffset() returns, on grid edges, on cell boundaries,
+ * just inside and outside the grid, far outside it and on random points; points outside
+ * the grid must get the offset of the cell past the last one.
+ *
+ * Build it along with the registry and run it, it returns non zero on failure; add
+ * <i>-mavx</i> or <i>-msse4.1</i> to test the vector paths:
+ *
+ *	g++ -std=c++98 -I.. OffsetsTest.cpp ../Registry.cpp ../Bioclim.cpp ../Decode.cpp \
+ *		../Stats.cpp ../Uring.cpp -o OffsetsTest && ./OffsetsTest
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										OffsetsTest.cpp									*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * Global includes.
+ */
+#include <cmath>
+#include <cstdlib>
+
+/**
+ * Local includes.
+ */
+#include "Registry.h"										// Registry.
+
+/**
+ * Number of random points per grid.
+ */
+static const int kTEST_Points = 10000;
+
+
+/*===================================================================================
+ *	MakeGrid																		*
+ *==================================================================================*/
+
+/**
+ * Make grid.
+ *
+ * This function will return a grid with the provided bounds and counts, with the
+ * resolution set as the registry does.
+ *
+ * @param double			theLatMin			Minimum latitude.
+ * @param double			theLatMax			Maximum latitude.
+ * @param double			theLonMin			Minimum longitude.
+ * @param double			theLonMax			Maximum longitude.
+ * @param UInt64			theCountY			Number of rows.
+ * @param UInt64			theCountX			Number of columns.
+ *
+ * @access private
+ * @return GRID_T
+ */
+static GRID_T MakeGrid( double theLatMin, double theLatMax,
+						double theLonMin, double theLonMax,
+						UInt64 theCountY, UInt64 theCountX )
+{
+	GRID_T grid;
+	grid.area.latMin = theLatMin;
+	grid.area.latMax = theLatMax;
+	grid.area.lonMin = theLonMin;
+	grid.area.lonMax = theLonMax;
+	grid.countY = theCountY;
+	grid.countX = theCountX;
+	grid.unitY = (theLatMax - theLatMin) / theCountY;
+	grid.unitX = (theLonMax - theLonMin) / theCountX;
+	grid.pointsY = theCountY / (theLatMax - theLatMin);
+	grid.pointsX = theCountX / (theLonMax - theLonMin);
+
+	return grid;																// ==>
+
+} // MakeGrid.
+
+
+/*===================================================================================
+ *	CheckGrid																		*
+ *==================================================================================*/
+
+/**
+ * Check grid.
+ *
+ * This function will compare the batched and single offsets of the test points of the
+ * provided grid, it will return the number of mismatches.
+ *
+ * @param const GRID_T &	theGrid				Grid.
+ * @param const char *		theName				Grid name.
+ *
+ * @access private
+ * @return int
+ */
+static int CheckGrid( const GRID_T & theGrid, const char * theName )
+{
+	const AREA_T & area = theGrid.area;
+	double epsilon = 1e-9;
+	vector<double> latitudes, longitudes;
+
+	//
+	// Edges and corners, just inside and just outside.
+	//
+	double lats[] = { area.latMin, area.latMax, area.latMin - epsilon,
+					  area.latMin + epsilon, area.latMax - epsilon,
+					  area.latMax + epsilon, (area.latMin + area.latMax) / 2 };
+	double lons[] = { area.lonMin, area.lonMax, area.lonMin - epsilon,
+					  area.lonMin + epsilon, area.lonMax - epsilon,
+					  area.lonMax + epsilon, (area.lonMin + area.lonMax) / 2 };
+	size_t count = sizeof( lats ) / sizeof( lats[ 0 ] );
+	for( size_t i = 0; i < count; i++ )
+	{
+		for( size_t j = 0; j < count; j++ )
+		{
+			latitudes.push_back( lats[ i ] );
+			longitudes.push_back( lons[ j ] );
+		}
+	}
+
+	//
+	// Cell boundaries.
+	//
+	for( UInt64 row = 0; row <= theGrid.countY; row++ )
+	{
+		latitudes.push_back( area.latMax - (row / theGrid.pointsY) );
+		longitudes.push_back( area.lonMin
+							  + ((row % (theGrid.countX + 1)) / theGrid.pointsX) );
+	}
+	for( UInt64 column = 0; column <= theGrid.countX; column++ )
+	{
+		latitudes.push_back( area.latMax
+							 - ((column % (theGrid.countY + 1)) / theGrid.pointsY) );
+		longitudes.push_back( area.lonMin + (column / theGrid.pointsX) );
+	}
+
+	//
+	// Far outside the grid.
+	//
+	double far[][ 2 ] = { { 1000, 0 }, { -1000, 0 }, { 0, 1000 }, { 0, -1000 },
+						  { 1e300, -1e300 }, { NAN, 0 }, { 0, NAN } };
+	for( size_t i = 0; i < sizeof( far ) / sizeof( far[ 0 ] ); i++ )
+	{
+		latitudes.push_back( far[ i ][ 0 ] );
+		longitudes.push_back( far[ i ][ 1 ] );
+	}
+
+	//
+	// Random points, some outside the grid.
+	//
+	for( int i = 0; i < kTEST_Points; i++ )
+	{
+		double y = (rand() / (double) RAND_MAX) * 1.2 - 0.1;
+		double x = (rand() / (double) RAND_MAX) * 1.2 - 0.1;
+		latitudes.push_back( area.latMin + y * (area.latMax - area.latMin) );
+		longitudes.push_back( area.lonMin + x * (area.lonMax - area.lonMin) );
+	}
+
+	//
+	// Compare.
+	//
+	int failures = 0, outside = 0;
+	UInt64 none = theGrid.countY * theGrid.countX;
+	vector<UInt64> offsets( latitudes.size() );
+	GetCellOffsets( theGrid, &latitudes[ 0 ], &longitudes[ 0 ], latitudes.size(),
+					&offsets[ 0 ] );
+	for( size_t i = 0; i < latitudes.size(); i++ )
+	{
+		UInt64 row, column;
+		UInt64 offset = GetCellOffset( theGrid, latitudes[ i ], longitudes[ i ],
+									   &row, &column );
+		bool inside = (row < theGrid.countY) && (column < theGrid.countX);
+		outside += ( ! inside );
+		if( (offsets[ i ] != offset)
+		 || (inside ? (offset != (row * theGrid.countX) + column) : (offset != none)) )
+		{
+			cerr.precision( 17 );
+			cerr << theName << ": point " << latitudes[ i ] << ' ' << longitudes[ i ]
+				 << " has offset " << offsets[ i ] << " batched and " << offset
+				 << " single\n";
+			failures++;
+		}
+	}
+
+	if( ! outside )
+	{
+		cerr << theName << ": no point fell outside the grid\n";
+		failures++;
+	}
+
+	return failures;															// ==>
+
+} // CheckGrid.
+
+
+/*===================================================================================
+ *	main																			*
+ *==================================================================================*/
+
+/**
+ * Test cell offsets.
+ *
+ * @access public
+ * @return int
+ */
+int main()
+{
+	int failures = 0;
+	srand( 1 );
+
+	failures += CheckGrid( MakeGrid( -60, 90, -180, 180, 900, 2160 ), "WORLDCLIM" );
+	failures += CheckGrid( MakeGrid( 40, 90, -180, -140, 6000, 4800 ), "W180N90" );
+	failures += CheckGrid( MakeGrid( -90, -60, -180, 180, 3600, 43200 ), "W180S60" );
+	failures += CheckGrid( MakeGrid( -13.3, 36.7, -7.1, 33.9, 7, 13 ), "Uneven" );
+
+	if( failures )
+		return 1;																// ==>
+
+	cout << "Offsets: OK\n";
+
+	return 0;																	// ==>
+
+} // main.
@@ -0,0 +1,295 @@
+/**
+ * Coordinate parser test.
+ *
+ * This file contains the test of the coordinate parser: decimal degrees must convert to
+ * the same double as <i>strtod</i>, both for the numbers converted exactly and for the
+ * longer numbers handed to the library; degrees, minutes and seconds forms must give
+ * their value or be rejected at the offending character; batch input must report the
+ * status, line, column and result code of each invalid line.
+ *
+ * Build it along with the parser and run it, it returns non zero on failure:
+ *
+ *	g++ -std=c++98 -I.. ParseTest.cpp ../Parse.cpp -o ParseTest && ./ParseTest
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										ParseTest.cpp									*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * Global includes.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Local includes.
+ */
+#include "Parse.h"											// Coordinate parser.
+#include "Errors.h"											// Error codes.
+
+/**
+ * Number of random numbers.
+ */
+static const int kTEST_Numbers = 200000;
+
+/**
+ * Coordinate case structure.
+ *
+ * This structure holds a coordinate, its kind, the expected status and, if valid, its
+ * value, else the offset of the reported character.
+ */
+struct COORDINATE_T
+{
+	const char * text;	// Coordinate.
+	int kind;			// Coordinate kind.
+	int status;			// Expected status.
+	double value;		// Expected value or error offset.
+};
+
+/**
+ * Batch error case structure.
+ *
+ * This structure holds an expected batch error.
+ */
+struct BATCH_T
+{
+	size_t line;		// Line number.
+	int field;			// Field number.
+	int status;			// Status.
+	size_t column;		// Column number.
+	int code;			// Result code.
+};
+
+
+/*===================================================================================
+ *	CheckNumber																		*
+ *==================================================================================*/
+
+/**
+ * Check number.
+ *
+ * This function will parse the provided decimal latitude or longitude and return TRUE
+ * if it converts to the same double as <i>strtod</i>, and is only rejected if that
+ * double is out of range; numbers rounded to the limits are out of range.
+ *
+ * @param const char *		theText				Coordinate.
+ * @param int				theKind				Coordinate kind.
+ *
+ * @access private
+ * @return bool
+ */
+static bool CheckNumber( const char * theText, int theKind )
+{
+	double value, expected = strtod( theText, NULL );
+	const char * position;
+	int status = ParseCoordinate( theText, theText + strlen( theText ), theKind,
+								  &value, &position );
+	bool outside = ( theKind == kCOORD_LATITUDE )
+				 ? ((expected > 90) || (expected <= -90))
+				 : ((expected >= 180) || (expected < -180));
+	if( (status != (( outside ) ? kPARSE_RANGE : kPARSE_OK))
+	 || memcmp( &value, &expected, sizeof( double ) ) )
+	{
+		printf( "Number [%s] parsed as %.17g, status %d, strtod gives %.17g\n",
+				theText, value, status, expected );
+		return false;															// ==>
+	}
+
+	return true;																// ==>
+
+} // CheckNumber.
+
+
+/*===================================================================================
+ *	main																			*
+ *==================================================================================*/
+
+/**
+ * Test parser.
+ *
+ * @access public
+ * @return int
+ */
+int main()
+{
+	int failures = 0;
+	char text [ 64 ];
+	srand( 1 );
+
+	//
+	// Check numbers.
+	// Up to 15 significant digits are converted exactly, longer numbers, long
+	// fractions and large exponents by the library.
+	//
+	const char * numbers [] =
+	{
+		"0", "-0", "+0.0", "89.99999999999999", "90", "-89.999999999999999999",
+		"0.1", "0.30000000000000004", "12.345678901234567890123", "0000012.5",
+		"1.25e1", "125E-1", "1.25e+1", "4.9e-324", "2.2250738585072014e-308",
+		"0.000000000000000000000000000001", "17976931348623157e-307",
+		"123456789012345e-13", "1234567890123456e-14", "100000000000000000000e-19"
+	};
+	for( size_t i = 0; i < sizeof( numbers ) / sizeof( numbers[ 0 ] ); i++ )
+		failures += ! CheckNumber( numbers[ i ], kCOORD_LATITUDE );
+	for( int i = 0; i < kTEST_Numbers; i++ )
+	{
+		int kind = i % 2;
+		double range = ( kind == kCOORD_LATITUDE ) ? 90 : 180;
+		double value = ((rand() / (double) RAND_MAX) * 2 - 1) * range * 0.999;
+		int digits = rand() % 20;
+		switch( (i / 2) % 3 )
+		{
+			case 0:
+				sprintf( text, "%.*f", digits, value );
+				break;
+			case 1:
+				sprintf( text, "%.*e", digits, value );
+				break;
+			default:
+				sprintf( text, "%.17g", value );
+				break;
+		}
+		failures += ! CheckNumber( text, kind );
+	}
+
+	//
+	// Check forms.
+	//
+	const COORDINATE_T coordinates [] =
+	{
+		{ "41\xC2\xB0" "54'N", kCOORD_LATITUDE, kPARSE_OK, 41 + 54 / 60.0 },
+		{ "41d54'36\"N", kCOORD_LATITUDE, kPARSE_OK, 41 + 54 / 60.0 + 36 / 3600.0 },
+		{ "41:54:36", kCOORD_LATITUDE, kPARSE_OK, 41 + 54 / 60.0 + 36 / 3600.0 },
+		{ "41\xC2\xB0" "54'36''S", kCOORD_LATITUDE, kPARSE_OK,
+		  -(41 + 54 / 60.0 + 36 / 3600.0) },
+		{ "S41\xC2\xB0" "54.5'", kCOORD_LATITUDE, kPARSE_OK, -(41 + 54.5 / 60.0) },
+		{ "-12d30'", kCOORD_LATITUDE, kPARSE_OK, -(12 + 30 / 60.0) },
+		{ "12\xC2\xB0" "30\xE2\x80\xB2" "15.5\xE2\x80\xB3" "E", kCOORD_LONGITUDE,
+		  kPARSE_OK, 12 + 30 / 60.0 + 15.5 / 3600.0 },
+		{ "W179d59'59.9\"", kCOORD_LONGITUDE, kPARSE_OK,
+		  -(179 + 59 / 60.0 + 59.9 / 3600.0) },
+		{ "12.5s", kCOORD_LATITUDE, kPARSE_OK, -12.5 },
+		{ "12.5w", kCOORD_LONGITUDE, kPARSE_OK, -12.5 },
+		{ "90N", kCOORD_LATITUDE, kPARSE_OK, 90 },
+		{ "-180", kCOORD_LONGITUDE, kPARSE_OK, -180 },
+		{ "90S", kCOORD_LATITUDE, kPARSE_RANGE, 0 },
+		{ "90.5", kCOORD_LATITUDE, kPARSE_RANGE, 0 },
+		{ "180E", kCOORD_LONGITUDE, kPARSE_RANGE, 0 },
+		{ "12.5E", kCOORD_LATITUDE, kPARSE_SYNTAX, 4 },
+		{ "12.5N", kCOORD_LONGITUDE, kPARSE_SYNTAX, 4 },
+		{ "41:60", kCOORD_LATITUDE, kPARSE_SYNTAX, 3 },
+		{ "41:54:60", kCOORD_LATITUDE, kPARSE_SYNTAX, 6 },
+		{ "1e1:30", kCOORD_LATITUDE, kPARSE_SYNTAX, 1 },
+		{ "41:54x", kCOORD_LATITUDE, kPARSE_SYNTAX, 5 },
+		{ "N12.5S", kCOORD_LATITUDE, kPARSE_SYNTAX, 5 },
+		{ "--12", kCOORD_LATITUDE, kPARSE_SYNTAX, 1 },
+		{ "abc", kCOORD_LATITUDE, kPARSE_SYNTAX, 0 },
+		{ "", kCOORD_LATITUDE, kPARSE_EMPTY, 0 }
+	};
+	for( size_t i = 0; i < sizeof( coordinates ) / sizeof( coordinates[ 0 ] ); i++ )
+	{
+		const COORDINATE_T & test = coordinates[ i ];
+		double value = 0;
+		const char * position;
+		int status = ParseCoordinate( test.text, test.text + strlen( test.text ),
+									  test.kind, &value, &position );
+		if( (status != test.status)
+		 || ((status == kPARSE_OK) && (value != test.value))
+		 || ((status == kPARSE_SYNTAX) && ((position - test.text) != test.value)) )
+		{
+			printf( "Coordinate [%s] parsed as %.17g, status %d at %d\n", test.text,
+					value, status, (int) (position - test.text) );
+			failures++;
+		}
+	}
+
+	//
+	// Check batch.
+	// The long lines span several vector blocks.
+	//
+	const char batch [] =
+		"41.9 12.5\n"
+		"# comment, 95 10\n"
+		"\n"
+		"abc 10\n"
+		"95 10\n"
+		"10 20 30\n"
+		"10 1x\n"
+		"10\n"
+		"10 200\n"
+		"  -33.9,18.4\r\n"
+		"\t;41d54'36\"N ; 12:30:15E\n"
+		"                    10                    12.5x\n"
+		"12.345678901234567890123,,,,,,,,,,,,,,,,,,,,,,,,,,,-45.678901234567890123";
+	const BATCH_T errors [] =
+	{
+		{ 4, 1, kPARSE_SYNTAX, 1, kERROR_INVALID_LATITUDE_FORMAT },
+		{ 5, 1, kPARSE_RANGE, 1, kERROR_INVALID_LATITUDE_RANGE },
+		{ 6, 3, kPARSE_FIELDS, 7, kERROR_INVALID_BATCH },
+		{ 7, 2, kPARSE_SYNTAX, 5, kERROR_INVALID_LONGITUDE_FORMAT },
+		{ 8, 2, kPARSE_EMPTY, 3, kERROR_INVALID_LONGITUDE_FORMAT },
+		{ 9, 2, kPARSE_RANGE, 4, kERROR_INVALID_LONGITUDE_RANGE },
+		{ 12, 2, kPARSE_SYNTAX, 47, kERROR_INVALID_LONGITUDE_FORMAT }
+	};
+	const size_t count = sizeof( errors ) / sizeof( errors[ 0 ] );
+	vector<double> latitudes, longitudes;
+	vector<PARSE_T> found;
+	int status = ParseBatch( batch, sizeof( batch ) - 1, &latitudes, &longitudes,
+							 &found );
+	if( (status != kPARSE_SYNTAX)
+	 || (latitudes.size() != 11)
+	 || (longitudes.size() != 11)
+	 || (found.size() != count) )
+	{
+		printf( "Batch returned status %d, %d points and %d errors\n", status,
+				(int) latitudes.size(), (int) found.size() );
+		failures++;
+	}
+	else
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			if( (found[ i ].line != errors[ i ].line)
+			 || (found[ i ].field != errors[ i ].field)
+			 || (found[ i ].status != errors[ i ].status)
+			 || (found[ i ].column != errors[ i ].column)
+			 || (found[ i ].point != (errors[ i ].line - 3))
+			 || (GetParseCode( found[ i ] ) != errors[ i ].code) )
+			{
+				printf( "Batch line %d: field %d, status %d, column %d, code %d\n",
+						(int) found[ i ].line, found[ i ].field, found[ i ].status,
+						(int) found[ i ].column, GetParseCode( found[ i ] ) );
+				failures++;
+			}
+		}
+
+		if( (latitudes[ 0 ] != 41.9) || (longitudes[ 0 ] != 12.5)
+		 || (latitudes[ 7 ] != -33.9) || (longitudes[ 7 ] != 18.4)
+		 || (latitudes[ 8 ] != 41 + 54 / 60.0 + 36 / 3600.0)
+		 || (longitudes[ 8 ] != 12 + 30 / 60.0 + 15 / 3600.0)
+		 || (latitudes[ 10 ] != strtod( "12.345678901234567890123", NULL ))
+		 || (longitudes[ 10 ] != strtod( "-45.678901234567890123", NULL )) )
+		{
+			printf( "Batch coordinates are wrong\n" );
+			failures++;
+		}
+	}
+
+	if( failures )
+		return 1;																// ==>
+
+	cout << "Parse: OK\n";
+
+	return 0;																	// ==>
+
+} // main.
@@ -0,0 +1,126 @@
+/**
+ * Built-in tiles test.
+ *
+ * This file contains the test of the built-in GTOPO-30 tiles table: the name of each
+ * tile must be that of its north west corner, and the tiles must cover the globe once,
+ * with neither gaps nor overlaps. The tile shapes are checked by the compiler, see
+ * GTOPO30_SHAPE().
+ *
+ * Build it and run it, it returns non zero on failure:
+ *
+ *	g++ -std=c++98 -I.. TilesTest.cpp -o TilesTest && ./TilesTest
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										TilesTest.cpp									*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * Global includes.
+ */
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Local includes.
+ */
+#include "Constants.h"										// Constants.
+
+
+/*===================================================================================
+ *	GetTileName																		*
+ *==================================================================================*/
+
+/**
+ * Get tile name.
+ *
+ * This function will return the GTOPO-30 name of the tile whose north west corner is at
+ * the provided coordinates, such as <i>W180N90</i>; the prime meridian is west, as in
+ * <i>W000S60</i>.
+ *
+ * @param int				theLatitude			Corner latitude.
+ * @param int				theLongitude		Corner longitude.
+ *
+ * @access private
+ * @return string
+ */
+static string GetTileName( int theLatitude, int theLongitude )
+{
+	char name [ 32 ];
+	sprintf( name, "%c%03d%c%02d",
+			 ( theLongitude <= 0 ) ? 'W' : 'E', abs( theLongitude ),
+			 ( theLatitude < 0 ) ? 'S' : 'N', abs( theLatitude ) );
+
+	return name;																// ==>
+
+} // GetTileName.
+
+
+/*===================================================================================
+ *	main																			*
+ *==================================================================================*/
+
+/**
+ * Test built-in tiles.
+ *
+ * @access public
+ * @return int
+ */
+int main()
+{
+	int failures = 0;
+
+	//
+	// Check names.
+	//
+	for( int tile = 0; tile < kGTOPO30_TilesCount; tile++ )
+	{
+		const TILES_T & entry = kGTOPO30_Tiles[ tile ];
+		string name = GetTileName( (int) entry.area.latMax, (int) entry.area.lonMin );
+		if( name != entry.name )
+		{
+			cerr << "Tile " << entry.name << " has the corner of " << name << "\n";
+			failures++;
+		}
+	}
+
+	//
+	// Check coverage.
+	// Tile bounds are whole degrees, so each degree cell must be in exactly one tile.
+	//
+	for( int latitude = -90; latitude < 90; latitude++ )
+	{
+		for( int longitude = -180; longitude < 180; longitude++ )
+		{
+			int count = 0;
+			for( int tile = 0; tile < kGTOPO30_TilesCount; tile++ )
+			{
+				const AREA_T & area = kGTOPO30_Tiles[ tile ].area;
+				count += (latitude >= area.latMin) && (latitude < area.latMax)
+					  && (longitude >= area.lonMin) && (longitude < area.lonMax);
+			}
+			if( count != 1 )
+			{
+				cerr << "Degree cell " << latitude << ' ' << longitude << " is in "
+					 << count << " tiles\n";
+				failures++;
+			}
+		}
+	}
+
+	if( failures )
+		return 1;																// ==>
+
+	cout << "Tiles: OK\n";
+
+	return 0;																	// ==>
+
+} // main.
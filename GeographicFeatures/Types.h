@@ -0,0 +1,34 @@
+/**
+ * Type definitions.
+ *
+ * This file contains the fixed size integer types used throughout the command, they
+ * take the names of the Carbon types the command was written with, so that it does not
+ * depend on the CoreServices framework.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <cstddef>
+#include <stdint.h>
+
+
+/**
+ * Integer types.
+ */
+typedef int8_t SInt8;
+typedef uint8_t UInt8;
+typedef int16_t SInt16;
+typedef uint16_t UInt16;
+typedef int32_t SInt32;
+typedef uint32_t UInt32;
+typedef int64_t SInt64;
+typedef uint64_t UInt64;
+
+#endif // TYPES_H
@@ -0,0 +1,452 @@
+/**
+ * Asynchronous reads.
+ *
+ * This file contains the asynchronous read queue, built directly on the io_uring system
+ * calls so that no library is required: a list of reads is copied into the submission
+ * ring, submitted with a single system call, and the completions are collected as they
+ * arrive; lists longer than the ring are submitted in rounds, keeping the ring full.
+ *
+ * On data stored on network block devices each read has a high latency while many reads
+ * can be served in parallel, so submitting all the reads of a query at once replaces the
+ * sum of the latencies with the latency of the slowest read.
+ *
+ * The queue is only available on Linux: elsewhere, or when the kernel does not support
+ * it, OpenRing() fails and ReadRing() performs the reads with <i>pread</i>, as it does
+ * for any read the kernel rejects.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+/*=======================================================================================
+ *																						*
+ *										Uring.cpp										*
+ *																						*
+ *======================================================================================*/
+
+/**
+ * System includes.
+ */
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+/**
+ * Local includes.
+ */
+#include "Uring.h"											// Asynchronous reads.
+#include "Stats.h"											// Statistics.
+
+
+/*===================================================================================
+ *	OpenRing																		*
+ *==================================================================================*/
+
+/**
+ * Open read queue.
+ *
+ * This function will create an io_uring queue with the provided number of submission
+ * entries and map its rings; the function returns FALSE if the queue is not available,
+ * in which case the ring is left closed.
+ *
+ * @param URING_T *			theRing				Receives ring.
+ * @param unsigned			theEntries			Number of submission entries.
+ *
+ * @access public
+ * @return bool
+ */
+bool OpenRing( URING_T * theRing, unsigned theEntries )
+{
+	memset( theRing, 0, sizeof( URING_T ) );
+	theRing->fd = -1;
+
+#ifdef __linux__
+	//
+	// Create ring.
+	//
+	struct io_uring_params params;
+	memset( &params, 0, sizeof( params ) );
+	int fd = syscall( __NR_io_uring_setup, theEntries, &params );
+	if( fd < 0 )
+		return false;															// ==>
+
+	//
+	// Map rings.
+	// Recent kernels share a single mapping for both rings.
+	//
+	theRing->fd = fd;
+	theRing->entries = params.sq_entries;
+	theRing->sqSize = params.sq_off.array + (params.sq_entries * sizeof( unsigned ));
+	theRing->cqSize = params.cq_off.cqes
+					+ (params.cq_entries * sizeof( struct io_uring_cqe ));
+	if( params.features & IORING_FEAT_SINGLE_MMAP )
+	{
+		if( theRing->cqSize > theRing->sqSize )
+			theRing->sqSize = theRing->cqSize;
+		theRing->cqSize = 0;
+	}
+	theRing->sqMap = mmap( NULL, theRing->sqSize, PROT_READ | PROT_WRITE,
+						   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING );
+	theRing->cqMap = ( theRing->cqSize )
+				   ? mmap( NULL, theRing->cqSize, PROT_READ | PROT_WRITE,
+						   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING )
+				   : theRing->sqMap;
+	theRing->sqeSize = params.sq_entries * sizeof( struct io_uring_sqe );
+	theRing->sqeMap = mmap( NULL, theRing->sqeSize, PROT_READ | PROT_WRITE,
+							MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES );
+	if( (theRing->sqMap == MAP_FAILED)
+	 || (theRing->cqMap == MAP_FAILED)
+	 || (theRing->sqeMap == MAP_FAILED) )
+	{
+		CloseRing( theRing );
+		return false;															// ==>
+	}
+
+	//
+	// Set ring fields.
+	//
+	char * sq = (char *) theRing->sqMap;
+	char * cq = (char *) theRing->cqMap;
+	theRing->sqHead = (unsigned *) (sq + params.sq_off.head);
+	theRing->sqTail = (unsigned *) (sq + params.sq_off.tail);
+	theRing->sqMask = (unsigned *) (sq + params.sq_off.ring_mask);
+	theRing->sqArray = (unsigned *) (sq + params.sq_off.array);
+	theRing->cqHead = (unsigned *) (cq + params.cq_off.head);
+	theRing->cqTail = (unsigned *) (cq + params.cq_off.tail);
+	theRing->cqMask = (unsigned *) (cq + params.cq_off.ring_mask);
+	theRing->cqes = cq + params.cq_off.cqes;
+
+	return true;																// ==>
+#else
+	(void) theEntries;
+
+	return false;																// ==>
+#endif
+
+} // OpenRing.
+
+
+/*===================================================================================
+ *	CloseRing																		*
+ *==================================================================================*/
+
+/**
+ * Close read queue.
+ *
+ * This function will unmap the rings and close the queue.
+ *
+ * @param URING_T *			theRing				Ring.
+ *
+ * @access public
+ * @return void
+ */
+void CloseRing( URING_T * theRing )
+{
+	if( (theRing->sqeMap != NULL)
+	 && (theRing->sqeMap != MAP_FAILED) )
+		munmap( theRing->sqeMap, theRing->sqeSize );
+	if( theRing->cqSize
+	 && (theRing->cqMap != NULL)
+	 && (theRing->cqMap != MAP_FAILED) )
+		munmap( theRing->cqMap, theRing->cqSize );
+	if( (theRing->sqMap != NULL)
+	 && (theRing->sqMap != MAP_FAILED) )
+		munmap( theRing->sqMap, theRing->sqSize );
+	if( theRing->fd >= 0 )
+		close( theRing->fd );
+
+	memset( theRing, 0, sizeof( URING_T ) );
+	theRing->fd = -1;
+
+} // CloseRing.
+
+
+/*===================================================================================
+ *	ReadRing																		*
+ *==================================================================================*/
+
+/**
+ * Perform reads.
+ *
+ * This function will perform the provided list of reads and set their results: the reads
+ * are submitted to the provided ring, if open, and the function returns once all have
+ * completed. Reads the kernel rejects, and all reads if the ring is not open, are
+ * performed with <i>pread</i>.
+ *
+ * @param URING_T *			theRing				Ring, or NULL.
+ * @param IO_READ_T *		theReads			Reads.
+ * @param size_t			theCount			Number of reads.
+ *
+ * @access public
+ * @return void
+ */
+void ReadRing( URING_T * theRing, IO_READ_T * theReads, size_t theCount )
+{
+	size_t next = 0;
+
+#ifdef __linux__
+	if( (theRing != NULL)
+	 && (theRing->fd >= 0) )
+	{
+		struct io_uring_sqe * sqes = (struct io_uring_sqe *) theRing->sqeMap;
+		struct io_uring_cqe * cqes = (struct io_uring_cqe *) theRing->cqes;
+		unsigned pending = 0, queued = 0;
+		bool failed = false;
+		while( (pending > 0)
+			|| ((next < theCount) && (! failed)) )
+		{
+			//
+			// Queue reads.
+			// In flight reads are bounded by the ring size, so that completions
+			// never overflow.
+			//
+			unsigned tail = *theRing->sqTail;
+			while( (! failed)
+				&& (next < theCount)
+				&& ((pending + queued) < theRing->entries) )
+			{
+				unsigned index = tail & *theRing->sqMask;
+				struct io_uring_sqe * sqe = &sqes[ index ];
+				memset( sqe, 0, sizeof( struct io_uring_sqe ) );
+				sqe->opcode = IORING_OP_READ;
+				sqe->fd = theReads[ next ].fd;
+				sqe->addr = (unsigned long) theReads[ next ].buffer;
+				sqe->len = theReads[ next ].length;
+				sqe->off = theReads[ next ].offset;
+				sqe->user_data = next;
+				theRing->sqArray[ index ] = index;
+				tail++;
+				next++;
+				queued++;
+			}
+			__atomic_store_n( theRing->sqTail, tail, __ATOMIC_RELEASE );
+
+			//
+			// Submit and wait.
+			//
+			AddReads( 0, 1 );
+			int submitted = syscall( __NR_io_uring_enter, theRing->fd, queued, 1,
+									 IORING_ENTER_GETEVENTS, NULL, 0 );
+			if( submitted < 0 )
+			{
+				if( (errno == EINTR)
+				 || (errno == EAGAIN)
+				 || (errno == EBUSY) )
+					continue;													// =>
+
+				//
+				// Give up the ring.
+				// Queued reads are withdrawn and performed with pread along with the
+				// remaining ones, in flight reads are still collected.
+				//
+				__atomic_store_n( theRing->sqTail, tail - queued, __ATOMIC_RELEASE );
+				next -= queued;
+				queued = 0;
+				failed = true;
+				if( ! pending )
+					break;														// =>
+				AddReads( 0, 1 );
+				if( syscall( __NR_io_uring_enter, theRing->fd, 0, 1,
+							 IORING_ENTER_GETEVENTS, NULL, 0 ) < 0 )
+					continue;													// =>
+			}
+			else
+			{
+				pending += submitted;
+				queued -= submitted;
+			}
+
+			//
+			// Collect completions.
+			//
+			unsigned head = *theRing->cqHead;
+			unsigned last = __atomic_load_n( theRing->cqTail, __ATOMIC_ACQUIRE );
+			while( head != last )
+			{
+				struct io_uring_cqe * cqe = &cqes[ head & *theRing->cqMask ];
+				theReads[ cqe->user_data ].result = cqe->res;
+				head++;
+				pending--;
+			}
+			__atomic_store_n( theRing->cqHead, head, __ATOMIC_RELEASE );
+
+		} // Submitting.
+
+		//
+		// Retry rejected reads.
+		// Kernels without the read operation reject all reads.
+		//
+		for( size_t i = 0; i < next; i++ )
+		{
+			if( (theReads[ i ].result == -EINVAL)
+			 || (theReads[ i ].result == -EOPNOTSUPP) )
+			{
+				AddReads( 0, 1 );
+				theReads[ i ].result = pread( theReads[ i ].fd, theReads[ i ].buffer,
+											  theReads[ i ].length,
+											  theReads[ i ].offset );
+			}
+		}
+
+	} // Ring open.
+#else
+	(void) theRing;
+#endif
+
+	//
+	// Read synchronously.
+	//
+	AddReads( 0, theCount - next );
+	for( size_t i = next; i < theCount; i++ )
+		theReads[ i ].result = pread( theReads[ i ].fd, theReads[ i ].buffer,
+									  theReads[ i ].length, theReads[ i ].offset );
+
+} // ReadRing.
+
+
+/*===================================================================================
+ *	SubmitRing																		*
+ *==================================================================================*/
+
+/**
+ * Submit reads.
+ *
+ * This function will submit the provided reads to the provided ring without waiting for
+ * their completion and return the number of reads submitted, starting from the first;
+ * reads that do not fit in the ring are left to the caller, who will submit them once
+ * completions are collected with ReapRing(). The ring descriptor becomes readable when
+ * completions are available, so it can be watched by an event loop.
+ *
+ * Reads submitted here must not be mixed with ReadRing() on the same ring.
+ *
+ * @param URING_T *			theRing				Ring.
+ * @param IO_READ_T * const *	theReads		Reads.
+ * @param size_t			theCount			Number of reads.
+ *
+ * @access public
+ * @return size_t
+ */
+size_t SubmitRing( URING_T * theRing, IO_READ_T * const * theReads, size_t theCount )
+{
+#ifdef __linux__
+	//
+	// Queue reads.
+	// In flight reads are bounded by the ring size, so that completions never
+	// overflow.
+	//
+	struct io_uring_sqe * sqes = (struct io_uring_sqe *) theRing->sqeMap;
+	unsigned tail = *theRing->sqTail;
+	size_t queued = 0;
+	while( (queued < theCount)
+		&& ((theRing->inflight + queued) < theRing->entries) )
+	{
+		unsigned index = tail & *theRing->sqMask;
+		struct io_uring_sqe * sqe = &sqes[ index ];
+		memset( sqe, 0, sizeof( struct io_uring_sqe ) );
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = theReads[ queued ]->fd;
+		sqe->addr = (unsigned long) theReads[ queued ]->buffer;
+		sqe->len = theReads[ queued ]->length;
+		sqe->off = theReads[ queued ]->offset;
+		sqe->user_data = (unsigned long) theReads[ queued ];
+		theRing->sqArray[ index ] = index;
+		tail++;
+		queued++;
+	}
+	if( ! queued )
+		return 0;																// ==>
+	__atomic_store_n( theRing->sqTail, tail, __ATOMIC_RELEASE );
+
+	//
+	// Submit.
+	// Entries the kernel did not take are withdrawn.
+	//
+	int submitted;
+	do
+	{
+		AddReads( 0, 1 );
+		submitted = syscall( __NR_io_uring_enter, theRing->fd, queued, 0, 0, NULL, 0 );
+	}
+	while( (submitted < 0)
+		&& (errno == EINTR) );
+	if( submitted < 0 )
+		submitted = 0;
+	if( (size_t) submitted < queued )
+		__atomic_store_n( theRing->sqTail, tail - (queued - submitted),
+						  __ATOMIC_RELEASE );
+	theRing->inflight += submitted;
+
+	return submitted;															// ==>
+#else
+	(void) theRing;
+	(void) theReads;
+	(void) theCount;
+
+	return 0;																	// ==>
+#endif
+
+} // SubmitRing.
+
+
+/*===================================================================================
+ *	ReapRing																		*
+ *==================================================================================*/
+
+/**
+ * Collect completed reads.
+ *
+ * This function will collect up to the provided number of completed reads submitted with
+ * SubmitRing(), set their results and return them in the provided list; the function
+ * does not wait and returns the number of reads collected. Reads the kernel rejects are
+ * performed here with <i>pread</i>.
+ *
+ * @param URING_T *			theRing				Ring.
+ * @param IO_READ_T **		theReads			Receives completed reads.
+ * @param size_t			theCount			Maximum number of reads.
+ *
+ * @access public
+ * @return size_t
+ */
+size_t ReapRing( URING_T * theRing, IO_READ_T ** theReads, size_t theCount )
+{
+	size_t count = 0;
+
+#ifdef __linux__
+	struct io_uring_cqe * cqes = (struct io_uring_cqe *) theRing->cqes;
+	unsigned head = *theRing->cqHead;
+	unsigned last = __atomic_load_n( theRing->cqTail, __ATOMIC_ACQUIRE );
+	while( (head != last)
+		&& (count < theCount) )
+	{
+		struct io_uring_cqe * cqe = &cqes[ head & *theRing->cqMask ];
+		IO_READ_T * read = (IO_READ_T *) (unsigned long) cqe->user_data;
+		read->result = cqe->res;
+		if( (read->result == -EINVAL)
+		 || (read->result == -EOPNOTSUPP) )
+		{
+			AddReads( 0, 1 );
+			read->result = pread( read->fd, read->buffer, read->length, read->offset );
+		}
+		theReads[ count++ ] = read;
+		head++;
+	}
+	__atomic_store_n( theRing->cqHead, head, __ATOMIC_RELEASE );
+	theRing->inflight -= count;
+#else
+	(void) theRing;
+	(void) theReads;
+	(void) theCount;
+#endif
+
+	return count;																// ==>
+
+} // ReapRing.
@@ -0,0 +1,72 @@
+/**
+ * Asynchronous reads definitions.
+ *
+ * This file contains the declarations of the asynchronous read queue: the reads of a
+ * query are submitted together to an io_uring queue and completed in parallel by the
+ * kernel, rather than issued one after the other.
+ *
+ *	@package	WebServices
+ *	@subpackage	GeographicFeatures
+ *
+ *	@author		Milko A. Škofič <m.skofic@cgiar.org>
+ *	@version	1.00 06/01/2010
+ */
+
+#ifndef URING_H
+#define URING_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Types.h"
+
+using namespace std;
+
+#include "Structures.h"
+
+
+/**
+ * Ring size.
+ *
+ * This constant holds the number of submission entries of a ring, larger lists of reads
+ * are submitted in several rounds.
+ */
+const unsigned kURING_Entries = 256;
+
+/**
+ * OpenRing.
+ *
+ * Open a read queue.
+ */
+bool OpenRing( URING_T * theRing, unsigned theEntries );
+
+/**
+ * CloseRing.
+ *
+ * Close a read queue.
+ */
+void CloseRing( URING_T * theRing );
+
+/**
+ * ReadRing.
+ *
+ * Perform a list of reads.
+ */
+void ReadRing( URING_T * theRing, IO_READ_T * theReads, size_t theCount );
+
+/**
+ * SubmitRing.
+ *
+ * Submit reads without waiting.
+ */
+size_t SubmitRing( URING_T * theRing, IO_READ_T * const * theReads, size_t theCount );
+
+/**
+ * ReapRing.
+ *
+ * Collect completed reads without waiting.
+ */
+size_t ReapRing( URING_T * theRing, IO_READ_T ** theReads, size_t theCount );
+
+#endif // URING_H
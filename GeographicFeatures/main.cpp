@@ -25,15 +25,40 @@
 #include <fstream>
 #include <sstream>
 #include <string>
-#include <CoreServices/CoreServices.h>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
 /**
  * Local includes.
  */
+#include "Types.h"											// Integer types.
 #include "Errors.h"											// Error codes.
 #include "Constants.h"										// Constants.
+#include "Registry.h"										// Dataset registry.
+#include "Bioclim.h"										// Bioclimatic variables.
+#include "Indices.h"										// Agro-climatic indices.
+#include "Server.h"											// HTTP server.
+#include "Uring.h"											// Asynchronous reads.
+#include "Stats.h"											// Statistics.
+#include "Parse.h"											// Coordinate parser.
+#include "Arena.h"											// Scratch arena.
+
+/**
+ * Reload signal descriptor.
+ *
+ * This variable holds the write end of the pipe signalling dataset reloads to the server,
+ * it is written by the <i>SIGHUP</i> handler.
+ */
+static int reloadSignal = -1;
 
 /**
  * WriteHeader.
@@ -42,65 +67,402 @@ using namespace std;
  */
 void WriteHeader( bool doClose = false );
 
+/**
+ * SetLegend.
+ *
+ * Build dataset XML legend.
+ */
+void SetLegend( DATASET_T * theDataset );
+
 /**
  * WriteLegend.
  *
  * Write XML legend to output.
  */
-void WriteLegend();
+void WriteLegend( const DATASET_T & theDataset );
 
 /**
  * CheckArguments.
  *
  * Check provided arguments.
  */
-int CheckArguments( const int theCount, char * const theArguments[] );
+int CheckArguments( const int theCount, char * const theArguments[],
+					OPTIONS_T * theOptions );
 
 /**
  * GetLatitude.
  *
  * Parse latitude.
  */
-int GetLatitude( char * const theArgument, double * theCoordinate );
+int GetLatitude( const char * theArgument, double * theCoordinate );
 
 /**
  * GetLongitude.
  *
  * Parse longitude.
  */
-int GetLongitude( char * const theArgument, double * theCoordinate );
+int GetLongitude( const char * theArgument, double * theCoordinate );
+
+/**
+ * GetBatch.
+ *
+ * Parse batch coordinates file.
+ */
+int GetBatch( const string & theFile, vector<double> * theLatitudes,
+			  vector<double> * theLongitudes, vector<PARSE_T> * theErrors );
+
+/**
+ * OpenDataset.
+ *
+ * Load dataset registry.
+ */
+int OpenDataset( const OPTIONS_T & theOptions, DATASET_T * theDataset,
+				 QUERY_T * theQuery );
+
+/**
+ * ResolveQuery.
+ *
+ * Resolve scenarios and layers.
+ */
+int ResolveQuery( const OPTIONS_T & theOptions, const DATASET_T & theDataset,
+				  QUERY_T * theQuery );
 
 /**
  * SetCoordinate.
  *
  * Write coordinate element (and get altitude).
  */
-int SetCoordinate( char * const theDirectory, double theLatitude, double theLongitude,
-				  int * theAltitude );
+int SetCoordinate( const DATASET_T & theDataset, double theLatitude, double theLongitude,
+				  int * theAltitude, bool doLocation = false,
+				  const READ_T * theElevation = NULL );
+
+/**
+ * GetWORLDCLIMFeatures.
+ *
+ * Read WORLDCLIM features of a set of points.
+ */
+void GetWORLDCLIMFeatures( const DATASET_T & theDataset, const QUERY_T & theQuery,
+						   const double * theLatitudes, const double * theLongitudes,
+						   size_t theCount, FEATURES_T * theFeatures );
+
+/**
+ * GetWORLDCLIMReads.
+ *
+ * Collect WORLDCLIM features reads of a set of points.
+ */
+void GetWORLDCLIMReads( const DATASET_T & theDataset, const QUERY_T & theQuery,
+						const double * theLatitudes, const double * theLongitudes,
+						size_t theCount, FEATURES_T * theFeatures );
+
+/**
+ * GetDerivedFeatures.
+ *
+ * Compute derived features of a set of points.
+ */
+void GetDerivedFeatures( const DATASET_T & theDataset, const QUERY_T & theQuery,
+						 const double * theLatitudes, FEATURES_T * theFeatures );
+
+/**
+ * SetWORLDCLIMFeatures.
+ *
+ * Write WORLDCLIM features of a point for all scenarios.
+ */
+int SetWORLDCLIMFeatures( const DATASET_T & theDataset, const QUERY_T & theQuery,
+						  const FEATURES_T & theFeatures, size_t thePoint,
+						  const char * theIndent );
 
 /**
  * SetWORLDCLIMFeature.
  *
  * Write WORLDCLIM feature.
  */
-int SetWORLDCLIMFeature( char * const theDirectory, double theLatitude, double theLongitude,
-						 const int theFeature );
+int SetWORLDCLIMFeature( const DATASET_T & theDataset, const int theFeature,
+						 const READ_T * theReads, const char * theIndent,
+						 bool doPacked = false );
+
+/**
+ * SetDerivedFeature.
+ *
+ * Write derived feature.
+ */
+void SetDerivedFeature( const LAYER_T & theLayer, float theValue, const char * theIndent );
+
+/**
+ * SetLocation.
+ *
+ * Write coordinate and features of a point.
+ */
+int SetLocation( const DATASET_T & theDataset, const QUERY_T & theQuery,
+				 double theLatitude, double theLongitude, FEATURES_T * theFeatures = NULL );
+
+/**
+ * ServeRequest.
+ *
+ * Handle a server request.
+ */
+bool ServeRequest( const HTTP_REQUEST_T & theRequest, HTTP_RESPONSE_T * theResponse,
+				   void * theContext );
+
+/**
+ * PollRequests.
+ *
+ * Complete pending server requests.
+ */
+void PollRequests( void * theContext, int theDescriptor,
+				   vector<HTTP_RESPONSE_T *> * theResponses );
+
+/**
+ * SubmitRequests.
+ *
+ * Submit pending server requests reads.
+ */
+void SubmitRequests( SERVICE_T * theService, vector<HTTP_RESPONSE_T *> * theResponses );
+
+/**
+ * CompleteRequests.
+ *
+ * Complete server requests reads.
+ */
+void CompleteRequests( SERVICE_T * theService, IO_READ_T * const * theReads, size_t theCount,
+					   vector<HTTP_RESPONSE_T *> * theResponses );
+
+/**
+ * ReloadDataset.
+ *
+ * Replace the server dataset.
+ */
+void ReloadDataset( SERVICE_T * theService );
+
+/**
+ * ReleaseDataset.
+ *
+ * Release a server request dataset.
+ */
+void ReleaseDataset( SERVICE_T * theService, DATASET_T * theDataset );
+
+/**
+ * RequestReload.
+ *
+ * Signal a dataset reload to the server.
+ */
+void RequestReload( int theSignal );
+
+/**
+ * WriteExitStats.
+ *
+ * Write statistics on exit.
+ */
+void WriteExitStats();
+
+/**
+ * RecordCell.
+ *
+ * Record a server query in the heat map.
+ */
+void RecordCell( SERVICE_T * theService, double theLatitude, double theLongitude );
+
+/**
+ * GetHeatMap.
+ *
+ * Load the server heat map.
+ */
+void GetHeatMap( const string & theFile, map<UInt64, UInt32> * theHeat );
+
+/**
+ * SetHeatMap.
+ *
+ * Save the server heat map.
+ */
+void SetHeatMap( const string & theFile, map<UInt64, UInt32> * theHeat );
+
+/**
+ * PrewarmDataset.
+ *
+ * Load the pages of the most queried cells.
+ */
+void PrewarmDataset( DATASET_T * theDataset, const map<UInt64, UInt32> & theHeat,
+					 UInt64 theLock );
+
+/**
+ * LockDataset.
+ *
+ * Lock the pages of a dataset within a budget and log any shortfall.
+ */
+void LockDataset( DATASET_T * theDataset, const READ_T * theReads, size_t theCount,
+				  UInt64 theBudget );
+
+/**
+ * GetCellsKey.
+ *
+ * Get the key of the cells read by a set of reads.
+ */
+void GetCellsKey( const DATASET_T & theDataset, const vector<READ_T> & theReads,
+				  string * theKey );
+
+/**
+ * SetRequest.
+ *
+ * Write the response of a pending server request.
+ */
+void SetRequest( const DATASET_T & theDataset, TASK_T * theTask );
+
+/**
+ * SetBatch.
+ *
+ * Write features of a set of points.
+ */
+int SetBatch( const DATASET_T & theDataset, const QUERY_T & theQuery,
+			  const vector<double> & theLatitudes, const vector<double> & theLongitudes,
+			  const vector<PARSE_T> & theErrors );
+
+/**
+ * SetBioclimZone.
+ *
+ * Write bioclimatic variables summary of an area.
+ */
+int SetBioclimZone( const DATASET_T & theDataset, const double * theArea,
+					const QUERY_T & theQuery );
+
+/**
+ * SetRepack.
+ *
+ * Write a layer monthly series into an interleaved cube.
+ */
+int SetRepack( const DATASET_T & theDataset, const string & theLayer,
+			   const string & thePath );
+
+/**
+ * SetGenerate.
+ *
+ * Write a synthetic dataset.
+ */
+int SetGenerate( const string & theDirectory, int theScale );
+
+/**
+ * SetNative.
+ *
+ * Convert the dataset files to the host byte order.
+ */
+int SetNative( const DATASET_T & theDataset );
+
+/**
+ * SetBench.
+ *
+ * Write benchmark results.
+ */
+int SetBench( const DATASET_T & theDataset, const QUERY_T & theQuery, size_t theCount );
+
+/**
+ * GetRandom.
+ *
+ * Get a pseudo-random number.
+ */
+double GetRandom( UInt64 * theState );
+
+/**
+ * WriteValue.
+ *
+ * Write feature value.
+ */
+void WriteValue( const LAYER_T & theLayer, SInt16 theValue );
 
 
 /**
  * MAIN.
  *
- * This command line tool expects three arguments:
+ * This command line tool expects three arguments, optionally preceded by options:
  *
  * <ul>
+ *	<li><b>--manifest</b> <i>[string]</i>: Dataset manifest file path, the manifest
+ *		describes the GTOPO-30 tiles and the WORLDCLIM layers, see <i>Registry.cpp</i>
+ *		for its structure. If omitted, the <i>GeographicFeatures.ini</i> file of the base
+ *		directory is used if it exists, otherwise the built-in tables are used.
+ *	<li><b>--scenario</b> <i>[string]</i>: Scenario name, the option can be repeated; the
+ *		features of the provided scenarios are returned after the base dataset features,
+ *		grouped in a <i>Scenario</i> element per scenario. Bioclimatic variables missing
+ *		from a scenario are computed from its monthly series.
+ *	<li><b>--bbox</b> <i>[double double double double]</i>: Minimum and maximum latitude,
+ *		minimum and maximum longitude of an area; in this case the latitude and longitude
+ *		arguments are omitted and the function returns, for each scenario, the count,
+ *		minimum, maximum and mean of the bioclimatic variables computed over the land
+ *		cells of the area.
+ *	<li><b>--layer</b> <i>[string]</i>: Layer name, the option can be repeated; only the
+ *		features of the provided layers are returned. The built-in derived layers,
+ *		<i>gdd5</i>, <i>gdd10</i>, <i>pet</i>, <i>aridity</i> and <i>frost</i>, are
+ *		computed from the monthly series, so selecting them avoids returning the monthly
+ *		values; they, and the agro-climatic layers of the manifest, are only returned
+ *		when selected.
+ *	<li><b>--batch</b> <i>[string]</i>: Coordinates file, each line holds a latitude and a
+ *		longitude separated by blanks, tabs, commas or semicolons, <i>-</i> means the
+ *		standard input; in this case the latitude and longitude arguments are omitted
+ *		and the function returns a <i>Location</i> element per point. All points are read
+ *		in one pass and the derived features of all points are computed together.
+ *	<li><b>--packed</b>: Monthly series are returned in a single <i>Feature</i> element per
+ *		layer, holding the 12 values separated by a space, with a <i>Reference</i> of
+ *		<i>1-12</i>; series with missing months are omitted.
+ *	<li><b>--repack</b> <i>[string string]</i>: Layer name and file path, the monthly
+ *		series of the layer is written into a band interleaved by pixel cube, which can
+ *		then be declared in the manifest with <i>layout = bip</i>; in this case only the
+ *		base directory argument is expected.
+ *	<li><b>--io</b> <i>[string]</i>: I/O mode, <i>mmap</i> (default) reads the values from
+ *		memory mapped files, <i>uring</i> submits all the reads of a query, or of a batch,
+ *		at once to an io_uring queue, which pays off on storage with high latency and
+ *		high parallelism; if the queue is not available the files are read with
+ *		<i>pread</i>. <i>pread</i> never maps the files, for file systems where mapping
+ *		is unreliable, and reads the values from the files opened at load.
+ *	<li><b>--hugepages</b>: Mapped files are aligned and advised for transparent huge
+ *		pages, so that random lookups over large layers need fewer translation entries.
+ *	<li><b>--lock</b> <i>[integer]</i>: Number of megabytes of the mapped files locked in
+ *		memory when the dataset is loaded, whole files in dataset order while they fit;
+ *		with a heat map the server locks the pages of the hottest cells first.
+ *	<li><b>--listen</b> <i>[string]</i>: Server address, <i>[host:]port</i>; the dataset
+ *		is loaded once and the command serves HTTP requests until it fails, in this case
+ *		only the base directory argument is expected. Requests take the <i>lat</i>,
+ *		<i>lon</i>, <i>scenario</i>, <i>layer</i> and <i>packed</i> parameters, in the
+ *		query string or in a form body, and get the same XML document as the command.
+ *		With the <i>uring</i> I/O mode the reads of each request are queued and the
+ *		server keeps handling other requests until they complete. Requests with the
+ *		<i>priority=batch</i> parameter are admitted after interactive requests. On
+ *		<i>SIGHUP</i> the dataset is reloaded without interrupting the service.
+ *	<li><b>--concurrency</b> <i>[integer]</i>: Maximum number of server requests in
+ *		progress, further requests wait for admission in a queue per client; clients are
+ *		served in turn.
+ *	<li><b>--queue</b> <i>[integer]</i>: Maximum number of server requests waiting for
+ *		admission, further requests are answered with <i>503</i> and a
+ *		<i>Retry-After</i> header.
+ *	<li><b>--deadline</b> <i>[integer]</i>: Number of seconds a server request may wait
+ *		for admission before it is answered with <i>503</i>.
+ *	<li><b>--heatmap</b> <i>[string]</i>: Server heat map file, it holds the number of
+ *		queries of the most queried cells and is saved periodically; when the server
+ *		starts, or reloads, the pages of the hottest cells of all layers are loaded in
+ *		the background, so that the service does not start on a cold cache.
+ *	<li><b>--stats</b>: On exit, write to the standard error the count, mean,
+ *		percentiles and maximum duration of each stage of the queries, parsing, dataset
+ *		loading, cell lookup, reads, derived features and XML writing, along with the
+ *		bytes and system calls of the reads and the page faults. The server returns the
+ *		same statistics at the <i>/stats</i> path.
+ *	<li><b>--generate</b> <i>[integer]</i>: Scale, a synthetic dataset with the layout of
+ *		the built-in tables and grids of the provided multiple of 30 seconds is written
+ *		into the base directory, along with its manifest; in this case only the base
+ *		directory argument is expected.
+ *	<li><b>--native</b>: The dataset files stored in the byte order opposite to the host
+ *		byte order, as declared in their headers, are rewritten in the host byte order,
+ *		so that they are read without conversion; in this case only the base directory
+ *		argument is expected.
+ *	<li><b>--bench</b> <i>[integer]</i>: Number of points, the dataset is queried with
+ *		reproducible workloads of single points, random and clustered batches, small
+ *		and large areas, and a <i>Benchmark</i> element is written per workload with
+ *		its throughput, latency percentiles and reads per query; in this case only the
+ *		base directory argument is expected.
  *	<li><b>Base directory</b> <i>[string]</i>: This string represents the base directory of
  *		the geographic features files, the path must be terminated by a '/' character and
  *		the referenced directory has the following structure:
  *	 <ul>
  *		<li><i>GTOPO30</i>: This directory contains the GTOPO 30 seconds elevation tiles,
- *			the directory contains 34 tiles covering the whole earth, each tile is
+ *			the directory contains 33 tiles covering the whole earth, each tile is
  *			represented by a directory containing a series of files named as the enclosing
- *			directory, of which the <i>.DEM</i> file represents the elevation raw data.
+ *			directory, of which the <i>.DEM</i> file represents the elevation raw data; the
+ *			polar stereographic <i>ANTARCPS</i> tile is not used.
  *		<li><i>WORLDCLIM30</i>: This directory contains the WORLDCLIM climate datasets, it
  *			contains a series of directories each containin a <i>.bil</i> file representing
  *			the raw data and a <i>.hdr</i> file representing the header:
@@ -134,8 +496,11 @@ int SetWORLDCLIMFeature( char * const theDirectory, double theLatitude, double t
  *			 </ul>
  *		 </ul>
  *	 </ul>
- *	<li><b>Latitude</b> <i>[double]</i>: The latitude expressed in decimal degrees.
- *	<li><b>Longitude</b> <i>[double]</i>: The longitude expressed in decimal degrees.
+ *	<li><b>Latitude</b> <i>[double]</i>: The latitude expressed in decimal degrees, or in
+ *		degrees, minutes and seconds as <i>12°30'15"</i> or <i>12:30:15</i>, with a sign
+ *		or a trailing or leading <i>N</i> or <i>S</i>.
+ *	<li><b>Longitude</b> <i>[double]</i>: The longitude expressed as the latitude, with
+ *		<i>E</i> or <i>W</i> as hemisphere.
  * </ul>
  *
  * The function will return an XML
@@ -171,54 +536,258 @@ int main( int argc, char * const argv[] )
 	//
 	// Local storage.
 	//
-	int error, feature, theAltitude;
+	int error;
 	double theLatitude, theLongitude;
+	OPTIONS_T theOptions;
+	DATASET_T theDataset;
+	QUERY_T theQuery;
+	StartStats();
 	
 	//
 	// Check arguments.
 	//
-	if( (error = CheckArguments( argc, argv )) )
+	if( (error = CheckArguments( argc, argv, &theOptions )) )
 		return error;															// ==>
 	
 	//
-	// Get latitude.
+	// Handle statistics.
 	//
-	error = GetLatitude( argv[ 2 ], &theLatitude );
-	if( error )
-		return error;															// ==>
+	if( theOptions.stats )
+		atexit( WriteExitStats );
 	
 	//
-	// Get longitude.
+	// Handle synthetic dataset.
 	//
-	error = GetLongitude( argv[ 3 ], &theLongitude );
-	if( error )
-		return error;															// ==>
+	if( theOptions.generate )
+		return SetGenerate( theOptions.directory, theOptions.generate );		// ==>
 	
 	//
-	// Set coordinate.
+	// Handle repack.
 	//
-	error = SetCoordinate( argv[ 1 ], theLatitude, theLongitude, &theAltitude );
-	if( error )
+	if( theOptions.repack[ 0 ].size() )
+	{
+		error = OpenDataset( theOptions, &theDataset, &theQuery );
+		if( error )
+			return error;														// ==>
+		
+		return SetRepack( theDataset, theOptions.repack[ 0 ],
+						  theOptions.repack[ 1 ] );								// ==>
+		
+	} // Repack.
+	
+	//
+	// Handle byte order conversion.
+	//
+	if( theOptions.native )
+	{
+		error = OpenDataset( theOptions, &theDataset, &theQuery );
+		if( error )
+			return error;														// ==>
+		
+		return SetNative( theDataset );											// ==>
+		
+	} // Byte order conversion.
+	
+	//
+	// Handle benchmark.
+	//
+	if( theOptions.bench )
+	{
+		error = OpenDataset( theOptions, &theDataset, &theQuery );
+		if( error )
+			return error;														// ==>
+		
+		return SetBench( theDataset, theQuery, theOptions.bench );				// ==>
+		
+	} // Benchmark.
+	
+	//
+	// Handle server.
+	//
+	if( theOptions.listen.size() )
+	{
+		//
+		// Load dataset.
+		// The dataset is replaced on reload.
+		//
+		SERVICE_T service;
+		service.dataset = new DATASET_T;
+		service.options = &theOptions;
+		service.reload = -1;
+		service.wake[ 0 ] = service.wake[ 1 ] = -1;
+		service.recorded = 0;
+		error = OpenDataset( theOptions, service.dataset, &theQuery );
+		if( error )
+			return error;														// ==>
+		
+		//
+		// Prewarm dataset.
+		//
+		if( theOptions.heatmap.size() )
+		{
+			GetHeatMap( theOptions.heatmap, &service.heat );
+			PrewarmDataset( service.dataset, service.heat, theOptions.lock );
+		}
+		
+		//
+		// Handle reload signal.
+		//
+		vector<int> events;
+		int pipes[ 2 ];
+		if( ! pipe( pipes ) )
+		{
+			fcntl( pipes[ 0 ], F_SETFL, fcntl( pipes[ 0 ], F_GETFL ) | O_NONBLOCK );
+			fcntl( pipes[ 1 ], F_SETFL, fcntl( pipes[ 1 ], F_GETFL ) | O_NONBLOCK );
+			service.reload = pipes[ 0 ];
+			reloadSignal = pipes[ 1 ];
+			events.push_back( service.reload );
+			
+			struct sigaction action;
+			memset( &action, 0, sizeof( action ) );
+			action.sa_handler = RequestReload;
+			action.sa_flags = SA_RESTART;
+			sigaction( SIGHUP, &action, NULL );
+		}
+		
+		//
+		// Handle read completions.
+		// Requests completed while serving another request are signalled by a pipe.
+		//
+		if( service.dataset->ring != NULL )
+		{
+			events.push_back( service.dataset->ring->fd );
+			if( ! pipe( service.wake ) )
+			{
+				fcntl( service.wake[ 0 ], F_SETFL,
+					   fcntl( service.wake[ 0 ], F_GETFL ) | O_NONBLOCK );
+				fcntl( service.wake[ 1 ], F_SETFL,
+					   fcntl( service.wake[ 1 ], F_GETFL ) | O_NONBLOCK );
+				events.push_back( service.wake[ 0 ] );
+			}
+		}
+		
+		//
+		// Serve requests.
+		//
+		string message;
+		error = RunServer( theOptions.listen, theOptions.limits, ServeRequest,
+						   PollRequests, events, &service, &message );
+		
+		//
+		// Write status.
+		//
+		WriteHeader( true );
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << message
+				  << "</Status>\n";
+		std::cout << "</WSLocationGeographicFeatures>";
+		
 		return error;															// ==>
+		
+	} // Server.
 	
 	//
-	// Iterate WORLDCLIM features.
+	// Handle area.
 	//
-	for( feature = 0; feature < kWORLDCLIM_FilesCount; feature++ )
+	if( theOptions.bbox )
 	{
 		//
-		// Get feature.
+		// Get bounds.
+		//
+		double theArea [ 4 ];
+		UInt64 start = GetTicks();
+		if( (error = GetLatitude( theOptions.area[ 0 ].c_str(), &theArea[ 0 ] ))
+		 || (error = GetLatitude( theOptions.area[ 1 ].c_str(), &theArea[ 1 ] ))
+		 || (error = GetLongitude( theOptions.area[ 2 ].c_str(), &theArea[ 2 ] ))
+		 || (error = GetLongitude( theOptions.area[ 3 ].c_str(), &theArea[ 3 ] )) )
+			return error;														// ==>
+		AddStage( kSTAT_Parse, start );
+		
+		//
+		// Load dataset.
+		//
+		error = OpenDataset( theOptions, &theDataset, &theQuery );
+		if( error )
+			return error;														// ==>
+		
+		//
+		// Set bioclimatic variables.
 		//
-		error = SetWORLDCLIMFeature( argv[ 1 ], theLatitude, theLongitude, feature );
+		error = SetBioclimZone( theDataset, theArea, theQuery );
 		if( error )
 			return error;														// ==>
 		
-	} // Iterating features.
+		std::cout << "</WSLocationGeographicFeatures>";
+		
+		return kERROR_OK;														// ==>
+		
+	} // Area.
 	
 	//
-	// Close XML message.
+	// Handle batch.
 	//
-	std::cout << "</WSLocationGeographicFeatures>";
+	if( theOptions.batch.size() )
+	{
+		//
+		// Get coordinates.
+		//
+		vector<double> theLatitudes, theLongitudes;
+		vector<PARSE_T> theErrors;
+		UInt64 start = GetTicks();
+		error = GetBatch( theOptions.batch, &theLatitudes, &theLongitudes, &theErrors );
+		if( error )
+			return error;														// ==>
+		AddStage( kSTAT_Parse, start );
+		
+		//
+		// Load dataset.
+		//
+		error = OpenDataset( theOptions, &theDataset, &theQuery );
+		if( error )
+			return error;														// ==>
+		
+		//
+		// Set features.
+		//
+		error = SetBatch( theDataset, theQuery, theLatitudes, theLongitudes, theErrors );
+		if( error )
+			return error;														// ==>
+		
+		std::cout << "</WSLocationGeographicFeatures>";
+		
+		return kERROR_OK;														// ==>
+		
+	} // Batch.
+	
+	//
+	// Get latitude.
+	//
+	UInt64 start = GetTicks();
+	error = GetLatitude( theOptions.latitude.c_str(), &theLatitude );
+	if( error )
+		return error;															// ==>
+	
+	//
+	// Get longitude.
+	//
+	error = GetLongitude( theOptions.longitude.c_str(), &theLongitude );
+	if( error )
+		return error;															// ==>
+	AddStage( kSTAT_Parse, start );
+	
+	//
+	// Load dataset.
+	//
+	error = OpenDataset( theOptions, &theDataset, &theQuery );
+	if( error )
+		return error;															// ==>
+	
+	//
+	// Set location.
+	//
+	error = SetLocation( theDataset, theQuery, theLatitude, theLongitude );
+	if( error )
+		return error;															// ==>
 	
 	//
 	// Exit.
@@ -235,7 +804,8 @@ int main( int argc, char * const argv[] )
 /**
  * Write XML header.
  *
- * This function will write the XML header to std::cout.
+ * This function will write the XML header to std::cout, the
+ * <i>{@link kXML_Header kXML_Header}</i> constant is written in one block.
  *
  * @param boolean			doClose				TRUE means close element.
  *
@@ -245,80 +815,99 @@ int main( int argc, char * const argv[] )
 void WriteHeader( bool doClose )
 {
 	//
-	// Write XML header.
+	// Write XML header and root element.
 	//
-	std::cout << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	std::cout.write( kXML_Header, sizeof( kXML_Header ) - 1 );
 	
 	//
-	// Write root element.
+	// Close element.
 	//
-	std::cout << "<WSLocationGeographicFeatures ";
-	std::cout << "xmlns=\"urn:bioversityinternational.org:schemas:standards\" ";
-	std::cout << "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" ";
-	std::cout << "xsi:schemaLocation=\"urn:bioversityinternational.org:schemas:standards ";
-	std::cout << "http://schema.grinfo.net/elements/WSLocationGeographicFeatures.xsd\"";
-	
-	//
-	// Close element.
-	//
-	if( doClose )
-		std::cout << ">\n";
+	if( doClose )
+		std::cout.write( ">\n", 2 );
 	
 } // WriteHeader.
 
 
 /*===================================================================================
- *	WriteLegend																		*
+ *	SetLegend																		*
  *==================================================================================*/
 
 /**
- * Write XML header legend.
+ * Build XML header legend.
+ *
+ * This function will build the XML comment legend of the provided dataset layers, it is
+ * called once when the dataset is loaded and written as is by WriteLegend().
  *
- * This function will write the XML comment legend to std::cout.
+ * @param DATASET_T *		theDataset			Dataset.
  *
  * @access public
  * @return void
  */
-void WriteLegend()
+void SetLegend( DATASET_T * theDataset )
 {
 	//
 	// Write legend.
 	//
-	std::cout << "\t<!--\n";
-	std::cout << "\t\tThe Feature value contains the value.\n";
-	std::cout << "\t\n";
-	std::cout << "\t\tPredicate attribute:\n";
+	ostringstream legend;
+	legend << "\t<!--\n";
+	legend << "\t\tThe Feature value contains the value.\n";
+	legend << "\t\n";
+	legend << "\t\tPredicate attribute:\n";
 	
 	//
 	// Write predicates.
 	//
 	string tabs;
-	for( int feature = 0; feature < kWORLDCLIM_FilesCount; feature++ )
+	for( size_t feature = 0; feature < theDataset->layers.size(); feature++ )
 	{
 		//
 		// Adjust TAB.
 		//
-		tabs = ( kWORLDCLIM_Tiles[ feature ].name.size() < 4 )
+		tabs = ( theDataset->layers[ feature ].name.size() < 4 )
 			 ? "\t\t"
 			 : "\t";
 		
 		//
 		// Output legend line.
 		//
-		std::cout << "\t\t\t" << kWORLDCLIM_Tiles[ feature ].name << tabs
-							  << kWORLDCLIM_Tiles[ feature ].source << "\n";
+		legend << "\t\t\t" << theDataset->layers[ feature ].name << tabs
+						   << theDataset->layers[ feature ].source << "\n";
 		
 	} // Iterating WORDCLIM features.
 
 	//
 	// Write other elements.
 	//
-	std::cout << "\t\n";
-	std::cout << "\t\tReference attribute:\n";
-	std::cout << "\t\t\tNumeric month [1 - 12].\n";
-	std::cout << "\t\n";
-	std::cout << "\t\tThe elevation in the Coordinate element is from GTOPO-30.\n";
-	std::cout << "\t-->\n";
+	legend << "\t\n";
+	legend << "\t\tReference attribute:\n";
+	legend << "\t\t\tNumeric month [1 - 12].\n";
+	legend << "\t\n";
+	legend << "\t\tThe elevation in the Coordinate element is from GTOPO-30.\n";
+	legend << "\t-->\n";
+	
+	theDataset->legend = legend.str();
+	
+} // SetLegend.
+
+
+/*===================================================================================
+ *	WriteLegend																		*
+ *==================================================================================*/
+
+/**
+ * Write XML header legend.
+ *
+ * This function will write the XML comment legend to std::cout, the legend is built
+ * once per dataset by SetLegend().
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ *
+ * @access public
+ * @return void
+ */
+void WriteLegend( const DATASET_T & theDataset )
+{
+	std::cout.write( theDataset.legend.data(), theDataset.legend.size() );
 	
 } // WriteLegend.
 
@@ -330,20 +919,260 @@ void WriteLegend()
 /**
  * Check provided arguments.
  *
- * This function will check if the function received the correct number of arguments.
+ * This function will parse the options and check if the function received the correct
+ * number of arguments; options start with a double dash, all other arguments are
+ * positional, so that negative coordinates are not mistaken for options.
  *
  * @param const int			theCount			Arguments count.
  * @param char * const		theArguments		Arguments.
+ * @param OPTIONS_T *		theOptions			Receives options.
  *
  * @access public
  * @return int
  */
-int CheckArguments( const int theCount, char * const theArguments[] )
+int CheckArguments( const int theCount, char * const theArguments[],
+					OPTIONS_T * theOptions )
 {
+	//
+	// Init local storage.
+	//
+	string positional [ 3 ];
+	int count = 0;
+	char * tail;
+	theOptions->bbox = false;
+	theOptions->packed = false;
+	theOptions->stats = false;
+	theOptions->generate = 0;
+	theOptions->bench = 0;
+	theOptions->native = false;
+	theOptions->io = kIO_MMAP;
+	theOptions->huge = false;
+	theOptions->lock = 0;
+	theOptions->limits.concurrency = kSERVER_Concurrency;
+	theOptions->limits.queue = kSERVER_Queue;
+	theOptions->limits.deadline = kSERVER_Deadline;
+	
+	//
+	// Iterate arguments.
+	//
+	for( int i = 1; i < theCount; i++ )
+	{
+		//
+		// Handle options.
+		//
+		string argument( theArguments[ i ] );
+		if( (argument.size() > 2)
+		 && (argument.compare( 0, 2, "--" ) == 0) )
+		{
+			//
+			// Handle manifest.
+			//
+			if( (argument == "--manifest")
+			 && ((i + 1) < theCount) )
+				theOptions->manifest = theArguments[ ++i ];
+			
+			//
+			// Handle scenario.
+			//
+			else if( (argument == "--scenario")
+				  && ((i + 1) < theCount) )
+				theOptions->scenarios.push_back( theArguments[ ++i ] );
+			
+			//
+			// Handle area.
+			//
+			else if( (argument == "--bbox")
+				  && ((i + 4) < theCount) )
+			{
+				theOptions->bbox = true;
+				for( int bound = 0; bound < 4; bound++ )
+					theOptions->area[ bound ] = theArguments[ ++i ];
+			}
+			
+			//
+			// Handle layer.
+			//
+			else if( (argument == "--layer")
+				  && ((i + 1) < theCount) )
+				theOptions->layers.push_back( theArguments[ ++i ] );
+			
+			//
+			// Handle batch.
+			//
+			else if( (argument == "--batch")
+				  && ((i + 1) < theCount) )
+				theOptions->batch = theArguments[ ++i ];
+			
+			//
+			// Handle packed series.
+			//
+			else if( argument == "--packed" )
+				theOptions->packed = true;
+			
+			//
+			// Handle repack.
+			//
+			else if( (argument == "--repack")
+				  && ((i + 2) < theCount) )
+			{
+				theOptions->repack[ 0 ] = theArguments[ ++i ];
+				theOptions->repack[ 1 ] = theArguments[ ++i ];
+			}
+			
+			//
+			// Handle server.
+			//
+			else if( (argument == "--listen")
+				  && ((i + 1) < theCount) )
+				theOptions->listen = theArguments[ ++i ];
+			
+			//
+			// Handle I/O mode.
+			//
+			else if( (argument == "--io")
+				  && ((i + 1) < theCount)
+				  && (! strcmp( theArguments[ i + 1 ], "mmap" )) )
+			{
+				theOptions->io = kIO_MMAP;
+				i++;
+			}
+			else if( (argument == "--io")
+				  && ((i + 1) < theCount)
+				  && (! strcmp( theArguments[ i + 1 ], "uring" )) )
+			{
+				theOptions->io = kIO_URING;
+				i++;
+			}
+			else if( (argument == "--io")
+				  && ((i + 1) < theCount)
+				  && (! strcmp( theArguments[ i + 1 ], "pread" )) )
+			{
+				theOptions->io = kIO_PREAD;
+				i++;
+			}
+			
+			//
+			// Handle huge pages.
+			//
+			else if( argument == "--hugepages" )
+				theOptions->huge = true;
+			
+			//
+			// Handle locked memory.
+			//
+			else if( (argument == "--lock")
+				  && ((i + 1) < theCount)
+				  && (strtol( theArguments[ i + 1 ], &tail, 10 ) > 0)
+				  && (! *tail) )
+				theOptions->lock = (UInt64) strtol( theArguments[ ++i ], NULL, 10 ) << 20;
+			
+			//
+			// Handle statistics.
+			//
+			else if( argument == "--stats" )
+				theOptions->stats = true;
+			
+			//
+			// Handle heat map.
+			//
+			else if( (argument == "--heatmap")
+				  && ((i + 1) < theCount) )
+				theOptions->heatmap = theArguments[ ++i ];
+			
+			//
+			// Handle byte order conversion.
+			//
+			else if( argument == "--native" )
+				theOptions->native = true;
+			
+			//
+			// Handle synthetic dataset and benchmark.
+			//
+			else if( ((argument == "--generate")
+				   || (argument == "--bench"))
+				  && ((i + 1) < theCount)
+				  && (strtol( theArguments[ i + 1 ], &tail, 10 ) > 0)
+				  && (! *tail) )
+			{
+				long value = strtol( theArguments[ ++i ], NULL, 10 );
+				if( argument == "--generate" )
+					theOptions->generate = value;
+				else
+					theOptions->bench = value;
+			}
+			
+			//
+			// Handle server limits.
+			//
+			else if( ((argument == "--concurrency")
+				   || (argument == "--queue")
+				   || (argument == "--deadline"))
+				  && ((i + 1) < theCount)
+				  && (strtol( theArguments[ i + 1 ], &tail, 10 ) > 0)
+				  && (! *tail) )
+			{
+				long value = strtol( theArguments[ ++i ], NULL, 10 );
+				if( argument == "--concurrency" )
+					theOptions->limits.concurrency = value;
+				else if( argument == "--queue" )
+					theOptions->limits.queue = value;
+				else
+					theOptions->limits.deadline = value;
+			}
+			
+			//
+			// Handle invalid option.
+			//
+			else
+			{
+				WriteHeader( true );
+				std::cout << "\t<Status Severity=\"ERROR\">"
+						  << "Invalid option [" << argument << "]"
+						  << "</Status>\n";
+				std::cout << "</WSLocationGeographicFeatures>";
+				
+				return kERROR_INVALID_OPTION;									// ==>
+			}
+			
+		} // Option.
+		
+		//
+		// Handle positional arguments.
+		//
+		else
+		{
+			if( count < 3 )
+				positional[ count ] = argument;
+			count++;
+		}
+		
+	} // Iterating arguments.
+	
+	//
+	// Check exclusive options.
+	//
+	if( theOptions->bbox
+	 && theOptions->batch.size() )
+	{
+		WriteHeader( true );
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << "Invalid option [--batch], cannot be used with [--bbox]"
+				  << "</Status>\n";
+		std::cout << "</WSLocationGeographicFeatures>";
+		
+		return kERROR_INVALID_OPTION;											// ==>
+	}
+	
 	//
 	// Check argument count.
 	//
-	if( theCount != 4 )
+	if( count != (( theOptions->bbox
+				 || theOptions->batch.size()
+				 || theOptions->repack[ 0 ].size()
+				 || theOptions->listen.size()
+				 || theOptions->generate
+				 || theOptions->native
+				 || theOptions->bench ) ? 1 : 3) )
 	{
 		//
 		// Write header.
@@ -355,7 +1184,15 @@ int CheckArguments( const int theCount, char * const theArguments[] )
 		//
 		std::cout << "\t<Status Severity=\"ERROR\">"
 				  << "Invalid number of arguments, "
-				  << "USAGE: WORDLCLIM directory latitude longitude"
+				  << "USAGE: WORDLCLIM [--manifest file] [--scenario name] "
+				  << "[--layer name] [--packed] [--io mmap|uring|pread] "
+				  << "[--hugepages] [--lock megabytes] "
+				  << "[--concurrency count] [--queue count] [--deadline seconds] "
+				  << "[--heatmap file] [--stats] "
+				  << "[--bbox latMin latMax lonMin lonMax | --batch file "
+				  << "| --repack layer file | --listen address "
+				  << "| --generate scale | --native | --bench count] "
+				  << "directory [latitude longitude]"
 				  << "</Status>\n";
 		
 		//
@@ -367,6 +1204,13 @@ int CheckArguments( const int theCount, char * const theArguments[] )
 		
 	} // Invalid argument count.
 	
+	//
+	// Set arguments.
+	//
+	theOptions->directory = positional[ 0 ];
+	theOptions->latitude = positional[ 1 ];
+	theOptions->longitude = positional[ 2 ];
+	
 	return kERROR_OK;															// ==>
 	
 } // CheckArguments.
@@ -380,20 +1224,29 @@ int CheckArguments( const int theCount, char * const theArguments[] )
  * Parse latitude.
  *
  * This function will parse the provided latitude and return the value in the provided
- * argument.
+ * argument; decimal degrees and degrees, minutes and seconds are accepted, with a sign
+ * or a hemisphere letter, see ParseCoordinate().
  *
- * @param char * const		theArgument			Argument.
+ * @param const char *		theArgument			Argument.
  * @param double *			theCoordinate		Receives latitude.
  *
  * @access public
  * @return int
  */
-int GetLatitude( char * const theArgument, double * theCoordinate )
+int GetLatitude( const char * theArgument, double * theCoordinate )
 {
+	//
+	// Parse latitude.
+	//
+	const char * position;
+	int status = ParseCoordinate( theArgument, theArgument + strlen( theArgument ),
+								  kCOORD_LATITUDE, theCoordinate, &position );
+	
 	//
 	// Check latitude format.
 	//
-	if( EOF == sscanf( theArgument, "%lf", theCoordinate ) )
+	if( (status != kPARSE_OK)
+	 && (status != kPARSE_RANGE) )
 	{
 		//
 		// Write header.
@@ -403,8 +1256,11 @@ int GetLatitude( char * const theArgument, double * theCoordinate )
 		//
 		// Send result.
 		//
-		std::cout << "\t<Status Severity=\"ERROR\">"
-				  << "Invalid latitude format"
+		std::cout << "\t<Status Severity=\"ERROR\" Code=\""
+				  << kERROR_INVALID_LATITUDE_FORMAT << "\">"
+				  << "Invalid latitude format: " << GetParseError( status )
+				  << " at position " << ((position - theArgument) + 1)
+				  << " of [" << theArgument << "]"
 				  << "</Status>\n";
 		
 		//
@@ -424,8 +1280,7 @@ int GetLatitude( char * const theArgument, double * theCoordinate )
 		//
 		// Check range.
 		//
-		if( (*theCoordinate > 90.0)
-		 || (*theCoordinate <= -90.0) )
+		if( status == kPARSE_RANGE )
 		{
 			//
 			// Write header.
@@ -435,7 +1290,8 @@ int GetLatitude( char * const theArgument, double * theCoordinate )
 			//
 			// Send result.
 			//
-			std::cout << "\t<Status Severity=\"ERROR\">"
+			std::cout << "\t<Status Severity=\"ERROR\" Code=\""
+					  << kERROR_INVALID_LATITUDE_RANGE << "\">"
 					  << "Invalid latitude range"
 					  << "</Status>\n";
 			
@@ -463,20 +1319,29 @@ int GetLatitude( char * const theArgument, double * theCoordinate )
  * Parse longitude.
  *
  * This function will parse the provided longitude and return the value in the provided
- * argument.
+ * argument; decimal degrees and degrees, minutes and seconds are accepted, with a sign
+ * or a hemisphere letter, see ParseCoordinate().
  *
- * @param char * const		theArgument			Argument.
+ * @param const char *		theArgument			Argument.
  * @param double *			theCoordinate		Receives longitude.
  *
  * @access public
  * @return int
  */
-int GetLongitude( char * const theArgument, double * theCoordinate )
+int GetLongitude( const char * theArgument, double * theCoordinate )
 {
+	//
+	// Parse longitude.
+	//
+	const char * position;
+	int status = ParseCoordinate( theArgument, theArgument + strlen( theArgument ),
+								  kCOORD_LONGITUDE, theCoordinate, &position );
+	
 	//
 	// Check longitude format.
 	//
-	if( EOF == sscanf( theArgument, "%lf", theCoordinate ) )
+	if( (status != kPARSE_OK)
+	 && (status != kPARSE_RANGE) )
 	{
 		//
 		// Write header.
@@ -486,8 +1351,11 @@ int GetLongitude( char * const theArgument, double * theCoordinate )
 		//
 		// Send result.
 		//
-		std::cout << "\t<Status Severity=\"ERROR\">"
-				  << "Invalid longitude format"
+		std::cout << "\t<Status Severity=\"ERROR\" Code=\""
+				  << kERROR_INVALID_LONGITUDE_FORMAT << "\">"
+				  << "Invalid longitude format: " << GetParseError( status )
+				  << " at position " << ((position - theArgument) + 1)
+				  << " of [" << theArgument << "]"
 				  << "</Status>\n";
 		
 		//
@@ -500,15 +1368,14 @@ int GetLongitude( char * const theArgument, double * theCoordinate )
 	} // Invalid format
 	
 	//
-	// Check latitude range.
+	// Check longitude range.
 	//
 	else
 	{
 		//
 		// Check range.
 		//
-		if( (*theCoordinate >= 180)
-		 || (*theCoordinate < -180) )
+		if( status == kPARSE_RANGE )
 		{
 			//
 			// Write header.
@@ -518,7 +1385,8 @@ int GetLongitude( char * const theArgument, double * theCoordinate )
 			//
 			// Send result.
 			//
-			std::cout << "\t<Status Severity=\"ERROR\">"
+			std::cout << "\t<Status Severity=\"ERROR\" Code=\""
+					  << kERROR_INVALID_LONGITUDE_RANGE << "\">"
 					  << "Invalid longitude range"
 					  << "</Status>\n";
 			
@@ -539,56 +1407,129 @@ int GetLongitude( char * const theArgument, double * theCoordinate )
 
 
 /*===================================================================================
- *	SetCoordinate																	*
+ *	GetBatch																		*
  *==================================================================================*/
 
 /**
- * Set coordinate element.
+ * Parse batch coordinates.
  *
- * This function will parse the altitude corresponding to the provided coordinates and
- * write the coordinate to output, the elevation will be retrieved from the GTOPO-30
- * dataset.
+ * This function will parse the provided coordinates file, or the standard input if the
+ * file is <i>-</i>, and return the coordinates in the provided arguments. Each line holds
+ * a latitude and a longitude separated by blanks, tabs, commas or semicolons, blank lines
+ * and lines starting with <i>#</i> are skipped; see ParseBatch().
  *
- * If the coordinate lies in the sea, the function will write a <i>WARNING</i>
- * <i>Status</i> element.
+ * Invalid lines are returned as points along with their errors, they are reported in
+ * their <i>Location</i> element by SetBatch(); the function only fails if the file
+ * cannot be read.
  *
- * @param char * const		theDirectory		Base dataset directory path.
- * @param double			theLatitude			Latitude.
- * @param double			theLongitude		Longitude.
- * @param int *				theAltitude			Receives elevation.
+ * @param const string &	theFile				Coordinates file path.
+ * @param vector<double> *	theLatitudes		Receives latitudes.
+ * @param vector<double> *	theLongitudes		Receives longitudes.
+ * @param vector<PARSE_T> *	theErrors			Receives invalid lines.
  *
  * @access public
  * @return int
  */
-int SetCoordinate( char * const theDirectory,
-				   double theLatitude, double theLongitude,
-				   int * theAltitude )
+int GetBatch( const string & theFile, vector<double> * theLatitudes,
+			  vector<double> * theLongitudes, vector<PARSE_T> * theErrors )
 {
 	//
-	// Init local storage.
+	// Open file.
 	//
-	int tile = -1;
+	int file = STDIN_FILENO;
+	if( theFile != "-" )
+	{
+		file = open( theFile.c_str(), O_RDONLY );
+		if( file < 0 )
+		{
+			WriteHeader( true );
+			std::cout << "\t<Status Severity=\"ERROR\">"
+					  << "Unable to open batch file [" << theFile << "]"
+					  << "</Status>\n";
+			std::cout << "</WSLocationGeographicFeatures>";
+			
+			return kERROR_INVALID_BATCH;										// ==>
+		}
+	}
 	
 	//
-	// Find tile.
+	// Read file.
 	//
-	while( ++tile < kGTOPO30_TilesCount )
+	string data;
+	char buffer[ kBATCH_Chunk ];
+	ssize_t size;
+	while( ((size = read( file, buffer, sizeof( buffer ) )) > 0)
+		|| ((size < 0) && (errno == EINTR)) )
 	{
-		//
-		// Break if point is in tile.
-		//
-		if( (theLatitude > (double) kGTOPO30_Tiles[ tile ].area.latMin)
-		 && (theLatitude <= (double) kGTOPO30_Tiles[ tile ].area.latMax)
-		 && (theLongitude >= (double) kGTOPO30_Tiles[ tile ].area.lonMin)
-		 && (theLongitude < (double) kGTOPO30_Tiles[ tile ].area.lonMax) )
-			break;															// =>
+		if( size > 0 )
+			data.append( buffer, size );
+	}
+	if( file != STDIN_FILENO )
+		close( file );
+	if( size < 0 )
+	{
+		WriteHeader( true );
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << "Unable to read batch file [" << theFile << "]"
+				  << "</Status>\n";
+		std::cout << "</WSLocationGeographicFeatures>";
 		
-	} // Iterating tiles.
+		return kERROR_INVALID_BATCH;											// ==>
+	}
 	
 	//
-	// Check tile.
+	// Parse coordinates.
+	//
+	ParseBatch( data.data(), data.size(), theLatitudes, theLongitudes, theErrors );
+	
+	return kERROR_OK;															// ==>
+	
+} // GetBatch.
+
+
+/*===================================================================================
+ *	OpenDataset																		*
+ *==================================================================================*/
+
+/**
+ * Load dataset.
+ *
+ * This function will load the dataset registry from the manifest provided in the options,
+ * or from the default manifest of the base directory if it exists, or from the built-in
+ * tables; all the dataset files are opened once here, and the pages of the locked memory
+ * budget are locked, see LockDataset(). The scenarios and layers provided in the options
+ * are resolved into the provided query, see ResolveQuery().
+ *
+ * @param const OPTIONS_T &	theOptions			Options.
+ * @param DATASET_T *		theDataset			Receives dataset.
+ * @param QUERY_T *			theQuery			Receives query.
+ *
+ * @access public
+ * @return int
+ */
+int OpenDataset( const OPTIONS_T & theOptions, DATASET_T * theDataset,
+				 QUERY_T * theQuery )
+{
+	//
+	// Resolve manifest.
+	//
+	UInt64 start = GetTicks();
+	string manifest = theOptions.manifest;
+	if( manifest.empty() )
+	{
+		string name = theOptions.directory + kManifestName;
+		if( ifstream( name.c_str() ).is_open() )
+			manifest = name;
+	}
+	
 	//
-	if( tile >= kGTOPO30_TilesCount )
+	// Load dataset.
+	//
+	string message;
+	int error = LoadDataset( theOptions.directory, manifest, theOptions.io,
+							 theOptions.huge, theDataset, &message );
+	AddStage( kSTAT_Open, start );
+	if( error )
 	{
 		//
 		// Write header.
@@ -599,7 +1540,7 @@ int SetCoordinate( char * const theDirectory,
 		// Send result.
 		//
 		std::cout << "\t<Status Severity=\"ERROR\">"
-				  << "Coordinates out of map"
+				  << message
 				  << "</Status>\n";
 		
 		//
@@ -607,48 +1548,237 @@ int SetCoordinate( char * const theDirectory,
 		//
 		std::cout << "</WSLocationGeographicFeatures>";
 		
-		return kERROR_COORDINATES_OUT_OF_MAP;									// ==>
+		return error;															// ==>
 		
-	} // Out of map.
+	} // Invalid manifest.
 	
 	//
-	// Init local storage.
+	// Lock pages.
+	// The server with a heat map locks the hottest cells first, see PrewarmDataset().
 	//
-	UInt64 lat_tiles, lon_tiles, offset_lat, offset_lon, offset_file;
-	double unit_lat, unit_lon, lat_min, lat_max, lon_min, lon_max;
+	if( theOptions.lock
+	 && (theOptions.listen.empty() || theOptions.heatmap.empty()) )
+		LockDataset( theDataset, NULL, 0, theOptions.lock );
 	
 	//
-	// Save tile rect.
+	// Build legend.
 	//
-	lat_min = (double) kGTOPO30_Tiles[ tile ].area.latMin;
-	lat_max = (double) kGTOPO30_Tiles[ tile ].area.latMax;
-	lon_min = (double) kGTOPO30_Tiles[ tile ].area.lonMin;
-	lon_max = (double) kGTOPO30_Tiles[ tile ].area.lonMax;
+	SetLegend( theDataset );
+	
+	return ResolveQuery( theOptions, *theDataset, theQuery );					// ==>
 	
+} // OpenDataset.
+
+
+/*===================================================================================
+ *	ResolveQuery																	*
+ *==================================================================================*/
+
+/**
+ * Resolve query.
+ *
+ * This function will resolve the scenarios and layers provided in the options into the
+ * provided query; unknown names are reported in a <i>Status</i> element. Without layers
+ * in the options all layers are queried, except the derived agro-climatic layers.
+ *
+ * @param const OPTIONS_T &	theOptions			Options.
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param QUERY_T *			theQuery			Receives query.
+ *
+ * @access public
+ * @return int
+ */
+int ResolveQuery( const OPTIONS_T & theOptions, const DATASET_T & theDataset,
+				  QUERY_T * theQuery )
+{
 	//
-	// Get tiles count.
+	// Resolve scenarios.
+	// The base dataset is always queried first.
 	//
-	lat_tiles = (double) (lat_max - lat_min) * ((double) kPointsLatDegree);
-	lon_tiles = (double) (lon_max - lon_min) * ((double) kPointsLonDegree);
+	theQuery->scenarios.assign( 1, 0 );
+	for( size_t i = 0; i < theOptions.scenarios.size(); i++ )
+	{
+		//
+		// Skip base scenario.
+		//
+		int scenario = FindScenario( theDataset, theOptions.scenarios[ i ] );
+		if( scenario == 0 )
+			continue;															// =>
+		
+		//
+		// Handle unknown scenario.
+		//
+		if( scenario < 0 )
+		{
+			WriteHeader( true );
+			std::cout << "\t<Status Severity=\"ERROR\">"
+					  << "Unknown scenario [" << theOptions.scenarios[ i ] << "]"
+					  << "</Status>\n";
+			std::cout << "</WSLocationGeographicFeatures>";
+			
+			return kERROR_INVALID_SCENARIO_REFERENCE;							// ==>
+		}
+		
+		theQuery->scenarios.push_back( scenario );
+		
+	} // Iterating scenarios.
 	
 	//
-	// Get tile units.
+	// Resolve layers.
+	// No selection means all layers but the agro-climatic derived layers, which are
+	// only computed when selected.
 	//
-	unit_lat = (lat_max - lat_min) / lat_tiles;
-	unit_lon = (lon_max - lon_min) / lon_tiles;
+	theQuery->layers.assign( theDataset.layers.size(), false );
+	for( size_t i = 0; theOptions.layers.empty() && (i < theDataset.layers.size()); i++ )
+		theQuery->layers[ i ] = (theDataset.layers[ i ].derived == kDERIVED_NONE)
+							 || (theDataset.layers[ i ].derived == kDERIVED_BIOCLIM);
+	for( size_t i = 0; i < theOptions.layers.size(); i++ )
+	{
+		int layer = FindLayer( theDataset, theOptions.layers[ i ] );
+		if( layer < 0 )
+		{
+			WriteHeader( true );
+			std::cout << "\t<Status Severity=\"ERROR\">"
+					  << "Unknown layer [" << theOptions.layers[ i ] << "]"
+					  << "</Status>\n";
+			std::cout << "</WSLocationGeographicFeatures>";
+			
+			return kERROR_INVALID_FEATURE_REFERENCE;							// ==>
+		}
+		
+		theQuery->layers[ layer ] = true;
+		
+	} // Iterating layers.
+	
+	theQuery->packed = theOptions.packed;
+	
+	return kERROR_OK;															// ==>
 	
+} // ResolveQuery.
+
+
+/*===================================================================================
+ *	SetCoordinate																	*
+ *==================================================================================*/
+
+/**
+ * Set coordinate element.
+ *
+ * This function will parse the altitude corresponding to the provided coordinates and
+ * write the coordinate to output, the elevation will be retrieved from the GTOPO-30
+ * dataset.
+ *
+ * If the coordinate lies in the sea, the function will write a <i>WARNING</i>
+ * <i>Status</i> element. The result of the point is recorded with AddPoint(), the
+ * <i>Status</i> elements hold its code.
+ *
+ * If <i>doLocation</i> is set, the cell rect is written in an opening <i>Location</i>
+ * element, rather than in the root element, the elements are indented accordingly and
+ * the legend is not written: this is used in batch mode, where the caller writes the
+ * header and legend once and closes the element. Points out of the map are then written
+ * in a <i>Location</i> element holding the coordinate and the error, rather than in an
+ * error document.
+ *
+ * If <i>theElevation</i> is provided, it holds the elevation and source reads of the
+ * point, already performed along with the features reads, otherwise the values are read
+ * here.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param double			theLatitude			Latitude.
+ * @param double			theLongitude		Longitude.
+ * @param int *				theAltitude			Receives elevation.
+ * @param bool				doLocation			TRUE means write a Location element.
+ * @param const READ_T *	theElevation		Elevation and source reads, or NULL.
+ *
+ * @access public
+ * @return int
+ */
+int SetCoordinate( const DATASET_T & theDataset,
+				   double theLatitude, double theLongitude,
+				   int * theAltitude, bool doLocation,
+				   const READ_T * theElevation )
+{
 	//
-	// Calculate offsets.
+	// Find tile.
 	//
-	offset_lat = ceil( (lat_max - theLatitude) * kPointsLatDegree );
-	offset_lon = floor( (theLongitude - lon_min) * kPointsLonDegree );
-	offset_file = (offset_lat * lon_tiles) + offset_lon;
+	int tile = FindTile( theDataset, theLatitude, theLongitude );
 	
 	//
-	// Get rect.
+	// Check tile.
 	//
-	lat_min = lat_max - (offset_lat * unit_lat);
-	lat_max = lat_min + unit_lat;
+	if( tile < 0 )
+	{
+		AddPoint( kERROR_COORDINATES_OUT_OF_MAP );
+		
+		//
+		// Write location.
+		// In batch mode the point is reported in its Location element, which the
+		// caller closes, and the other points are written.
+		//
+		if( doLocation )
+			std::cout << "\t<Location>\n"
+					  << "\t\t<Coordinate>\n"
+					  << "\t\t\t<Latitude Degrees=\"" << theLatitude << "\"/>\n"
+					  << "\t\t\t<Longitude Degrees=\"" << theLongitude << "\"/>\n"
+					  << "\t\t</Coordinate>\n"
+					  << "\t";
+		
+		//
+		// Write header.
+		//
+		else
+			WriteHeader( true );
+		
+		//
+		// Send result.
+		//
+		std::cout << "\t<Status Severity=\"ERROR\" Code=\""
+				  << kERROR_COORDINATES_OUT_OF_MAP << "\">"
+				  << "Coordinates out of map"
+				  << "</Status>\n";
+		
+		//
+		// Close message.
+		//
+		if( ! doLocation )
+			std::cout << "</WSLocationGeographicFeatures>";
+		
+		return kERROR_COORDINATES_OUT_OF_MAP;									// ==>
+		
+	} // Out of map.
+	
+	//
+	// Init local storage.
+	//
+	const TILE_T & theTile = theDataset.tiles[ tile ];
+	UInt64 offset_lat, offset_lon, offset_file;
+	double unit_lat, unit_lon, lat_min, lat_max, lon_min, lon_max;
+	
+	//
+	// Calculate offsets.
+	//
+	offset_file = GetCellOffset( theTile.grid, theLatitude, theLongitude,
+								 &offset_lat, &offset_lon );
+	
+	//
+	// Save tile rect.
+	//
+	lat_min = theTile.grid.area.latMin;
+	lat_max = theTile.grid.area.latMax;
+	lon_min = theTile.grid.area.lonMin;
+	lon_max = theTile.grid.area.lonMax;
+	
+	//
+	// Get tile units.
+	//
+	unit_lat = theTile.grid.unitY;
+	unit_lon = theTile.grid.unitX;
+	
+	//
+	// Get rect.
+	//
+	lat_min = lat_max - (offset_lat * unit_lat);
+	lat_max = lat_min + unit_lat;
 	
 	lon_min = lon_min + (offset_lon * unit_lon);
 	lon_max = lon_min + unit_lon;
@@ -656,7 +1786,11 @@ int SetCoordinate( char * const theDirectory,
 	//
 	// Write header.
 	//
-	WriteHeader();
+	const char * tab = ( doLocation ) ? "\t" : "";
+	if( doLocation )
+		std::cout << "\t<Location";
+	else
+		WriteHeader();
 	
 	//
 	// Write rect.
@@ -669,89 +1803,74 @@ int SetCoordinate( char * const theDirectory,
 	//
 	// Write coordinate, latitude and longitude.
 	//
-	std::cout << "\t<Coordinate>\n"
-			  << "\t\t<Latitude Degrees=\""
+	std::cout << tab << "\t<Coordinate>\n"
+			  << tab << "\t\t<Latitude Degrees=\""
 			  << theLatitude
 			  << "\"/>\n"
-			  << "\t\t<Longitude Degrees=\""
+			  << tab << "\t\t<Longitude Degrees=\""
 			  << theLongitude
 			  << "\"/>\n";
 	
 	//
 	// Init local storage.
 	//
-	SInt8 source;
+	SInt16 source;
 	SInt16 altitude;
-	ifstream file_dem, file_src;
-	string datasource = "";
-	string directory( theDirectory );
-	string tmp_dir, file_dem_name, file_src_name;
-	
-	//
-	// Create filenames.
-	//
-	tmp_dir = directory
-			+ "GTOPO30/"
-			+ kGTOPO30_Tiles[ tile ].name
-			+ "/" + kGTOPO30_Tiles[ tile ].name;
-	file_dem_name = tmp_dir + ".DEM";
-	file_src_name = tmp_dir + ".SRC";
+	const char * datasource = "";
+	int status = kERROR_OK;
+	READ_T reads[ 2 ];
 	
 	//
-	// Open files.
+	// Read elevation and source.
+	// Values already read along with the features are used as they are.
 	//
-	file_dem.open( file_dem_name.c_str(), ios::binary );
-	file_src.open( file_src_name.c_str(), ios::binary );
+	if( theElevation == NULL )
+	{
+		reads[ 0 ].done = ReadBand( theDataset, theTile.dem, offset_file,
+									&reads[ 0 ].value );
+		reads[ 1 ].done = ReadBand( theDataset, theTile.src, offset_file,
+									&reads[ 1 ].value );
+		theElevation = reads;
+	}
+	altitude = theElevation[ 0 ].value;
+	source = theElevation[ 1 ].value;
 	
 	//
-	// Read elevation.
+	// Handle elevation.
 	//
 	bool done_val = false;
-	if( file_dem.is_open() )
+	if( theElevation[ 0 ].done )
 	{
 		//
-		// Read altitude.
-		//
-		file_dem.seekg( offset_file * 2 );
-		file_dem.read( (char *) &altitude, kDataPointSize );
-		file_dem.close();
-		
-		//
-		// Rotate.
+		// Set elevation.
 		//
-		altitude = EndianS16_BtoN( altitude );
+		*theAltitude = altitude;
 		
 		//
 		// Signal.
 		//
 		done_val = true;
 		
-	} // Opened DEM file.
+	} // Read DEM file.
 	
 	//
-	// Read source.
+	// Handle source.
 	//
 	bool done_src = false;
-	if( file_src.is_open() )
+	if( theElevation[ 1 ].done )
 	{
-		//
-		// Read altitude.
-		//
-		file_src.seekg( offset_file );
-		file_src.read( (char *) &source, kSourcePointSize );
-		file_src.close();
-		
 		//
 		// Set data source.
 		//
-		datasource = kGTOPO30_Sources[ (UInt8) source ];
+		if( source < (SInt16) theDataset.sources.size() )
+			datasource = theDataset.sources[ source ].c_str();
 		
 		//
 		// Signal.
 		//
 		done_src = true;
 		
-	} // Opened SRC file.
+	} // Read SRC file.
 	
 	//
 	// Write altitude.
@@ -762,7 +1881,7 @@ int SetCoordinate( char * const theDirectory,
 		//
 		// Open element.
 		//
-		std::cout << "\t\t<Elevation";
+		std::cout << tab << "\t\t<Elevation";
 		
 		//
 		// Write source.
@@ -788,12 +1907,13 @@ int SetCoordinate( char * const theDirectory,
 				//
 				// Close coordinate.
 				//
-				std::cout << "\t</Coordinate>\n";
+				std::cout << tab << "\t</Coordinate>\n";
 				
 				//
 				// Write legend.
 				//
-				WriteLegend();
+				if( ! doLocation )
+					WriteLegend( theDataset );
 				
 			} // Coordinates in land.
 				
@@ -810,15 +1930,17 @@ int SetCoordinate( char * const theDirectory,
 				//
 				// Close coordinate.
 				//
-				std::cout << "\t</Coordinate>\n";
+				std::cout << tab << "\t</Coordinate>\n";
 				
 				//
 				// Signal in sea.
 				//
 				if( altitude == kSeaToken )
-					std::cout << "\t<Status Severity=\"WARNING\">"
+					std::cout << tab << "\t<Status Severity=\"WARNING\" Code=\""
+							  << kERROR_COORDINATES_IN_SEA << "\">"
 							  << "Coordinates are out of land"
 							  << "</Status>\n";
+				status = kERROR_COORDINATES_IN_SEA;
 			
 			} // Coordinates in sea.
 			
@@ -834,220 +1956,2604 @@ int SetCoordinate( char * const theDirectory,
 		//
 		// Close coordinate.
 		//
-		std::cout << "\t</Coordinate>\n";
+		std::cout << tab << "\t</Coordinate>\n";
 		
 		//
 		// Signal warning.
 		//
-		std::cout << "\t<Status Severity=\"WARNING\">"
+		std::cout << tab << "\t<Status Severity=\"WARNING\">"
 				  << "Unable to access GTOPO-30 files"
 				  << "</Status>\n";
 		
 	} // Unable to open GTOPO-30 files.
 	
+	AddPoint( status );
+	
 	return kERROR_OK;															// ==>
 	
 } // SetCoordinate.
 
 
 /*===================================================================================
- *	SetWORLDCLIMFeature																*
+ *	GetWORLDCLIMFeatures															*
  *==================================================================================*/
 
 /**
- * Parse WORLDCLIM feature.
+ * Read WORLDCLIM features.
  *
- * This function will retrieve the feature referenced by <i>theFeature</i> and the eventual
- * <i>theMonth</i> from the WORLDCLIM dataset and return it in a <i>Feature</i> element.
+ * This function will retrieve the WORLDCLIM features of the provided points for the base
+ * dataset and the scenarios of the provided query in a single pass: the reads of all
+ * points, including the elevation and source of each point, are collected by
+ * GetWORLDCLIMReads(), they are issued together and the derived features of all points
+ * are computed at once.
  *
- * @param char * const		theDirectory		Base dataset directory path.
- * @param double			theLatitude			Latitude.
- * @param double			theLongitude		Longitude.
- * @param const int			theFeature			Feature index.
- * @param const int			theMonth			Feature month.
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const QUERY_T &	theQuery			Query.
+ * @param const double *	theLatitudes		Latitudes.
+ * @param const double *	theLongitudes		Longitudes.
+ * @param size_t			theCount			Number of points.
+ * @param FEATURES_T *		theFeatures			Receives features.
  *
  * @access public
- * @return int
+ * @return void
  */
-int SetWORLDCLIMFeature( char * const theDirectory, double theLatitude, double theLongitude,
-						 const int theFeature )
+void GetWORLDCLIMFeatures( const DATASET_T & theDataset, const QUERY_T & theQuery,
+						   const double * theLatitudes, const double * theLongitudes,
+						   size_t theCount, FEATURES_T * theFeatures )
 {
 	//
-	// Check feature.
+	// Collect reads.
 	//
-	if( (theFeature < 0)
-	 || (theFeature >= kWORLDCLIM_FilesCount) )
-	{
-		//
-		// Send result.
-		//
-		std::cout << "\t<Status Severity=\"BUG\">"
-				  << "Invalid feature index ["
-				  << theFeature
-				  << "]</Status>\n";
-		
-		//
-		// Close message.
-		//
-		std::cout << "</WSLocationGeographicFeatures>";
-		
-		return kERROR_COORDINATES_OUT_OF_MAP;									// ==>
-		
-	} // Invalid feature index.
+	UInt64 start = GetTicks();
+	GetWORLDCLIMReads( theDataset, theQuery, theLatitudes, theLongitudes, theCount,
+					   theFeatures );
+	start = AddStage( kSTAT_Lookup, start );
 	
 	//
-	// Init local storage.
+	// Read features.
 	//
-	SInt16 feature;
-	UInt64 lat_tiles, lon_tiles, offset_lat, offset_lon, offset_file;
-	double unit_lat, unit_lon, lat_min, lat_max, lon_min, lon_max;
+	if( theFeatures->reads.size() )
+		ReadBands( theDataset, &theFeatures->reads[ 0 ], theFeatures->reads.size() );
+	start = AddStage( kSTAT_Read, start );
 	
 	//
-	// Save tile rect.
+	// Compute derived features.
+	//
+	GetDerivedFeatures( theDataset, theQuery, theLatitudes, theFeatures );
+	AddStage( kSTAT_Derive, start );
+
+} // GetWORLDCLIMFeatures.
+
+
+/*===================================================================================
+ *	GetWORLDCLIMReads																*
+ *==================================================================================*/
+
+/**
+ * Collect WORLDCLIM features reads.
+ *
+ * This function will collect the reads of the WORLDCLIM features of the provided points
+ * for the base dataset and the scenarios of the provided query, without performing them:
+ * the data point offsets of all points are computed at once per layer grid, see
+ * GetCellOffsets(), and shared by all months and scenarios, the elevation and source
+ * reads of each point are added first.
+ *
+ * Points falling in the same cells as a previous point, in the elevation tile and in all
+ * the layer grids read, share its reads: the <i>first</i> and <i>elevation</i> entries of
+ * the point refer to the reads of the first point of the cells, so that each distinct
+ * cell is read once however many points it holds. The cells are found by hashing the
+ * offsets of each point; the features <i>cells</i> receives their number.
+ *
+ * Only the selected layers are read, along with the monthly series needed by the
+ * selected derived layers, or by the selected bioclimatic layers a scenario lacks.
+ *
+ * The features arena is reset here, the temporary arrays of the lookup and of
+ * GetDerivedFeatures() are allocated from it.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const QUERY_T &	theQuery			Query.
+ * @param const double *	theLatitudes		Latitudes.
+ * @param const double *	theLongitudes		Longitudes.
+ * @param size_t			theCount			Number of points.
+ * @param FEATURES_T *		theFeatures			Receives reads.
+ *
+ * @access public
+ * @return void
+ */
+void GetWORLDCLIMReads( const DATASET_T & theDataset, const QUERY_T & theQuery,
+						const double * theLatitudes, const double * theLongitudes,
+						size_t theCount, FEATURES_T * theFeatures )
+{
+	//
+	// Init local storage.
 	//
-	lat_min = (double) kWORLDCLIM_Tiles[ theFeature ].latMin;
-	lat_max = (double) kWORLDCLIM_Tiles[ theFeature ].latMax;
-	lon_min = (double) kWORLDCLIM_Tiles[ theFeature ].lonMin;
-	lon_max = (double) kWORLDCLIM_Tiles[ theFeature ].lonMax;
+	int feature;
+	int layers = theDataset.layers.size();
+	size_t scenarios = theQuery.scenarios.size();
+	ARENA_T * arena = &theFeatures->arena;
+	ResetArena( arena );
+	int * grids = (int *) GetArena( arena, layers * sizeof( int ) );
+	fill( grids, grids + layers, -1 );
+	UInt64 ** offsets = (UInt64 **) GetArena( arena, layers * sizeof( UInt64 * ) );
+	size_t offset_count = 0;
+	UInt64 row, column;
 	
 	//
-	// Save tiles count.
+	// Init features.
+	// Temporaries are allocated from the features arena.
 	//
-	lat_tiles = kWORLDCLIM_Tiles[ theFeature ].countY;
-	lon_tiles = kWORLDCLIM_Tiles[ theFeature ].countX;
+	theFeatures->points = theCount;
+	theFeatures->cells = 0;
+	theFeatures->first.assign( theCount * scenarios * layers, -1 );
+	theFeatures->elevation.assign( theCount, -1 );
+	theFeatures->values.assign( theCount * scenarios * layers, NAN );
+	theFeatures->reads.clear();
 	
 	//
-	// Get tile units.
+	// Select layers to read.
+	// Derived layers, and bioclimatic layers missing from a scenario, need the
+	// monthly series.
 	//
-	unit_lat = (lat_max - lat_min) / lat_tiles;
-	unit_lon = (lon_max - lon_min) / lon_tiles;
+	bool * needed = (bool *) GetArena( arena, scenarios * layers * sizeof( bool ) );
+	fill( needed, needed + (scenarios * layers), false );
+	for( size_t scenario = 0; scenario < scenarios; scenario++ )
+	{
+		const SCENARIO_T & theScenario
+			= theDataset.scenarios[ theQuery.scenarios[ scenario ] ];
+		bool inputs = false;
+		for( feature = 0; feature < layers; feature++ )
+		{
+			if( ! theQuery.layers[ feature ] )
+				continue;														// =>
+			
+			if( theScenario.bands[ feature ] >= 0 )
+				needed[ (scenario * layers) + feature ] = true;
+			else if( (theDataset.layers[ feature ].derived != kDERIVED_NONE)
+				  || theDataset.layers[ feature ].bioclim )
+				inputs = true;
+		}
+		
+		if( inputs )
+		{
+			int series[] = { theDataset.tmin, theDataset.tmax, theDataset.prec };
+			for( int input = 0; input < 3; input++ )
+			{
+				if( series[ input ] >= 0 )
+					needed[ (scenario * layers) + series[ input ] ]
+						= (theScenario.bands[ series[ input ] ] >= 0);
+			}
+		}
+		
+	} // Iterating scenarios.
 	
 	//
 	// Calculate offsets.
+	// Only the layers read get offsets, layers sharing the grid of the previous one
+	// share its offsets.
 	//
-	offset_lat = ceil( (lat_max - theLatitude) * kPointsLatDegree );
-	offset_lon = floor( (theLongitude - lon_min) * kPointsLonDegree );
-	offset_file = (offset_lat * lon_tiles) + offset_lon;
+	int last = -1;
+	for( feature = 0; feature < layers; feature++ )
+	{
+		bool read = false;
+		for( size_t scenario = 0; scenario < scenarios; scenario++ )
+			read = read || needed[ (scenario * layers) + feature ];
+		if( ! read )
+			continue;															// =>
+		
+		const GRID_T & grid = theDataset.layers[ feature ].grid;
+		if( (last >= 0)
+		 && SameGrid( grid, theDataset.layers[ last ].grid ) )
+			grids[ feature ] = grids[ last ];
+		else
+		{
+			offsets[ offset_count ]
+				= (UInt64 *) GetArena( arena, theCount * sizeof( UInt64 ) );
+			GetCellOffsets( grid, theLatitudes, theLongitudes, theCount,
+							offsets[ offset_count ] );
+			grids[ feature ] = offset_count++;
+		}
+		last = feature;
+	}
 	
 	//
-	// Create filename.
+	// Locate tiles.
 	//
-	string directory( theDirectory );
-	string file_name = directory + "WORLDCLIM30/"
-								 + kWORLDCLIM_Tiles[ theFeature ].name
-								 + "/"
-								 + kWORLDCLIM_Tiles[ theFeature ].name;
+	int * tiles = (int *) GetArena( arena, theCount * sizeof( int ) );
+	UInt64 * cells = (UInt64 *) GetArena( arena, theCount * sizeof( UInt64 ) );
+	fill( cells, cells + theCount, 0 );
+	for( size_t point = 0; point < theCount; point++ )
+	{
+		tiles[ point ] = FindTile( theDataset, theLatitudes[ point ],
+								   theLongitudes[ point ] );
+		if( tiles[ point ] >= 0 )
+			cells[ point ] = GetCellOffset( theDataset.tiles[ tiles[ point ] ].grid,
+											theLatitudes[ point ], theLongitudes[ point ],
+											&row, &column );
+	}
 	
 	//
-	// Handle months.
+	// Find distinct cells.
+	// Each point is hashed by its tile cell and layer cells into an open addressing
+	// table holding the first point of each distinct cell.
+	//
+	size_t * same = (size_t *) GetArena( arena, theCount * sizeof( size_t ) );
+	size_t size = 1;
+	while( size < (theCount * 2) )
+		size <<= 1;
+	size_t * table = (size_t *) GetArena( arena, size * sizeof( size_t ) );
+	fill( table, table + size, theCount );
+	for( size_t point = 0; point < theCount; point++ )
+	{
+		UInt64 hash = (UInt64) (tiles[ point ] + 1) ^ (cells[ point ] * kHASH_Multiplier);
+		for( size_t grid = 0; grid < offset_count; grid++ )
+			hash = (hash ^ (hash >> 29) ^ offsets[ grid ][ point ]) * kHASH_Multiplier;
+		
+		size_t slot = (hash ^ (hash >> 32)) & (size - 1);
+		for( ; ; slot = (slot + 1) & (size - 1) )
+		{
+			size_t other = table[ slot ];
+			if( other == theCount )
+			{
+				table[ slot ] = point;
+				same[ point ] = point;
+				theFeatures->cells++;
+				break;															// =>
+			}
+			
+			bool equal = (tiles[ other ] == tiles[ point ])
+					  && (cells[ other ] == cells[ point ]);
+			for( size_t grid = 0; equal && (grid < offset_count); grid++ )
+				equal = (offsets[ grid ][ other ] == offsets[ grid ][ point ]);
+			if( equal )
+			{
+				same[ point ] = other;
+				break;															// =>
+			}
+		}
+	}
+	
 	//
-	if( kWORLDCLIM_Tiles[ theFeature ].months )
+	// Iterate points.
+	//
+	size_t entries = scenarios * layers;
+	for( size_t point = 0; point < theCount; point++ )
 	{
 		//
-		// Iterate months.
+		// Share reads.
+		// Points in the cells of a previous point use its reads.
 		//
-		int month;
-		string cur_name;
-		char buffer [64];
-		for( month = 1; month <= kWORLDCLIM_Tiles[ theFeature ].months; month++ )
+		if( same[ point ] != point )
 		{
-			//
-			// Get month string.
-			//
-			sprintf( buffer, "%d", month );
-			string month_string( buffer );
-			
-			//
-			// Update file name.
-			//
-			cur_name = file_name + "_" + month_string + ".bil";
-			
-			//
-			// Open file.
-			//
-			ifstream file;
-			file.open( cur_name.c_str(), ios::binary );
-			if( file.is_open() )
+			theFeatures->elevation[ point ] = theFeatures->elevation[ same[ point ] ];
+			copy( theFeatures->first.begin() + (same[ point ] * entries),
+				  theFeatures->first.begin() + ((same[ point ] + 1) * entries),
+				  theFeatures->first.begin() + (point * entries) );
+			continue;															// =>
+		}
+		
+		//
+		// Add elevation and source reads.
+		//
+		int tile = tiles[ point ];
+		if( tile >= 0 )
+		{
+			const TILE_T & theTile = theDataset.tiles[ tile ];
+			READ_T read;
+			read.offset = cells[ point ];
+			read.done = false;
+			theFeatures->elevation[ point ] = theFeatures->reads.size();
+			read.band = theTile.dem;
+			theFeatures->reads.push_back( read );
+			read.band = theTile.src;
+			theFeatures->reads.push_back( read );
+		}
+		
+		//
+		// Collect reads.
+		//
+		for( size_t scenario = 0; scenario < scenarios; scenario++ )
+		{
+			const SCENARIO_T & theScenario
+				= theDataset.scenarios[ theQuery.scenarios[ scenario ] ];
+			for( feature = 0; feature < layers; feature++ )
 			{
 				//
-				// Read feature.
+				// Skip layers not needed.
 				//
-				file.seekg( offset_file * 2 );
-				file.read( (char *) &feature, kDataPointSize );
-				file.close();
+				if( ! needed[ (scenario * layers) + feature ] )
+					continue;													// =>
 				
 				//
-				// Handle land.
+				// Add layer reads.
 				//
-				if( feature != kSeaToken )
+				int band = theScenario.bands[ feature ];
+				theFeatures->first[ (((point * scenarios) + scenario) * layers) + feature ]
+					= theFeatures->reads.size();
+				int months = theDataset.layers[ feature ].months;
+				for( int month = 0; month < ((months) ? months : 1); month++ )
 				{
-					//
-					// Write feature.
-					//
-					std::cout << "\t<Feature Predicate=\""
-							  << kWORLDCLIM_Tiles[ theFeature ].name
-							  << "\" Reference=\""
-							  << month
-					//		  << "\" Collection=\""
-					//		  << kWORLDCLIM_Tiles[ theFeature ].source
-							  << "\">"
-							  << feature
-							  << "</Feature>\n";
-					
-				} // In land.
+					READ_T read;
+					SetLayerRead( theDataset, band, month,
+								  offsets[ grids[ feature ] ][ point ], &read );
+					theFeatures->reads.push_back( read );
+				}
 				
-			} // Opened file.
+			} // Iterating layers.
 			
-		} // Iterating months.
+		} // Iterating scenarios.
 		
-	} // Has months.
+	} // Iterating points.
+
+} // GetWORLDCLIMReads.
+
+
+/*===================================================================================
+ *	GetDerivedFeatures																*
+ *==================================================================================*/
+
+/**
+ * Compute derived features.
+ *
+ * This function will compute the selected derived layers, and the selected bioclimatic
+ * layers missing from a scenario, from the monthly minimum temperature, maximum
+ * temperature and precipitation reads of the provided features.
+ *
+ * For each scenario the monthly series of all the points having all 36 values available
+ * and in land are gathered in month-major arrays, so that each kernel runs once over all
+ * the points; the results are stored in the features <i>values</i>.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const QUERY_T &	theQuery			Query.
+ * @param const double *	theLatitudes		Latitudes.
+ * @param FEATURES_T *		theFeatures			Features.
+ *
+ * @access public
+ * @return void
+ */
+void GetDerivedFeatures( const DATASET_T & theDataset, const QUERY_T & theQuery,
+						 const double * theLatitudes, FEATURES_T * theFeatures )
+{
+	//
+	// Check inputs.
+	//
+	if( (theDataset.tmin < 0)
+	 || (theDataset.tmax < 0)
+	 || (theDataset.prec < 0) )
+		return;																	// ==>
 	
 	//
-	// Handle no months.
+	// Init local storage.
 	//
-	else
+	int layers = theDataset.layers.size();
+	size_t scenarios = theQuery.scenarios.size();
+	int inputs[] = { theDataset.tmin, theDataset.tmax, theDataset.prec };
+	ARENA_T * arena = &theFeatures->arena;
+	
+	//
+	// Iterate scenarios.
+	//
+	for( size_t scenario = 0; scenario < scenarios; scenario++ )
+	{
+		//
+		// Collect derived layers.
+		//
+		const SCENARIO_T & theScenario
+			= theDataset.scenarios[ theQuery.scenarios[ scenario ] ];
+		int * derived = (int *) GetArena( arena, layers * sizeof( int ) );
+		int derived_count = 0;
+		bool bioclim = false, indices = false;
+		for( int feature = 0; feature < layers; feature++ )
+		{
+			const LAYER_T & theLayer = theDataset.layers[ feature ];
+			if( (! theQuery.layers[ feature ])
+			 || (theScenario.bands[ feature ] >= 0)
+			 || ((theLayer.derived == kDERIVED_NONE) && (! theLayer.bioclim)) )
+				continue;														// =>
+			
+			derived[ derived_count++ ] = feature;
+			if( theLayer.bioclim )
+				bioclim = true;
+			else if( theLayer.derived != kDERIVED_GDD )
+				indices = true;
+		}
+		if( ! derived_count )
+			continue;															// =>
+		
+		//
+		// Collect complete points.
+		//
+		size_t * points
+			= (size_t *) GetArena( arena, theFeatures->points * sizeof( size_t ) );
+		size_t count = 0;
+		for( size_t point = 0; point < theFeatures->points; point++ )
+		{
+			bool complete = true;
+			const int * first
+				= &theFeatures->first[ ((point * scenarios) + scenario) * layers ];
+			for( int input = 0; complete && (input < 3); input++ )
+			{
+				if( first[ inputs[ input ] ] < 0 )
+					complete = false;
+				for( int month = 0; complete && (month < kBIOCLIM_Months); month++ )
+				{
+					const READ_T & read
+						= theFeatures->reads[ first[ inputs[ input ] ] + month ];
+					complete = read.done && (read.value != kSeaToken);
+				}
+			}
+			if( complete )
+				points[ count++ ] = point;
+		}
+		if( ! count )
+			continue;															// =>
+		
+		//
+		// Gather monthly series.
+		// Arrays are month-major.
+		//
+		SInt16 * values
+			= (SInt16 *) GetArena( arena, 3 * kBIOCLIM_Months * count * sizeof( SInt16 ) );
+		double * latitudes = (double *) GetArena( arena, count * sizeof( double ) );
+		for( size_t i = 0; i < count; i++ )
+		{
+			const int * first
+				= &theFeatures->first[ ((points[ i ] * scenarios) + scenario) * layers ];
+			for( int input = 0; input < 3; input++ )
+			{
+				for( int month = 0; month < kBIOCLIM_Months; month++ )
+					values[ (((input * kBIOCLIM_Months) + month) * count) + i ]
+						= theFeatures->reads[ first[ inputs[ input ] ] + month ].value;
+			}
+			latitudes[ i ] = theLatitudes[ points[ i ] ];
+		}
+		const SInt16 * low = &values[ 0 ];
+		const SInt16 * high = &values[ kBIOCLIM_Months * count ];
+		const SInt16 * prec = &values[ 2 * kBIOCLIM_Months * count ];
+		
+		//
+		// Run kernels.
+		//
+		float * bio = NULL, * index = NULL;
+		float * gdd = (float *) GetArena( arena, count * sizeof( float ) );
+		if( bioclim )
+		{
+			bio = (float *) GetArena( arena, kBIOCLIM_Count * count * sizeof( float ) );
+			ComputeBioclim( low, high, prec, count, bio );
+		}
+		if( indices )
+		{
+			index = (float *) GetArena( arena, kINDEX_Count * count * sizeof( float ) );
+			ComputeIndices( low, high, prec, latitudes, count, index );
+		}
+		
+		//
+		// Scatter results.
+		//
+		for( int j = 0; j < derived_count; j++ )
+		{
+			const LAYER_T & theLayer = theDataset.layers[ derived[ j ] ];
+			const float * result = NULL;
+			if( theLayer.bioclim )
+				result = &bio[ (theLayer.bioclim - 1) * count ];
+			else if( theLayer.derived == kDERIVED_PET )
+				result = &index[ kINDEX_PET * count ];
+			else if( theLayer.derived == kDERIVED_ARIDITY )
+				result = &index[ kINDEX_ARIDITY * count ];
+			else if( theLayer.derived == kDERIVED_FROST )
+				result = &index[ kINDEX_FROST * count ];
+			else
+			{
+				ComputeDegreeDays( low, high, count, theLayer.base, gdd );
+				result = gdd;
+			}
+			
+			for( size_t i = 0; i < count; i++ )
+				theFeatures->values[ (((points[ i ] * scenarios) + scenario) * layers)
+								   + derived[ j ] ] = result[ i ];
+		}
+		
+	} // Iterating scenarios.
+
+} // GetDerivedFeatures.
+
+
+/*===================================================================================
+ *	SetWORLDCLIMFeatures															*
+ *==================================================================================*/
+
+/**
+ * Write WORLDCLIM features.
+ *
+ * This function will write the selected WORLDCLIM features of the provided point: the
+ * base dataset features are written first, followed by a <i>Scenario</i> element for each
+ * of the query scenarios. Features that were not read are written from their derived
+ * value, if available.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const QUERY_T &	theQuery			Query.
+ * @param const FEATURES_T &	theFeatures		Features.
+ * @param size_t			thePoint			Point index.
+ * @param const char *		theIndent			Element indentation.
+ *
+ * @access public
+ * @return int
+ */
+int SetWORLDCLIMFeatures( const DATASET_T & theDataset, const QUERY_T & theQuery,
+						  const FEATURES_T & theFeatures, size_t thePoint,
+						  const char * theIndent )
+{
+	//
+	// Init local storage.
+	//
+	int error;
+	int layers = theDataset.layers.size();
+	size_t scenarios = theQuery.scenarios.size();
+	string indent = string( theIndent ) + "\t";
+	
+	//
+	// Iterate scenarios.
+	//
+	for( size_t scenario = 0; scenario < scenarios; scenario++ )
 	{
 		//
-		// Add extension.
+		// Open scenario.
 		//
-		file_name += ".bil";
+		const SCENARIO_T & theScenario
+			= theDataset.scenarios[ theQuery.scenarios[ scenario ] ];
+		if( scenario )
+		{
+			std::cout << theIndent << "<Scenario Name=\"" << theScenario.name << "\"";
+			if( theScenario.source.size() )
+				std::cout << " Collection=\"" << theScenario.source << "\"";
+			std::cout << ">\n";
+		}
 		
 		//
-		// Open file.
+		// Write layers.
 		//
-		ifstream file;
-		file.open( file_name.c_str(), ios::binary );
-		if( file.is_open() )
+		size_t entry = ((thePoint * scenarios) + scenario) * layers;
+		for( int feature = 0; feature < layers; feature++ )
 		{
 			//
-			// Read feature.
+			// Skip other layers.
 			//
-			file.seekg( offset_file * 2 );
-			file.read( (char *) &feature, kDataPointSize );
-			file.close();
+			if( ! theQuery.layers[ feature ] )
+				continue;														// =>
 			
 			//
-			// Handle land.
+			// Handle derived values.
 			//
-			if( feature != kSeaToken )
+			int index = theFeatures.first[ entry + feature ];
+			if( index < 0 )
 			{
-				//
-				// Write feature.
-				//
-				std::cout << "\t<Feature Predicate=\""
-						  << kWORLDCLIM_Tiles[ theFeature ].name
-				//		  << "\" Collection=\""
-				//		  << kWORLDCLIM_Tiles[ theFeature ].source
-						  << "\">"
-						  << feature
-						  << "</Feature>\n";
-				
-			} // In land.
+				float value = theFeatures.values[ entry + feature ];
+				if( ! isnan( value ) )
+					SetDerivedFeature( theDataset.layers[ feature ], value,
+									   ( scenario ) ? indent.c_str() : theIndent );
+				continue;														// =>
+			}
 			
-		} // Opened file.
+			//
+			// Write read values.
+			//
+			error = SetWORLDCLIMFeature( theDataset, feature, &theFeatures.reads[ index ],
+										 ( scenario ) ? indent.c_str() : theIndent,
+										 theQuery.packed );
+			if( error )
+				return error;													// ==>
+		}
 		
-	} // Has no months.
+		//
+		// Close scenario.
+		//
+		if( scenario )
+			std::cout << theIndent << "</Scenario>\n";
+		
+	} // Iterating scenarios.
 	
 	return kERROR_OK;															// ==>
 
-} // SetWORLDCLIMFeature.
+} // SetWORLDCLIMFeatures.
+
+
+/*===================================================================================
+ *	SetWORLDCLIMFeature																*
+ *==================================================================================*/
+
+/**
+ * Write WORLDCLIM feature.
+ *
+ * This function will write the feature referenced by <i>theFeature</i> for all its
+ * eventual months in <i>Feature</i> elements, the values are taken from the provided
+ * reads which hold one entry per month. If <i>doPacked</i> is set, the months are
+ * written in a single element, separated by a space, only if all of them are available.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const int			theFeature			Feature index.
+ * @param const READ_T *	theReads			Feature reads.
+ * @param const char *		theIndent			Element indentation.
+ * @param bool				doPacked			Write packed series.
+ *
+ * @access public
+ * @return int
+ */
+int SetWORLDCLIMFeature( const DATASET_T & theDataset, const int theFeature,
+						 const READ_T * theReads, const char * theIndent,
+						 bool doPacked )
+{
+	//
+	// Check feature.
+	//
+	if( (theFeature < 0)
+	 || (theFeature >= (int) theDataset.layers.size()) )
+	{
+		//
+		// Send result.
+		//
+		std::cout << "\t<Status Severity=\"BUG\">"
+				  << "Invalid feature index ["
+				  << theFeature
+				  << "]</Status>\n";
+		
+		//
+		// Close message.
+		//
+		std::cout << "</WSLocationGeographicFeatures>";
+		
+		return kERROR_COORDINATES_OUT_OF_MAP;									// ==>
+		
+	} // Invalid feature index.
+	
+	//
+	// Init local storage.
+	//
+	const LAYER_T & theLayer = theDataset.layers[ theFeature ];
+	
+	//
+	// Handle packed months.
+	//
+	if( theLayer.months
+	 && doPacked )
+	{
+		//
+		// Check land.
+		//
+		for( int month = 0; month < theLayer.months; month++ )
+		{
+			if( (! theReads[ month ].done)
+			 || (theReads[ month ].value == kSeaToken) )
+				return kERROR_OK;												// ==>
+		}
+		
+		//
+		// Write feature.
+		//
+		std::cout << theIndent
+				  << "<Feature Predicate=\""
+				  << theLayer.name
+				  << "\" Reference=\"1-"
+				  << theLayer.months
+				  << "\">";
+		for( int month = 0; month < theLayer.months; month++ )
+		{
+			if( month )
+				std::cout << ' ';
+			WriteValue( theLayer, theReads[ month ].value );
+		}
+		std::cout << "</Feature>\n";
+		
+	} // Packed months.
+	
+	//
+	// Handle months.
+	//
+	else if( theLayer.months )
+	{
+		//
+		// Iterate months.
+		//
+		for( int month = 1; month <= theLayer.months; month++ )
+		{
+			//
+			// Handle land.
+			//
+			const READ_T & read = theReads[ month - 1 ];
+			if( read.done
+			 && (read.value != kSeaToken) )
+			{
+				//
+				// Write feature.
+				//
+				std::cout << theIndent
+						  << "<Feature Predicate=\""
+						  << theLayer.name
+						  << "\" Reference=\""
+						  << month
+				//		  << "\" Collection=\""
+				//		  << theLayer.source
+						  << "\">";
+				WriteValue( theLayer, read.value );
+				std::cout << "</Feature>\n";
+				
+			} // In land.
+			
+		} // Iterating months.
+		
+	} // Has months.
+	
+	//
+	// Handle no months.
+	//
+	else
+	{
+		//
+		// Handle land.
+		//
+		if( theReads[ 0 ].done
+		 && (theReads[ 0 ].value != kSeaToken) )
+		{
+			//
+			// Write feature.
+			//
+			std::cout << theIndent
+					  << "<Feature Predicate=\""
+					  << theLayer.name
+			//		  << "\" Collection=\""
+			//		  << theLayer.source
+					  << "\">";
+			WriteValue( theLayer, theReads[ 0 ].value );
+			std::cout << "</Feature>\n";
+			
+		} // In land.
+		
+	} // Has no months.
+	
+	return kERROR_OK;															// ==>
+
+} // SetWORLDCLIMFeature.
+
+
+/*===================================================================================
+ *	SetDerivedFeature																*
+ *==================================================================================*/
+
+/**
+ * Write derived feature.
+ *
+ * This function will write the provided derived value in a <i>Feature</i> element: the
+ * aridity index is written as computed, other values are rounded to integers, which for
+ * the bioclimatic variables are the units of the stored layers; the layer scale factor is
+ * applied last.
+ *
+ * @param const LAYER_T &	theLayer			Layer.
+ * @param float				theValue			Derived value.
+ * @param const char *		theIndent			Element indentation.
+ *
+ * @access public
+ * @return void
+ */
+void SetDerivedFeature( const LAYER_T & theLayer, float theValue, const char * theIndent )
+{
+	std::cout << theIndent
+			  << "<Feature Predicate=\""
+			  << theLayer.name
+			  << "\">";
+	
+	if( theLayer.derived == kDERIVED_ARIDITY )
+		std::cout << (theValue * theLayer.scale);
+	else
+	{
+		long value = lrintf( theValue );
+		if( theLayer.scale == 1.0 )
+			std::cout << value;
+		else
+			std::cout << (value * theLayer.scale);
+	}
+	
+	std::cout << "</Feature>\n";
+
+} // SetDerivedFeature.
+
+
+/*===================================================================================
+ *	SetLocation																		*
+ *==================================================================================*/
+
+/**
+ * Write location features.
+ *
+ * This function will write the coordinate element of the provided point, followed by its
+ * features for all the scenarios of the provided query, and close the root element. If
+ * the features are provided they were already read, otherwise they are read here into
+ * features kept from one query to the next: the process runs a single thread, and
+ * reusing their arrays and arena spares the allocations of each query.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const QUERY_T &	theQuery			Query.
+ * @param double			theLatitude			Latitude.
+ * @param double			theLongitude		Longitude.
+ * @param FEATURES_T *		theFeatures			Features, or NULL.
+ *
+ * @access public
+ * @return int
+ */
+int SetLocation( const DATASET_T & theDataset, const QUERY_T & theQuery,
+				 double theLatitude, double theLongitude, FEATURES_T * theFeatures )
+{
+	//
+	// Read features.
+	//
+	static FEATURES_T features;
+	if( theFeatures == NULL )
+	{
+		GetWORLDCLIMFeatures( theDataset, theQuery, &theLatitude, &theLongitude, 1,
+							  &features );
+		theFeatures = &features;
+	}
+	
+	//
+	// Set coordinate.
+	//
+	UInt64 start = GetTicks();
+	int altitude;
+	int error = SetCoordinate( theDataset, theLatitude, theLongitude, &altitude, false,
+							   ( theFeatures->elevation[ 0 ] >= 0 )
+							   ? &theFeatures->reads[ theFeatures->elevation[ 0 ] ]
+							   : NULL );
+	if( error )
+		return error;															// ==>
+	
+	//
+	// Set WORLDCLIM features.
+	//
+	error = SetWORLDCLIMFeatures( theDataset, theQuery, *theFeatures, 0, "\t" );
+	if( error )
+		return error;															// ==>
+	
+	//
+	// Close XML message.
+	//
+	std::cout << "</WSLocationGeographicFeatures>";
+	AddStage( kSTAT_Format, start );
+	
+	return kERROR_OK;															// ==>
+
+} // SetLocation.
+
+
+/*===================================================================================
+ *	ServeRequest																	*
+ *==================================================================================*/
+
+/**
+ * Handle server request.
+ *
+ * This function will answer a server request with the same XML document the command
+ * writes for the same arguments: the <i>lat</i> and <i>lon</i> parameters hold the
+ * coordinate, the <i>scenario</i> and <i>layer</i> parameters can be repeated and the
+ * <i>packed</i> parameter selects packed monthly series. Parameters are taken from the
+ * query string and from form bodies; when repeated, the last coordinate wins. The
+ * context is the service, which holds the dataset loaded once when the server starts.
+ *
+ * If the dataset has a read queue, the request is run in stages: its reads are collected
+ * and queued, and the function returns FALSE leaving the response pending; the response
+ * is written by PollRequests() once the reads complete. Otherwise, and for requests
+ * that need no reads, the response is written at once and the function returns TRUE.
+ * If the queue is stalled the backlog is read at once, the responses of the other
+ * requests it completes are kept in the service until the next poll.
+ * A request reading the same cells as a request in progress is attached to it, and is
+ * completed with its values, instead of queueing the same reads again.
+ *
+ * Errors are reported in the document <i>Status</i> element, as by the command, with
+ * their result <i>Code</i>; the HTTP status is only used for unsupported methods.
+ *
+ * @param const HTTP_REQUEST_T &	theRequest	Request.
+ * @param HTTP_RESPONSE_T *	theResponse			Receives response.
+ * @param void *			theContext			Service.
+ *
+ * @access public
+ * @return bool
+ */
+bool ServeRequest( const HTTP_REQUEST_T & theRequest, HTTP_RESPONSE_T * theResponse,
+				   void * theContext )
+{
+	SERVICE_T * theService = (SERVICE_T *) theContext;
+	const DATASET_T & theDataset = *theService->dataset;
+	UInt64 started = GetTicks();
+	
+	//
+	// Check method.
+	//
+	if( (theRequest.method != "GET")
+	 && (theRequest.method != "HEAD")
+	 && (theRequest.method != "POST") )
+	{
+		theResponse->status = 405;
+		return true;															// ==>
+	}
+	
+	//
+	// Handle statistics.
+	//
+	if( theRequest.path == "/stats" )
+	{
+		ostringstream stats;
+		AddCount( kCOUNT_Stats );
+		WriteStats( stats );
+		theResponse->type = "text/plain; charset=UTF-8";
+		theResponse->body = stats.str();
+		return true;															// ==>
+	}
+	
+	//
+	// Handle metrics.
+	// Gauges owned by the service are set here.
+	//
+	if( theRequest.path == "/metrics" )
+	{
+		size_t maps = 0;
+		UInt64 locked = 0;
+		vector<const DATASET_T *> datasets( theService->retired.begin(),
+											theService->retired.end() );
+		datasets.push_back( &theDataset );
+		for( size_t i = 0; i < datasets.size(); i++ )
+		{
+			for( size_t band = 0; band < datasets[ i ]->bands.size(); band++ )
+			{
+				maps += ( datasets[ i ]->bands[ band ].data != NULL );
+				locked += datasets[ i ]->bands[ band ].locked;
+			}
+		}
+		SetGauge( kGAUGE_Maps, maps );
+		SetGauge( kGAUGE_Locked, locked );
+		SetGauge( kGAUGE_Shortfall, theDataset.shortfall );
+		SetGauge( kGAUGE_Reads, theService->backlog.size()
+								+ (( theDataset.ring != NULL )
+								   ? theDataset.ring->inflight : 0) );
+		
+		vector<string> layers;
+		for( size_t layer = 0; layer < theDataset.layers.size(); layer++ )
+			layers.push_back( theDataset.layers[ layer ].name );
+		ostringstream metrics;
+		AddCount( kCOUNT_Stats );
+		WriteMetrics( metrics, layers );
+		theResponse->type = "text/plain; version=0.0.4; charset=UTF-8";
+		theResponse->body = metrics.str();
+		return true;															// ==>
+	}
+	
+	//
+	// Get parameters.
+	//
+	string parameters = theRequest.query;
+	if( theRequest.method == "POST" )
+		parameters += "&" + theRequest.body;
+	
+	OPTIONS_T options;
+	vector<string> latitudes, longitudes, packed;
+	GetParameters( parameters, "lat", &latitudes );
+	GetParameters( parameters, "lon", &longitudes );
+	GetParameters( parameters, "scenario", &options.scenarios );
+	GetParameters( parameters, "layer", &options.layers );
+	options.packed = (GetParameters( parameters, "packed", &packed ) > 0);
+	
+	//
+	// Capture output.
+	// The service functions write to the standard output.
+	//
+	stringbuf buffer;
+	streambuf * output = std::cout.rdbuf( &buffer );
+	
+	//
+	// Handle missing coordinate.
+	//
+	double latitude, longitude;
+	QUERY_T query;
+	int error = kERROR_OK;
+	if( latitudes.empty()
+	 || longitudes.empty() )
+	{
+		WriteHeader( true );
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << "Missing lat or lon parameter"
+				  << "</Status>\n";
+		std::cout << "</WSLocationGeographicFeatures>";
+		AddCount( kCOUNT_Invalid );
+	}
+	
+	//
+	// Set location.
+	// With a read queue the response is written once the reads complete.
+	//
+	else if( (! (error = GetLatitude( latitudes.back().c_str(), &latitude )))
+		  && (! (error = GetLongitude( longitudes.back().c_str(), &longitude )))
+		  && (! ResolveQuery( options, theDataset, &query )) )
+	{
+		UInt64 start = AddStage( kSTAT_Parse, started );
+		AddCount( kCOUNT_Location );
+		RecordCell( theService, latitude, longitude );
+		if( theDataset.ring != NULL )
+		{
+			//
+			// Collect reads.
+			//
+			TASK_T * task = new TASK_T;
+			task->response = theResponse;
+			task->dataset = theService->dataset;
+			task->dataset->users++;
+			task->query = query;
+			task->latitude = latitude;
+			task->longitude = longitude;
+			task->started = started;
+			GetWORLDCLIMReads( theDataset, query, &latitude, &longitude, 1,
+							   &task->features );
+			if( task->features.reads.size() )
+				QueueBands( theDataset, &task->features.reads[ 0 ],
+							task->features.reads.size(), &task->queue );
+			task->queued = AddStage( kSTAT_Lookup, start );
+			
+			//
+			// Coalesce requests.
+			// Requests reading the same cells wait for the first one.
+			//
+			task->remaining = task->queue.reads.size();
+			if( task->remaining )
+			{
+				GetCellsKey( theDataset, task->features.reads, &task->key );
+				map<string, TASK_T *>::iterator leader
+					= theService->inflight.find( task->key );
+				if( leader != theService->inflight.end() )
+				{
+					AddCount( kCOUNT_Coalesced );
+					leader->second->followers.push_back( task );
+					std::cout.rdbuf( output );
+					return false;												// ==>
+				}
+				theService->inflight[ task->key ] = task;
+			}
+			
+			//
+			// Queue reads.
+			//
+			for( size_t i = 0; i < task->queue.reads.size(); i++ )
+			{
+				task->queue.reads[ i ].owner = task;
+				theService->backlog.push_back( &task->queue.reads[ i ] );
+			}
+			
+			//
+			// Submit reads.
+			// Reads the queue cannot take are performed at once, in which case the
+			// request may be complete; other requests completed with it are ready
+			// for the next poll.
+			//
+			std::cout.rdbuf( output );
+			if( task->remaining )
+			{
+				vector<HTTP_RESPONSE_T *> & ready = theService->ready;
+				SubmitRequests( theService, &ready );
+				vector<HTTP_RESPONSE_T *>::iterator own
+					= find( ready.begin(), ready.end(), theResponse );
+				bool complete = (own != ready.end());
+				if( complete )
+					ready.erase( own );
+				if( ready.size()
+				 && (theService->wake[ 1 ] >= 0) )
+				{
+					char signal = 1;
+					ssize_t written = write( theService->wake[ 1 ], &signal, 1 );
+					(void) written;
+				}
+				return complete;												// ==>
+			}
+			
+			SetRequest( theDataset, task );
+			ReleaseDataset( theService, task->dataset );
+			delete task;
+			return true;														// ==>
+		}
+		
+		//
+		// Write location.
+		//
+		SetLocation( theDataset, query, latitude, longitude );
+	}
+	
+	//
+	// Handle invalid query.
+	// Invalid coordinates are counted as failed points.
+	//
+	else
+	{
+		AddCount( kCOUNT_Invalid );
+		if( error )
+			AddPoint( error );
+	}
+	
+	//
+	// Set response.
+	//
+	std::cout.rdbuf( output );
+	theResponse->type = "text/xml; charset=UTF-8";
+	theResponse->body = buffer.str();
+	AddStage( kSTAT_Request, started );
+	
+	return true;																// ==>
+
+} // ServeRequest.
+
+
+/*===================================================================================
+ *	PollRequests																	*
+ *==================================================================================*/
+
+/**
+ * Complete pending server requests.
+ *
+ * This function is called by the server when one of its polled descriptors is readable.
+ * The responses of requests completed while serving another request, see ServeRequest(),
+ * are returned first, the ready descriptor only signals them. For the reload descriptor
+ * the dataset is reloaded, see ReloadDataset(). For the read queue it collects the
+ * completed reads, writes the responses of the requests whose reads are all complete
+ * and returns them in the provided list, then submits the reads waiting for room in the
+ * queue.
+ *
+ * @param void *			theContext			Service.
+ * @param int				theDescriptor		Readable descriptor.
+ * @param vector<HTTP_RESPONSE_T *> *	theResponses	Receives completed responses.
+ *
+ * @access public
+ * @return void
+ */
+void PollRequests( void * theContext, int theDescriptor,
+				   vector<HTTP_RESPONSE_T *> * theResponses )
+{
+	SERVICE_T * theService = (SERVICE_T *) theContext;
+	char buffer[ 64 ];
+	
+	//
+	// Return ready responses.
+	//
+	theResponses->insert( theResponses->end(), theService->ready.begin(),
+						  theService->ready.end() );
+	theService->ready.clear();
+	if( theDescriptor == theService->wake[ 0 ] )
+	{
+		while( read( theService->wake[ 0 ], buffer, sizeof( buffer ) ) > 0 )
+			;
+		return;																	// ==>
+	}
+	
+	//
+	// Handle reload.
+	// Signals received meanwhile are merged into one reload.
+	//
+	if( theDescriptor == theService->reload )
+	{
+		while( read( theService->reload, buffer, sizeof( buffer ) ) > 0 )
+			;
+		ReloadDataset( theService );
+		return;																	// ==>
+	}
+	
+	//
+	// Collect completions.
+	//
+	IO_READ_T * reads[ kURING_Entries ];
+	size_t count;
+	while( (count = ReapRing( theService->dataset->ring, reads, kURING_Entries )) )
+		CompleteRequests( theService, reads, count, theResponses );
+	
+	//
+	// Submit waiting reads.
+	//
+	SubmitRequests( theService, theResponses );
+
+} // PollRequests.
+
+
+/*===================================================================================
+ *	ReloadDataset																	*
+ *==================================================================================*/
+
+/**
+ * Replace server dataset.
+ *
+ * This function will load the dataset again from the command options, so that a new
+ * manifest or new files published in the base directory are served without a restart.
+ * The new dataset is loaded and opened while the current one keeps serving, then it
+ * replaces the current one with the next epoch: new requests run on the new dataset,
+ * requests in progress complete on the dataset they started on, which is closed once
+ * its last request completes, see ReleaseDataset(). The read queue is kept, since its
+ * descriptor is polled by the server. With a heat map the map is saved and the pages of
+ * the most queried cells of the new dataset are loaded before the switch.
+ *
+ * With a locked memory budget the pages of the current and replaced datasets are
+ * unlocked before the new dataset is loaded, so that the new dataset gets the whole
+ * budget within the locked memory limit; until the switch the current dataset may
+ * fault. If the new dataset cannot be loaded, the current one is locked again.
+ *
+ * If the new dataset cannot be loaded the error document is written to the standard
+ * output and the current dataset is kept.
+ *
+ * @param SERVICE_T *		theService			Service.
+ *
+ * @access public
+ * @return void
+ */
+void ReloadDataset( SERVICE_T * theService )
+{
+	//
+	// Load dataset.
+	//
+	DATASET_T * dataset = new DATASET_T;
+	QUERY_T query;
+	if( theService->options->lock )
+	{
+		UnlockBands( theService->dataset );
+		for( size_t i = 0; i < theService->retired.size(); i++ )
+			UnlockBands( theService->retired[ i ] );
+	}
+	if( OpenDataset( *theService->options, dataset, &query ) )
+	{
+		std::cout << endl;
+		CloseDataset( dataset );
+		delete dataset;
+		if( theService->options->lock )
+			LockDataset( theService->dataset, NULL, 0, theService->options->lock );
+		return;																	// ==>
+	}
+	
+	//
+	// Prewarm dataset.
+	//
+	if( theService->options->heatmap.size() )
+	{
+		SetHeatMap( theService->options->heatmap, &theService->heat );
+		theService->recorded = 0;
+		PrewarmDataset( dataset, theService->heat, theService->options->lock );
+	}
+	
+	//
+	// Keep read queue.
+	//
+	DATASET_T * current = theService->dataset;
+	if( dataset->ring != NULL )
+	{
+		CloseRing( dataset->ring );
+		delete dataset->ring;
+	}
+	dataset->ring = current->ring;
+	current->ring = NULL;
+	
+	//
+	// Replace dataset.
+	//
+	dataset->epoch = current->epoch + 1;
+	theService->dataset = dataset;
+	theService->retired.push_back( current );
+	current->users++;
+	ReleaseDataset( theService, current );
+
+} // ReloadDataset.
+
+
+/*===================================================================================
+ *	ReleaseDataset																	*
+ *==================================================================================*/
+
+/**
+ * Release server request dataset.
+ *
+ * This function is called when a server request running on the provided dataset
+ * completes: if the dataset was replaced and this was its last request, it is closed.
+ *
+ * @param SERVICE_T *		theService			Service.
+ * @param DATASET_T *		theDataset			Dataset.
+ *
+ * @access public
+ * @return void
+ */
+void ReleaseDataset( SERVICE_T * theService, DATASET_T * theDataset )
+{
+	if( (--theDataset->users)
+	 || (theDataset == theService->dataset) )
+		return;																	// ==>
+	
+	vector<DATASET_T *> & retired = theService->retired;
+	retired.erase( find( retired.begin(), retired.end(), theDataset ) );
+	CloseDataset( theDataset );
+	delete theDataset;
+
+} // ReleaseDataset.
+
+
+/*===================================================================================
+ *	RequestReload																	*
+ *==================================================================================*/
+
+/**
+ * Signal dataset reload.
+ *
+ * This function handles <i>SIGHUP</i>, it only writes to the reload pipe, the reload
+ * itself is performed by the server loop, see PollRequests().
+ *
+ * @param int				theSignal			Signal.
+ *
+ * @access public
+ * @return void
+ */
+void RequestReload( int theSignal )
+{
+	(void) theSignal;
+	int error = errno;
+	char signal = 1;
+	ssize_t written = write( reloadSignal, &signal, 1 );
+	(void) written;
+	errno = error;
+
+} // RequestReload.
+
+
+/*===================================================================================
+ *	WriteExitStats																	*
+ *==================================================================================*/
+
+/**
+ * Write statistics on exit.
+ *
+ * This function is registered with <i>atexit</i> by the <i>--stats</i> option, it
+ * writes the statistics to the standard error, so that the document written to the
+ * standard output is unchanged, whichever way the command ends.
+ *
+ * @access public
+ * @return void
+ */
+void WriteExitStats()
+{
+	WriteStats( std::cerr );
+
+} // WriteExitStats.
+
+
+/*===================================================================================
+ *	SubmitRequests																	*
+ *==================================================================================*/
+
+/**
+ * Submit pending server requests reads.
+ *
+ * This function will submit the reads of the service backlog to the read queue, in
+ * order, until the queue is full. If the queue takes no reads while none are in flight,
+ * no completion would ever resume them, so the backlog is read at once with
+ * <i>pread</i> and the completed responses are returned in the provided list.
+ *
+ * @param SERVICE_T *		theService			Service.
+ * @param vector<HTTP_RESPONSE_T *> *	theResponses	Receives completed responses.
+ *
+ * @access public
+ * @return void
+ */
+void SubmitRequests( SERVICE_T * theService, vector<HTTP_RESPONSE_T *> * theResponses )
+{
+	URING_T * ring = theService->dataset->ring;
+	vector<IO_READ_T *> & backlog = theService->backlog;
+	
+	//
+	// Submit reads.
+	//
+	size_t submitted = 0;
+	while( submitted < backlog.size() )
+	{
+		size_t count = SubmitRing( ring, &backlog[ submitted ], backlog.size() - submitted );
+		if( ! count )
+			break;																// =>
+		submitted += count;
+	}
+	backlog.erase( backlog.begin(), backlog.begin() + submitted );
+	
+	//
+	// Read stalled backlog.
+	//
+	if( backlog.size()
+	 && (! ring->inflight) )
+	{
+		vector<IO_READ_T *> reads;
+		reads.swap( backlog );
+		AddReads( 0, reads.size() );
+		for( size_t i = 0; i < reads.size(); i++ )
+			reads[ i ]->result = pread( reads[ i ]->fd, reads[ i ]->buffer,
+										reads[ i ]->length, reads[ i ]->offset );
+		CompleteRequests( theService, &reads[ 0 ], reads.size(), theResponses );
+	}
+
+} // SubmitRequests.
+
+
+/*===================================================================================
+ *	CompleteRequests																*
+ *==================================================================================*/
+
+/**
+ * Complete server requests reads.
+ *
+ * This function will account the provided completed reads to their requests; once all
+ * the reads of a request are complete the responses of the request and of the requests
+ * coalesced with it are written, returned in the provided list, and the requests state
+ * is released.
+ *
+ * @param SERVICE_T *		theService			Service.
+ * @param IO_READ_T * const *	theReads		Completed reads.
+ * @param size_t			theCount			Number of reads.
+ * @param vector<HTTP_RESPONSE_T *> *	theResponses	Receives completed responses.
+ *
+ * @access public
+ * @return void
+ */
+void CompleteRequests( SERVICE_T * theService, IO_READ_T * const * theReads, size_t theCount,
+					   vector<HTTP_RESPONSE_T *> * theResponses )
+{
+	for( size_t i = 0; i < theCount; i++ )
+	{
+		TASK_T * task = (TASK_T *) theReads[ i ]->owner;
+		if( --task->remaining )
+			continue;															// =>
+		
+		//
+		// Set values.
+		//
+		theService->inflight.erase( task->key );
+		CompleteBands( *task->dataset, &task->features.reads[ 0 ], &task->queue );
+		AddStage( kSTAT_Read, task->queued );
+		
+		//
+		// Set responses.
+		// Coalesced requests have the same reads and dataset.
+		//
+		for( size_t j = 0; j < task->followers.size(); j++ )
+		{
+			task->followers[ j ]->features.reads = task->features.reads;
+			SetRequest( *task->dataset, task->followers[ j ] );
+			theResponses->push_back( task->followers[ j ]->response );
+			ReleaseDataset( theService, task->followers[ j ]->dataset );
+			delete task->followers[ j ];
+		}
+		SetRequest( *task->dataset, task );
+		theResponses->push_back( task->response );
+		ReleaseDataset( theService, task->dataset );
+		delete task;
+		
+	} // Iterating reads.
+
+} // CompleteRequests.
+
+
+/*===================================================================================
+ *	RecordCell																		*
+ *==================================================================================*/
+
+/**
+ * Record server query.
+ *
+ * This function will count a query of the 30 seconds cell containing the provided
+ * coordinates in the service heat map, and save the heat map every
+ * <i>{@link kHEAT_Save kHEAT_Save}</i> queries; nothing is recorded without a heat map
+ * file.
+ *
+ * @param SERVICE_T *		theService			Service.
+ * @param double			theLatitude			Latitude.
+ * @param double			theLongitude		Longitude.
+ *
+ * @access public
+ * @return void
+ */
+void RecordCell( SERVICE_T * theService, double theLatitude, double theLongitude )
+{
+	//
+	// Check heat map.
+	//
+	if( theService->options->heatmap.empty() )
+		return;																	// ==>
+	
+	//
+	// Count cell.
+	// Cells on the last row or column edge belong to the previous one.
+	//
+	UInt64 rows = 180 * kPointsLatDegree;
+	UInt64 columns = 360 * kPointsLonDegree;
+	UInt64 row = (UInt64) floor( (90 - theLatitude) * kPointsLatDegree );
+	UInt64 column = (UInt64) floor( (theLongitude + 180) * kPointsLonDegree );
+	if( row >= rows )
+		row = rows - 1;
+	if( column >= columns )
+		column = columns - 1;
+	theService->heat[ (row * columns) + column ]++;
+	
+	//
+	// Save heat map.
+	//
+	if( ++theService->recorded >= kHEAT_Save )
+	{
+		SetHeatMap( theService->options->heatmap, &theService->heat );
+		theService->recorded = 0;
+	}
+
+} // RecordCell.
+
+
+/*===================================================================================
+ *	GetHeatMap																		*
+ *==================================================================================*/
+
+/**
+ * Load server heat map.
+ *
+ * This function will add the cell counts of the provided heat map file to the provided
+ * heat map; each line of the file holds the row and column of a cell in the global 30
+ * seconds grid, starting from the north-west corner, and its number of queries. A missing
+ * file is an empty heat map, invalid lines end the file.
+ *
+ * @param const string &	theFile				Heat map file path.
+ * @param map<UInt64, UInt32> *	theHeat			Receives cell counts.
+ *
+ * @access public
+ * @return void
+ */
+void GetHeatMap( const string & theFile, map<UInt64, UInt32> * theHeat )
+{
+	UInt64 rows = 180 * kPointsLatDegree;
+	UInt64 columns = 360 * kPointsLonDegree;
+	UInt64 row, column;
+	UInt32 count;
+	ifstream file( theFile.c_str() );
+	while( file >> row >> column >> count )
+	{
+		if( (row < rows)
+		 && (column < columns) )
+			(*theHeat)[ (row * columns) + column ] += count;
+	}
+
+} // GetHeatMap.
+
+
+/*===================================================================================
+ *	SetHeatMap																		*
+ *==================================================================================*/
+
+/**
+ * Save server heat map.
+ *
+ * This function will write the <i>{@link kHEAT_Cells kHEAT_Cells}</i> most queried cells
+ * of the provided heat map to the provided file, most queried first, see GetHeatMap();
+ * the other cells are dropped from the heat map, so that it stays bounded. The file is
+ * written aside and renamed, so that it is never found half written.
+ *
+ * @param const string &	theFile				Heat map file path.
+ * @param map<UInt64, UInt32> *	theHeat			Cell counts.
+ *
+ * @access public
+ * @return void
+ */
+void SetHeatMap( const string & theFile, map<UInt64, UInt32> * theHeat )
+{
+	//
+	// Select cells.
+	//
+	vector< pair<UInt32, UInt64> > cells;
+	cells.reserve( theHeat->size() );
+	for( map<UInt64, UInt32>::const_iterator cell = theHeat->begin();
+		 cell != theHeat->end();
+		 ++cell )
+		cells.push_back( make_pair( cell->second, cell->first ) );
+	size_t count = ( cells.size() < kHEAT_Cells ) ? cells.size() : kHEAT_Cells;
+	partial_sort( cells.begin(), cells.begin() + count, cells.end(),
+				  greater< pair<UInt32, UInt64> >() );
+	
+	//
+	// Trim heat map.
+	//
+	if( count < cells.size() )
+	{
+		theHeat->clear();
+		for( size_t i = 0; i < count; i++ )
+			(*theHeat)[ cells[ i ].second ] = cells[ i ].first;
+	}
+	
+	//
+	// Write file.
+	//
+	UInt64 columns = 360 * kPointsLonDegree;
+	string temporary = theFile + ".tmp";
+	ofstream file( temporary.c_str() );
+	for( size_t i = 0; i < count; i++ )
+		file << (cells[ i ].second / columns) << ' '
+			 << (cells[ i ].second % columns) << ' '
+			 << cells[ i ].first << '\n';
+	file.close();
+	if( file )
+		rename( temporary.c_str(), theFile.c_str() );
+
+} // SetHeatMap.
+
+
+/*===================================================================================
+ *	PrewarmDataset																	*
+ *==================================================================================*/
+
+/**
+ * Prewarm dataset.
+ *
+ * This function will load into the page cache the pages holding the
+ * <i>{@link kHEAT_Prewarm kHEAT_Prewarm}</i> most queried cells of the provided heat map
+ * in all the layers and scenarios of the provided dataset, including the elevation and
+ * source, see PrewarmBands(). The function does not wait for the pages.
+ *
+ * If a locked memory budget is provided, the pages of these cells are locked first and
+ * the rest of the budget is spent on whole files, see LockBands(); this waits for the
+ * pages.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param const map<UInt64, UInt32> &	theHeat	Cell counts.
+ * @param UInt64			theLock				Locked memory budget in bytes.
+ *
+ * @access public
+ * @return void
+ */
+void PrewarmDataset( DATASET_T * theDataset, const map<UInt64, UInt32> & theHeat,
+					 UInt64 theLock )
+{
+	//
+	// Select hottest cells.
+	//
+	vector< pair<UInt32, UInt64> > cells;
+	cells.reserve( theHeat.size() );
+	for( map<UInt64, UInt32>::const_iterator cell = theHeat.begin();
+		 cell != theHeat.end();
+		 ++cell )
+		cells.push_back( make_pair( cell->second, cell->first ) );
+	size_t count = ( cells.size() < kHEAT_Prewarm ) ? cells.size() : kHEAT_Prewarm;
+	partial_sort( cells.begin(), cells.begin() + count, cells.end(),
+				  greater< pair<UInt32, UInt64> >() );
+	if( ! count )
+	{
+		if( theLock )
+			LockDataset( theDataset, NULL, 0, theLock );
+		return;																	// ==>
+	}
+	
+	//
+	// Get cell centers.
+	//
+	UInt64 columns = 360 * kPointsLonDegree;
+	vector<double> latitudes( count ), longitudes( count );
+	for( size_t i = 0; i < count; i++ )
+	{
+		latitudes[ i ] = 90 - (((cells[ i ].second / columns) + 0.5) / kPointsLatDegree);
+		longitudes[ i ] = (((cells[ i ].second % columns) + 0.5) / kPointsLonDegree) - 180;
+	}
+	
+	//
+	// Collect reads of all layers and scenarios.
+	//
+	QUERY_T query;
+	for( size_t scenario = 0; scenario < theDataset->scenarios.size(); scenario++ )
+		query.scenarios.push_back( scenario );
+	query.layers.assign( theDataset->layers.size(), true );
+	query.packed = false;
+	FEATURES_T features;
+	GetWORLDCLIMReads( *theDataset, query, &latitudes[ 0 ], &longitudes[ 0 ], count,
+					   &features );
+	
+	//
+	// Load pages.
+	//
+	if( features.reads.size() )
+		PrewarmBands( *theDataset, &features.reads[ 0 ], features.reads.size() );
+	
+	//
+	// Lock pages.
+	//
+	if( theLock )
+		LockDataset( theDataset, ( features.reads.size() ) ? &features.reads[ 0 ] : NULL,
+					 features.reads.size(), theLock );
+
+} // PrewarmDataset.
+
+
+/*===================================================================================
+ *	LockDataset																		*
+ *==================================================================================*/
+
+/**
+ * Lock dataset pages.
+ *
+ * This function will lock the pages of the provided dataset within the provided budget,
+ * the windows of the provided reads first, see LockBands(); if part of the budget cannot
+ * be locked, the shortfall and its cause are written to the standard error.
+ *
+ * @param DATASET_T *		theDataset			Dataset.
+ * @param const READ_T *	theReads			Reads.
+ * @param size_t			theCount			Number of reads.
+ * @param UInt64			theBudget			Budget in bytes.
+ *
+ * @access public
+ * @return void
+ */
+void LockDataset( DATASET_T * theDataset, const READ_T * theReads, size_t theCount,
+				  UInt64 theBudget )
+{
+	UInt64 locked = LockBands( theDataset, theReads, theCount, theBudget );
+	if( theDataset->shortfall )
+		std::cerr << "Locked " << locked << " of " << theBudget << " bytes, "
+				  << theDataset->shortfall << " bytes short: " << strerror( errno )
+				  << endl;
+
+} // LockDataset.
+
+
+/*===================================================================================
+ *	GetCellsKey																		*
+ *==================================================================================*/
+
+/**
+ * Get cells key.
+ *
+ * This function will set the provided key to the dataset epoch followed by the band and
+ * data point offset of each of the provided reads, in order: the offset is the cell index
+ * in the layer grid, so points falling in the same cells of all the read layers, and
+ * selecting the same layers of the same dataset version, get the same key and read the
+ * same values.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const vector<READ_T> &	theReads	Reads.
+ * @param string *			theKey				Receives key.
+ *
+ * @access public
+ * @return void
+ */
+void GetCellsKey( const DATASET_T & theDataset, const vector<READ_T> & theReads,
+				  string * theKey )
+{
+	theKey->assign( (const char *) &theDataset.epoch, sizeof( UInt32 ) );
+	theKey->reserve( sizeof( UInt32 )
+				   + (theReads.size() * (sizeof( int ) + sizeof( UInt64 ))) );
+	for( size_t i = 0; i < theReads.size(); i++ )
+	{
+		theKey->append( (const char *) &theReads[ i ].band, sizeof( int ) );
+		theKey->append( (const char *) &theReads[ i ].offset, sizeof( UInt64 ) );
+	}
+
+} // GetCellsKey.
+
+
+/*===================================================================================
+ *	SetRequest																		*
+ *==================================================================================*/
+
+/**
+ * Write pending server request response.
+ *
+ * This function will compute the derived features of the provided request, whose reads
+ * are complete, and write its location document into its response.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param TASK_T *			theTask				Request.
+ *
+ * @access public
+ * @return void
+ */
+void SetRequest( const DATASET_T & theDataset, TASK_T * theTask )
+{
+	//
+	// Set features.
+	//
+	UInt64 start = GetTicks();
+	FEATURES_T & features = theTask->features;
+	GetDerivedFeatures( theDataset, theTask->query, &theTask->latitude, &features );
+	AddStage( kSTAT_Derive, start );
+	
+	//
+	// Write location.
+	//
+	stringbuf buffer;
+	streambuf * output = std::cout.rdbuf( &buffer );
+	SetLocation( theDataset, theTask->query, theTask->latitude, theTask->longitude,
+				 &features );
+	std::cout.rdbuf( output );
+	
+	//
+	// Set response.
+	//
+	theTask->response->type = "text/xml; charset=UTF-8";
+	theTask->response->body = buffer.str();
+	AddStage( kSTAT_Request, theTask->started );
+
+} // SetRequest.
+
+
+/*===================================================================================
+ *	SetBatch																		*
+ *==================================================================================*/
+
+/**
+ * Write batch features.
+ *
+ * This function will write the features of the provided points: the header and legend
+ * are written once, followed by a <i>Location</i> element per point holding its
+ * coordinate and features. The features of all points are read and derived in a single
+ * pass before writing.
+ *
+ * A point that fails does not stop the batch: invalid lines, provided in
+ * <i>theErrors</i>, are written as a <i>Location</i> element with their <i>Line</i>
+ * holding the error <i>Status</i>, points out of the map as a <i>Location</i> element
+ * with their coordinate and error. Each error <i>Status</i> holds its result
+ * <i>Code</i>, the points are counted by code with AddPoint() and, if any failed, a
+ * closing <i>WARNING</i> holds their number.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const QUERY_T &	theQuery			Query.
+ * @param const vector<double> &	theLatitudes	Latitudes.
+ * @param const vector<double> &	theLongitudes	Longitudes.
+ * @param const vector<PARSE_T> &	theErrors	Invalid points, by point index.
+ *
+ * @access public
+ * @return int
+ */
+int SetBatch( const DATASET_T & theDataset, const QUERY_T & theQuery,
+			  const vector<double> & theLatitudes, const vector<double> & theLongitudes,
+			  const vector<PARSE_T> & theErrors )
+{
+	//
+	// Write header.
+	//
+	WriteHeader( true );
+	WriteLegend( theDataset );
+	if( theLatitudes.empty() )
+		return kERROR_OK;														// ==>
+	
+	//
+	// Select valid points.
+	// Invalid points are not read.
+	//
+	vector<double> latitudes, longitudes;
+	const vector<double> * valid_lat = &theLatitudes;
+	const vector<double> * valid_lon = &theLongitudes;
+	if( theErrors.size() )
+	{
+		size_t error = 0;
+		for( size_t point = 0; point < theLatitudes.size(); point++ )
+		{
+			if( (error < theErrors.size())
+			 && (theErrors[ error ].point == point) )
+			{
+				error++;
+				continue;														// =>
+			}
+			latitudes.push_back( theLatitudes[ point ] );
+			longitudes.push_back( theLongitudes[ point ] );
+		}
+		valid_lat = &latitudes;
+		valid_lon = &longitudes;
+	}
+	
+	//
+	// Read features.
+	//
+	FEATURES_T features;
+	if( valid_lat->size() )
+	{
+		GetWORLDCLIMFeatures( theDataset, theQuery, &(*valid_lat)[ 0 ],
+							  &(*valid_lon)[ 0 ], valid_lat->size(), &features );
+		AddCells( features.points, features.cells );
+	}
+	
+	//
+	// Write points.
+	//
+	UInt64 start = GetTicks();
+	size_t error = 0, index = 0, failed = 0;
+	for( size_t point = 0; point < theLatitudes.size(); point++ )
+	{
+		//
+		// Handle invalid point.
+		//
+		if( (error < theErrors.size())
+		 && (theErrors[ error ].point == point) )
+		{
+			const PARSE_T & theError = theErrors[ error++ ];
+			int code = GetParseCode( theError );
+			const char * field = ( theError.field == 1 ) ? "latitude"
+							   : ( theError.field == 2 ) ? "longitude"
+														 : "coordinates";
+			
+			std::cout << "\t<Location Line=\"" << theError.line << "\">\n"
+					  << "\t\t<Status Severity=\"ERROR\" Code=\"" << code << "\">"
+					  << "Invalid " << field
+					  << " at column " << theError.column << ": "
+					  << GetParseError( theError.status )
+					  << "</Status>\n"
+					  << "\t</Location>\n";
+			AddPoint( code );
+			failed++;
+			continue;															// =>
+		}
+		
+		//
+		// Write coordinate.
+		//
+		int altitude;
+		int elevation = features.elevation[ index ];
+		int status = SetCoordinate( theDataset, theLatitudes[ point ],
+									theLongitudes[ point ], &altitude, true,
+									( elevation >= 0 ) ? &features.reads[ elevation ]
+													   : NULL );
+		
+		//
+		// Write features.
+		// Points out of the map have none.
+		//
+		if( status )
+			failed++;
+		else
+		{
+			status = SetWORLDCLIMFeatures( theDataset, theQuery, features, index,
+										   "\t\t" );
+			if( status )
+				return status;													// ==>
+		}
+		
+		std::cout << "\t</Location>\n";
+		index++;
+		
+	} // Iterating points.
+	
+	//
+	// Signal failed points.
+	//
+	if( failed )
+		std::cout << "\t<Status Severity=\"WARNING\">"
+				  << failed << " of " << theLatitudes.size() << " points failed"
+				  << "</Status>\n";
+	AddStage( kSTAT_Format, start );
+	
+	return kERROR_OK;															// ==>
+
+} // SetBatch.
+
+
+/*===================================================================================
+ *	SetBioclimZone																	*
+ *==================================================================================*/
+
+/**
+ * Write bioclimatic variables summary of an area.
+ *
+ * This function will compute the bioclimatic variables of all the land cells of the
+ * provided area from the monthly minimum temperature, maximum temperature and
+ * precipitation layers, and write for each variable a <i>Feature</i> element holding the
+ * mean as value and the <i>Count</i>, <i>Min</i> and <i>Max</i> attributes. The area is
+ * scanned one row at a time, reading the row segment of all the monthly bands and
+ * computing the whole segment at once.
+ *
+ * The base dataset summary is written first, followed by a <i>Scenario</i> element for
+ * each of the provided scenarios.
+ *
+ * The rows and columns of the area are computed once, on the minimum temperature grid,
+ * so the three layers must share their grid, see SameGrid().
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const double *	theArea				Minimum and maximum latitude, minimum and
+ *												maximum longitude.
+ * @param const QUERY_T &	theQuery			Query.
+ *
+ * @access public
+ * @return int
+ */
+int SetBioclimZone( const DATASET_T & theDataset, const double * theArea,
+					const QUERY_T & theQuery )
+{
+	//
+	// Check area.
+	//
+	if( (theArea[ 0 ] >= theArea[ 1 ])
+	 || (theArea[ 2 ] >= theArea[ 3 ]) )
+	{
+		WriteHeader( true );
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << "Invalid bounding box"
+				  << "</Status>\n";
+		std::cout << "</WSLocationGeographicFeatures>";
+		
+		return kERROR_INVALID_AREA;												// ==>
+	}
+	
+	//
+	// Check inputs.
+	//
+	if( (theDataset.tmin < 0)
+	 || (theDataset.tmax < 0)
+	 || (theDataset.prec < 0) )
+	{
+		WriteHeader( true );
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << "Missing monthly tmin, tmax or prec layers"
+				  << "</Status>\n";
+		std::cout << "</WSLocationGeographicFeatures>";
+		
+		return kERROR_INVALID_FEATURE_REFERENCE;								// ==>
+	}
+	
+	//
+	// Check input grids.
+	//
+	const GRID_T & grid = theDataset.layers[ theDataset.tmin ].grid;
+	if( (! SameGrid( grid, theDataset.layers[ theDataset.tmax ].grid ))
+	 || (! SameGrid( grid, theDataset.layers[ theDataset.prec ].grid )) )
+	{
+		WriteHeader( true );
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << "The tmin, tmax and prec layers do not share a grid"
+				  << "</Status>\n";
+		std::cout << "</WSLocationGeographicFeatures>";
+		
+		return kERROR_INVALID_FEATURE_REFERENCE;								// ==>
+	}
+	
+	//
+	// Write header.
+	//
+	WriteHeader();
+	std::cout << " LatMin=\"" << theArea[ 0 ] << "\""
+			  << " LatMax=\"" << theArea[ 1 ] << "\""
+			  << " LonMin=\"" << theArea[ 2 ] << "\""
+			  << " LonMax=\"" << theArea[ 3 ] << "\">\n";
+	
+	//
+	// Clip area to grid.
+	// Cells are selected with the same rule as point lookups.
+	//
+	double lat_min = max( theArea[ 0 ], grid.area.latMin );
+	double lat_max = min( theArea[ 1 ], grid.area.latMax );
+	double lon_min = max( theArea[ 2 ], grid.area.lonMin );
+	double lon_max = min( theArea[ 3 ], grid.area.lonMax );
+	
+	//
+	// Get rows and columns.
+	// The southern and eastern grid bounds fall past the last row and column.
+	//
+	UInt64 row_first = 0, row_last = 0, col_first = 0, col_last = 0;
+	bool empty = (lat_min > lat_max) || (lon_min > lon_max);
+	if( ! empty )
+	{
+		GetCellOffset( grid, lat_max, lon_min, &row_first, &col_first );
+		GetCellOffset( grid, lat_min, lon_max, &row_last, &col_last );
+		if( row_last >= grid.countY )
+			row_last = grid.countY - 1;
+		if( col_last >= grid.countX )
+			col_last = grid.countX - 1;
+		empty = (row_first > row_last) || (col_first > col_last);
+	}
+	size_t width = ( empty ) ? 0 : (col_last - col_first + 1);
+	
+	//
+	// Init buffers.
+	//
+	vector<SInt16> values( 3 * kBIOCLIM_Months * width );
+	vector<float> output( kBIOCLIM_Count * width );
+	
+	//
+	// Iterate scenarios.
+	// The first one is the base dataset.
+	//
+	for( size_t scenario = 0; scenario < theQuery.scenarios.size(); scenario++ )
+	{
+		//
+		// Open scenario.
+		//
+		const SCENARIO_T & theScenario
+			= theDataset.scenarios[ theQuery.scenarios[ scenario ] ];
+		const char * indent = ( scenario ) ? "\t\t" : "\t";
+		if( scenario )
+		{
+			std::cout << "\t<Scenario Name=\"" << theScenario.name << "\"";
+			if( theScenario.source.size() )
+				std::cout << " Collection=\"" << theScenario.source << "\"";
+			std::cout << ">\n";
+		}
+		
+		//
+		// Init statistics.
+		//
+		UInt64 count = 0;
+		float low [ kBIOCLIM_Count ], high [ kBIOCLIM_Count ];
+		double sum [ kBIOCLIM_Count ];
+		for( int variable = 0; variable < kBIOCLIM_Count; variable++ )
+			sum[ variable ] = 0;
+		
+		//
+		// Get input bands.
+		//
+		int bands[] = { theScenario.bands[ theDataset.tmin ],
+						theScenario.bands[ theDataset.tmax ],
+						theScenario.bands[ theDataset.prec ] };
+		bool available = (bands[ 0 ] >= 0) && (bands[ 1 ] >= 0) && (bands[ 2 ] >= 0);
+		
+		//
+		// Scan rows.
+		//
+		for( UInt64 row = row_first; available && width && (row <= row_last); row++ )
+		{
+			//
+			// Read row segments.
+			// Inputs are month-major: tmin, tmax and prec.
+			//
+			bool done = true;
+			UInt64 offset = (row * grid.countX) + col_first;
+			for( int input = 0; done && (input < 3); input++ )
+				done = ReadSeriesRow( theDataset, bands[ input ], kBIOCLIM_Months,
+									  offset, width,
+									  &values[ input * kBIOCLIM_Months * width ] );
+			if( ! done )
+				continue;														// =>
+			
+			//
+			// Compute variables.
+			//
+			ComputeBioclim( &values[ 0 ],
+							&values[ kBIOCLIM_Months * width ],
+							&values[ 2 * kBIOCLIM_Months * width ],
+							width, &output[ 0 ] );
+			
+			//
+			// Accumulate land cells.
+			//
+			for( size_t cell = 0; cell < width; cell++ )
+			{
+				//
+				// Skip sea.
+				//
+				bool land = true;
+				for( int band = 0; land && (band < (3 * kBIOCLIM_Months)); band++ )
+					land = (values[ (band * width) + cell ] != kSeaToken);
+				if( ! land )
+					continue;													// =>
+				
+				//
+				// Update statistics.
+				//
+				for( int variable = 0; variable < kBIOCLIM_Count; variable++ )
+				{
+					float value = output[ (variable * width) + cell ];
+					if( (! count)
+					 || (value < low[ variable ]) )
+						low[ variable ] = value;
+					if( (! count)
+					 || (value > high[ variable ]) )
+						high[ variable ] = value;
+					sum[ variable ] += value;
+				}
+				count++;
+				
+			} // Iterating cells.
+			
+		} // Iterating rows.
+		
+		//
+		// Write variables.
+		//
+		if( count )
+		{
+			for( int variable = 0; variable < kBIOCLIM_Count; variable++ )
+				std::cout << indent
+						  << "<Feature Predicate=\"bio" << (variable + 1)
+						  << "\" Count=\"" << count
+						  << "\" Min=\"" << low[ variable ]
+						  << "\" Max=\"" << high[ variable ]
+						  << "\">" << (sum[ variable ] / count)
+						  << "</Feature>\n";
+		}
+		
+		//
+		// Signal no data.
+		//
+		else
+			std::cout << indent
+					  << "<Status Severity=\"WARNING\">"
+					  << (( available ) ? "Area is out of land"
+										: "Missing monthly tmin, tmax or prec layers")
+					  << "</Status>\n";
+		
+		//
+		// Close scenario.
+		//
+		if( scenario )
+			std::cout << "\t</Scenario>\n";
+		
+	} // Iterating scenarios.
+	
+	return kERROR_OK;															// ==>
+
+} // SetBioclimZone.
+
+
+/*===================================================================================
+ *	SetRepack																		*
+ *==================================================================================*/
+
+/**
+ * Write interleaved cube.
+ *
+ * This function will write the monthly series of the provided layer of the base dataset
+ * into a band interleaved by pixel cube at the provided path, see RepackLayer(); the
+ * outcome is reported in a <i>Status</i> element.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const string &	theLayer			Layer name.
+ * @param const string &	thePath				Cube file path.
+ *
+ * @access public
+ * @return int
+ */
+int SetRepack( const DATASET_T & theDataset, const string & theLayer,
+			   const string & thePath )
+{
+	//
+	// Resolve layer.
+	//
+	string message;
+	int error = kERROR_INVALID_FEATURE_REFERENCE;
+	int layer = FindLayer( theDataset, theLayer );
+	if( layer < 0 )
+		message = "Unknown layer [" + theLayer + "]";
+	
+	//
+	// Write cube.
+	//
+	else
+		error = RepackLayer( theDataset, layer, thePath, &message );
+	
+	//
+	// Write status.
+	//
+	WriteHeader( true );
+	if( error )
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << message
+				  << "</Status>\n";
+	else
+		std::cout << "\t<Status Severity=\"NOTICE\">"
+				  << "Layer [" << theLayer << "] written to [" << thePath << "]"
+				  << "</Status>\n";
+	std::cout << "</WSLocationGeographicFeatures>";
+	
+	return error;																// ==>
+
+} // SetRepack.
+
+
+/*===================================================================================
+ *	SetGenerate																		*
+ *==================================================================================*/
+
+/**
+ * Write synthetic dataset.
+ *
+ * This function will write a synthetic dataset of the provided scale into the provided
+ * directory, see GenerateDataset(); the outcome is reported in a <i>Status</i> element.
+ *
+ * @param const string &	theDirectory		Base directory.
+ * @param int				theScale			Grid scale.
+ *
+ * @access public
+ * @return int
+ */
+int SetGenerate( const string & theDirectory, int theScale )
+{
+	//
+	// Write dataset.
+	//
+	string message;
+	int error = GenerateDataset( theDirectory, theScale, &message );
+	
+	//
+	// Write status.
+	//
+	WriteHeader( true );
+	if( error )
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << message
+				  << "</Status>\n";
+	else
+		std::cout << "\t<Status Severity=\"NOTICE\">"
+				  << "Synthetic dataset written to [" << theDirectory << "]"
+				  << "</Status>\n";
+	std::cout << "</WSLocationGeographicFeatures>";
+	
+	return error;																// ==>
+	
+} // SetGenerate.
+
+
+/*===================================================================================
+ *	SetNative																		*
+ *==================================================================================*/
+
+/**
+ * Convert dataset byte order.
+ *
+ * This function will rewrite the files of the provided dataset stored in the byte order
+ * opposite to the host byte order, see ConvertDataset(); the outcome is reported in a
+ * <i>Status</i> element.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ *
+ * @access public
+ * @return int
+ */
+int SetNative( const DATASET_T & theDataset )
+{
+	//
+	// Convert files.
+	//
+	size_t count;
+	string message;
+	int error = ConvertDataset( theDataset, &count, &message );
+	
+	//
+	// Write status.
+	//
+	WriteHeader( true );
+	if( error )
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << message
+				  << "</Status>\n";
+	else
+		std::cout << "\t<Status Severity=\"NOTICE\">"
+				  << count << " files converted to the host byte order"
+				  << "</Status>\n";
+	std::cout << "</WSLocationGeographicFeatures>";
+	
+	return error;																// ==>
+
+} // SetNative.
+
+
+/*===================================================================================
+ *	SetBench																		*
+ *==================================================================================*/
+
+/**
+ * Write benchmark results.
+ *
+ * This function will query the provided dataset with the following workloads, and write
+ * a <i>Benchmark</i> element per workload:
+ *
+ * <ul>
+ *	<li><i>point</i>: The provided number of single point queries.
+ *	<li><i>batch</i>: Batch queries of <i>kBENCH_Batch</i> points spread over the
+ *		globe, totalling the provided number of points.
+ *	<li><i>cluster</i>: Batch queries of points within half a degree of a few centres,
+ *		as the accessions of a collecting mission.
+ *	<li><i>bbox</i>: Area summaries of half a degree squares, one per hundred points.
+ *	<li><i>zonal</i>: Area summaries of five degrees squares, one per thousand points.
+ * </ul>
+ *
+ * Points are drawn by GetRandom() from a fixed seed, so that all runs query the same
+ * points; the query documents are discarded. The elements hold the number of queries
+ * and points, the elapsed seconds, the points per second, the 50th, 90th and 99th
+ * percentile and the maximum query durations in microseconds, and the read system calls
+ * and bytes per query; built with <i>STATS_ALLOCATIONS</i>, the heap allocations per
+ * query are added.
+ *
+ * @param const DATASET_T &	theDataset			Dataset.
+ * @param const QUERY_T &	theQuery			Query.
+ * @param size_t			theCount			Number of points.
+ *
+ * @access public
+ * @return int
+ */
+int SetBench( const DATASET_T & theDataset, const QUERY_T & theQuery, size_t theCount )
+{
+	//
+	// Init local storage.
+	// Documents are written to a buffer that is cleared after each query.
+	//
+	static const char * const kWorkloads [] =
+		{ "point", "batch", "cluster", "bbox", "zonal" };
+	int error = kERROR_OK;
+	UInt64 state = kBENCH_Seed;
+	ostringstream report;
+	stringbuf discard;
+	streambuf * output = std::cout.rdbuf( &discard );
+	
+	//
+	// Iterate workloads.
+	//
+	for( int workload = 0; (workload < 5) && (! error); workload++ )
+	{
+		//
+		// Size workload.
+		//
+		size_t queries = theCount;
+		size_t points = 1;
+		if( (workload == 1)
+		 || (workload == 2) )
+		{
+			points = kBENCH_Batch;
+			queries = ( theCount > kBENCH_Batch ) ? (theCount / kBENCH_Batch) : 1;
+		}
+		else if( workload == 3 )
+			queries = ( theCount > 100 ) ? (theCount / 100) : 1;
+		else if( workload == 4 )
+			queries = ( theCount > 1000 ) ? (theCount / 1000) : 1;
+		
+		//
+		// Draw cluster centres.
+		//
+		double centres [ 10 ][ 2 ];
+		for( int centre = 0; centre < 10; centre++ )
+		{
+			centres[ centre ][ 0 ] = -55 + (140 * GetRandom( &state ));
+			centres[ centre ][ 1 ] = -175 + (350 * GetRandom( &state ));
+		}
+		
+		//
+		// Run queries.
+		//
+		vector<double> latencies;
+		latencies.reserve( queries );
+		vector<double> latitudes( points ), longitudes( points );
+		UInt64 bytes, calls, startBytes, startCalls;
+		GetReads( &startBytes, &startCalls );
+#ifdef STATS_ALLOCATIONS
+		UInt64 allocations = GetAllocations();
+#endif
+		struct timespec begin, end;
+		clock_gettime( CLOCK_MONOTONIC, &begin );
+		for( size_t query = 0; (query < queries) && (! error); query++ )
+		{
+			//
+			// Draw points.
+			//
+			double * centre = centres[ query % 10 ];
+			for( size_t point = 0; point < points; point++ )
+			{
+				if( workload == 2 )
+				{
+					latitudes[ point ] = centre[ 0 ] - 0.5 + GetRandom( &state );
+					longitudes[ point ] = centre[ 1 ] - 0.5 + GetRandom( &state );
+				}
+				else
+				{
+					latitudes[ point ] = -60 + (150 * GetRandom( &state ));
+					longitudes[ point ] = -180 + (360 * GetRandom( &state ));
+				}
+			}
+			double size = ( workload == 4 ) ? 5 : 0.5;
+			double area [ 4 ] =
+			{
+				latitudes[ 0 ] * (90 - size) / 90,
+				(latitudes[ 0 ] * (90 - size) / 90) + size,
+				longitudes[ 0 ] * (180 - size) / 180,
+				(longitudes[ 0 ] * (180 - size) / 180) + size
+			};
+			
+			//
+			// Run query.
+			//
+			struct timespec before, after;
+			clock_gettime( CLOCK_MONOTONIC, &before );
+			if( workload == 0 )
+				error = SetLocation( theDataset, theQuery,
+									 latitudes[ 0 ], longitudes[ 0 ] );
+			else if( workload < 3 )
+				error = SetBatch( theDataset, theQuery, latitudes, longitudes,
+								  vector<PARSE_T>() );
+			else
+				error = SetBioclimZone( theDataset, area, theQuery );
+			clock_gettime( CLOCK_MONOTONIC, &after );
+			latencies.push_back( ((after.tv_sec - before.tv_sec) * 1e6)
+							   + ((after.tv_nsec - before.tv_nsec) / 1e3) );
+			discard.str( "" );
+			
+		} // Iterating queries.
+		clock_gettime( CLOCK_MONOTONIC, &end );
+		GetReads( &bytes, &calls );
+#ifdef STATS_ALLOCATIONS
+		allocations = GetAllocations() - allocations;
+#endif
+		if( error )
+			break;																// =>
+		
+		//
+		// Write workload.
+		//
+		sort( latencies.begin(), latencies.end() );
+		double seconds = (end.tv_sec - begin.tv_sec)
+					   + ((end.tv_nsec - begin.tv_nsec) / 1e9);
+		report << "\t<Benchmark Workload=\"" << kWorkloads[ workload ] << "\""
+			   << " Queries=\"" << queries << "\""
+			   << " Points=\"" << (queries * points) << "\""
+			   << " Seconds=\"" << seconds << "\""
+			   << " Throughput=\"" << ((queries * points) / seconds) << "\""
+			   << " P50=\"" << latencies[ latencies.size() / 2 ] << "\""
+			   << " P90=\"" << latencies[ (latencies.size() * 9) / 10 ] << "\""
+			   << " P99=\"" << latencies[ (latencies.size() * 99) / 100 ] << "\""
+			   << " Max=\"" << latencies.back() << "\""
+			   << " ReadCalls=\"" << ((double) (calls - startCalls) / queries) << "\""
+			   << " ReadBytes=\"" << ((double) (bytes - startBytes) / queries) << "\"";
+#ifdef STATS_ALLOCATIONS
+		report << " Allocations=\"" << ((double) allocations / queries) << "\"";
+#endif
+		report << "/>\n";
+		
+	} // Iterating workloads.
+	
+	//
+	// Write results.
+	//
+	std::cout.rdbuf( output );
+	WriteHeader( true );
+	if( error )
+		std::cout << "\t<Status Severity=\"ERROR\">"
+				  << "Benchmark query failed"
+				  << "</Status>\n";
+	else
+		std::cout << report.str();
+	std::cout << "</WSLocationGeographicFeatures>";
+	
+	return error;																// ==>
+	
+} // SetBench.
+
+
+/*===================================================================================
+ *	GetRandom																		*
+ *==================================================================================*/
+
+/**
+ * Get a pseudo-random number.
+ *
+ * This function will return a number between 0 and 1 drawn with the <i>xorshift64*</i>
+ * generator from the provided state, which is updated.
+ *
+ * @param UInt64 *			theState			Generator state, not zero.
+ *
+ * @access public
+ * @return double
+ */
+double GetRandom( UInt64 * theState )
+{
+	*theState ^= *theState >> 12;
+	*theState ^= *theState << 25;
+	*theState ^= *theState >> 27;
+	
+	return ((*theState * 0x2545F4914F6CDD1DULL) >> 11) / 9007199254740992.0;	// ==>
+	
+} // GetRandom.
+
+
+/*===================================================================================
+ *	WriteValue																		*
+ *==================================================================================*/
+
+/**
+ * Write feature value.
+ *
+ * This function will write the provided stored value to std::cout, applying the layer
+ * scale factor.
+ *
+ * @param const LAYER_T &	theLayer			Layer.
+ * @param SInt16			theValue			Stored value.
+ *
+ * @access public
+ * @return void
+ */
+void WriteValue( const LAYER_T & theLayer, SInt16 theValue )
+{
+	if( theLayer.scale == 1.0 )
+		std::cout << theValue;
+	else
+		std::cout << (theValue * theLayer.scale);
+
+} // WriteValue.